@@ -16,9 +16,10 @@ int main(){
       for(int j = 0; j < n; j++)
         cin >> b[i][j];
 
-    vector<int> w(n), order(n);
-    for(int i = 0; i < n; i++) cin >> w[i];
-    for(int i = 0; i < n; i++) cin >> order[i];
+    // coins are 0-indexed in the input, the library expects 1-indexed coins and order
+    vector<int> w(n+1), order(n+1);
+    for(int i = 1; i <= n; i++) cin >> w[i];
+    for(int i = 1; i <= n; i++) { cin >> order[i]; order[i]++; }
 
     // compute the raw convolution counts
     int r = 2*n - 1;
@@ -29,10 +30,11 @@ int main(){
     // call your existing adaptive routine
     auto res = adaptiveMinWitness_randomized(a, b, c, w, order);
 
-    // output p lines of r integers each (−1 means “no witness”)
+    // output p lines of r integers each: the index into a of the witness (−1 means “no witness”)
     for(int i = 0; i < p; i++){
       for(int j = 0; j < r; j++){
-        cout << res[i][j] << (j+1<r?' ':'\n');
+        int wit = res[i][j] == -1 ? -1 : w[order[res[i][j]]];
+        cout << wit << (j+1<r?' ':'\n');
       }
     }
     return 0;
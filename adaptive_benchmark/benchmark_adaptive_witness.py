@@ -65,11 +65,17 @@ def compile_solver():
       '-I', INC_DIR,
       os.path.join(BASE,'adaptive_min_witness_solver.cpp'),
       os.path.join(SRC_DIR,'convolution.cpp'),
+      os.path.join(SRC_DIR,'arena.cpp'),
+      os.path.join(SRC_DIR,'memory_budget.cpp'),
+      os.path.join(SRC_DIR,'trace.cpp'),
       os.path.join(SRC_DIR,'witness.cpp'),
+      os.path.join(SRC_DIR,'coin_set.cpp'),
       os.path.join(SRC_DIR,'algorithms.cpp'),
       os.path.join(SRC_DIR,'dp_structs.cpp'),
       os.path.join(SRC_DIR,'peeling.cpp'),
       os.path.join(SRC_DIR,'hitting_set.cpp'),
+      os.path.join(SRC_DIR,'thread_pool.cpp'),
+      '-pthread',
       '-o', SOLVER
     ], check=True)
 
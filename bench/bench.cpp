@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "thread_pool.h"
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <unistd.h>
+#include "bench_commit.h" // generated on every build, see CMakeLists.txt
+
+Bench::Bench(const string& suite, int argc, char** argv)
+  : suite(suite), jsonPath(), filter(), reps(5), warmup(1), quick(false), results()
+{
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--reps") == 0 && a + 1 < argc) reps = max(1, atoi(argv[++a]));
+        else if (strcmp(argv[a], "--warmup") == 0 && a + 1 < argc) warmup = max(0, atoi(argv[++a]));
+        else if (strcmp(argv[a], "--filter") == 0 && a + 1 < argc) filter = argv[++a];
+        else if (strcmp(argv[a], "--json") == 0 && a + 1 < argc) jsonPath = argv[++a];
+        else if (strcmp(argv[a], "--quick") == 0) quick = true;
+        else cerr << suite << ": ignoring argument " << argv[a] << "\n";
+    }
+}
+
+vector<int> Bench::sweep(const vector<int>& values) const {
+    if (quick && !values.empty()) return {values.front()};
+    return values;
+}
+
+void Bench::run(const string& name, const vector<pair<string, ll>>& params, const function<void()>& body) {
+    if (!filter.empty() && name.find(filter) == string::npos) return;
+    for (int i = 0; i < warmup; i++) body();
+
+    vector<double> secs(reps);
+    for (int i = 0; i < reps; i++) {
+        auto t0 = chrono::steady_clock::now();
+        body();
+        auto t1 = chrono::steady_clock::now();
+        secs[i] = chrono::duration<double>(t1 - t0).count();
+    }
+    sort(secs.begin(), secs.end());
+
+    Result r{name, params, secs.front(), 0, 0, 0, 0};
+    r.median = reps % 2 ? secs[reps / 2] : (secs[reps / 2 - 1] + secs[reps / 2]) / 2;
+    for (double s : secs) r.mean += s / reps;
+    for (double s : secs) r.stddev += (s - r.mean) * (s - r.mean);
+    r.stddev = reps > 1 ? sqrt(r.stddev / (reps - 1)) : 0;
+    r.p90 = secs[min(reps - 1, (int)ceil(0.9 * reps) - 1)];
+    results.push_back(r);
+
+    string point;
+    for (auto& [key, value] : params) point += " " + key + "=" + to_string(value);
+    fprintf(stdout, "%-36s %-28s median %10.6f s  min %10.6f  stddev %9.6f\n",
+            name.c_str(), point.c_str(), r.median, r.min, r.stddev);
+    fflush(stdout);
+}
+
+/// JSON string literal (the names used here need no escaping beyond quotes and backslashes)
+static string quoted(const string& s) {
+    string res = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') res += '\\';
+        res += c;
+    }
+    return res + "\"";
+}
+
+int Bench::finish() {
+    if (jsonPath.empty()) return 0;
+    ofstream out(jsonPath);
+    if (!out) {
+        cerr << suite << ": cannot write " << jsonPath << "\n";
+        return 1;
+    }
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    out.precision(9);
+    out << "{\n"
+        << "  \"suite\": " << quoted(suite) << ",\n"
+        << "  \"commit\": " << quoted(BENCH_COMMIT) << ",\n"
+        << "  \"host\": " << quoted(host) << ",\n"
+        << "  \"threads\": " << sharedThreadPool().size() << ",\n"
+        << "  \"timestamp\": " << (ll)time(nullptr) << ",\n"
+        << "  \"reps\": " << reps << ",\n"
+        << "  \"warmup\": " << warmup << ",\n"
+        << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": " << quoted(r.name) << ", \"params\": {";
+        for (size_t j = 0; j < r.params.size(); j++) {
+            out << (j ? ", " : "") << quoted(r.params[j].first) << ": " << r.params[j].second;
+        }
+        out << "}, \"min_s\": " << r.min << ", \"median_s\": " << r.median << ", \"mean_s\": " << r.mean
+            << ", \"stddev_s\": " << r.stddev << ", \"p90_s\": " << r.p90 << "}";
+    }
+    out << "\n  ]\n}\n";
+    return out ? 0 : 1;
+}
+
+vector<int> randomBits(int n, double density, unsigned seed) {
+    mt19937 rng(seed);
+    bernoulli_distribution bit(density);
+    vector<int> v(n);
+    for (int& x : v) x = bit(rng) ? 1 : 0;
+    return v;
+}
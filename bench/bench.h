@@ -0,0 +1,57 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "constants.h"
+#include <functional>
+#include <string>
+
+/**
+ * Minimal benchmark harness shared by the bench_* executables.
+ *
+ * Every measurement runs `warmup` untimed iterations, then `reps` timed ones, and reports
+ * min / median / mean / stddev / p90 in seconds. Results are printed as a table and, with --json FILE,
+ * written as one JSON document per run so that two commits can be compared with compare_bench.py.
+ *
+ * Command line (all optional):
+ *   --reps N       timed repetitions per point (default 5)
+ *   --warmup N     untimed repetitions per point (default 1)
+ *   --filter S     only run benchmarks whose name contains S
+ *   --quick        the smallest point of every sweep only
+ *   --json FILE    write the results to FILE
+ */
+class Bench {
+public:
+    Bench(const string& suite, int argc, char** argv);
+
+    /// Times `body` at one sweep point; `params` name the point, e.g. {{"n", 1 << 16}}.
+    void run(const string& name, const vector<pair<string, ll>>& params, const function<void()>& body);
+
+    /// Sweep values, cut to the first one under --quick.
+    vector<int> sweep(const vector<int>& values) const;
+
+    /// Prints the summary, writes the JSON report if requested; returns the process exit code.
+    int finish();
+
+private:
+    struct Result {
+        string name;
+        vector<pair<string, ll>> params;
+        double min, median, mean, stddev, p90;
+    };
+
+    string suite, jsonPath, filter;
+    int reps, warmup;
+    bool quick;
+    vector<Result> results;
+};
+
+/// Keeps the optimizer from discarding a computed value.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/// Reproducible random 0/1 vector with roughly `density`·n ones.
+vector<int> randomBits(int n, double density, unsigned seed);
+
+#endif // BENCH_H
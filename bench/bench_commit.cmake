@@ -0,0 +1,20 @@
+# Writes ${OUTPUT}: a header defining BENCH_COMMIT as the current commit of ${SOURCE_DIR}.
+# Run on every build (see CMakeLists.txt); the file is only rewritten when the commit changes, so bench.cpp is
+# recompiled only then.
+execute_process(
+    COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE BENCH_COMMIT
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+if(NOT BENCH_COMMIT)
+    set(BENCH_COMMIT unknown)
+endif()
+set(content "#define BENCH_COMMIT \"${BENCH_COMMIT}\"\n")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} previous)
+endif()
+if(NOT "${previous}" STREQUAL "${content}")
+    file(WRITE ${OUTPUT} "${content}")
+endif()
@@ -0,0 +1,47 @@
+#include "bench.h"
+#include "convolution.h"
+
+// FFT / NTT convolutions, boolCnv and the quadratic (max, +) convolutions
+int main(int argc, char** argv) {
+    Bench bench("convolution", argc, argv);
+    mt19937 rng(1);
+
+    for (int n : bench.sweep({1 << 12, 1 << 16, 1 << 20})) {
+        vd a(n), b(n);
+        for (int i = 0; i < n; i++) {
+            a[i] = rng() % 100;
+            b[i] = rng() % 100;
+        }
+        bench.run("fft_conv", {{"n", n}}, [&] { keep(conv(a, b)); });
+
+        vector<int> x = randomBits(n, 0.3, 2), y = randomBits(n, 0.3, 3);
+        bench.run("boolCnv", {{"n", n}}, [&] { keep(boolCnv(x, y)); });
+
+        vector<ll> p(n), q(n);
+        for (int i = 0; i < n; i++) {
+            p[i] = rng() % NTT_MOD;
+            q[i] = rng() % NTT_MOD;
+        }
+        bench.run("nttConv", {{"n", n}}, [&] { keep(nttConv(p, q)); });
+    }
+
+    for (int n : bench.sweep({1 << 14, 1 << 18})) {
+        vector<ll> a(n);
+        a[0] = 0;
+        for (int i = 1; i < n; i++) a[i] = rng() % NTT_MOD;
+        bench.run("polyExp", {{"n", n}}, [&] { keep(polyExp(a, n)); });
+    }
+
+    for (int n : bench.sweep({512, 2048, 8192})) {
+        vector<ll> a(n), b(n);
+        vector<int> bWit(n), witness;
+        for (int i = 0; i < n; i++) {
+            a[i] = rng() % 4 ? (ll)(rng() % 1000) : NEG_INF;
+            b[i] = rng() % 1000;
+            bWit[i] = i + 1;
+        }
+        bench.run("maxPlusCnv", {{"n", n}}, [&] { keep(maxPlusCnv(a, b)); });
+        bench.run("maxPlusCnv_minWitness", {{"n", n}}, [&] { keep(maxPlusCnv_minWitness(a, b, bWit, witness)); });
+    }
+    return bench.finish();
+}
@@ -0,0 +1,25 @@
+#include "bench.h"
+#include "hitting_set.h"
+
+// Greedy and randomized hitting sets of random R-subsets of [1..n]
+int main(int argc, char** argv) {
+    Bench bench("hitting_set", argc, argv);
+
+    for (int sets : bench.sweep({1 << 12, 1 << 15, 1 << 18})) {
+        int n = 4096, R = 64;
+        mt19937 rng(sets);
+        SetSystem system;
+        vector<int> set(R);
+        for (int s = 0; s < sets; s++) {
+            for (int& x : set) x = (int)(rng() % n) + 1;
+            sort(set.begin(), set.end());
+            system.addSet(set);
+        }
+        int limit = (int)ceil((double)n / R * log(sets)) + 1;
+        bench.run("computeHittingSet", {{"sets", sets}, {"n", n}, {"R", R}},
+                  [&] { keep(computeHittingSet(system, R, n)); });
+        bench.run("computeHittingSet_randomized", {{"sets", sets}, {"n", n}, {"R", R}},
+                  [&] { keep(computeHittingSet_randomized(system, R, n, limit, 3)); });
+    }
+    return bench.finish();
+}
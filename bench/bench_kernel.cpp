@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "algorithms.h"
+#include "small_u.h"
+
+/// n coins with random weights in [1..u] (the maximum is u) and random profits
+static CoinSet randomInstance(int n, int u, bool coinchange, unsigned seed) {
+    mt19937 rng(seed);
+    vector<int> w(n + 1), p(n + 1), order(n + 1);
+    for (int i = 1; i <= n; i++) {
+        w[i] = (int)(rng() % u) + 1;
+        p[i] = coinchange ? -1 : (int)(rng() % 1000) + 1;
+        order[i] = i;
+    }
+    w[1] = u;
+    return CoinSet(n, u, w, p, order);
+}
+
+// Algorithm 2 variants and Algorithm 1, timed separately
+int main(int argc, char** argv) {
+    Bench bench("kernel", argc, argv);
+
+    for (int u : bench.sweep({256, 1024, 4096})) {
+        int n = u;
+        vector<pair<string, ll>> point = {{"u", u}, {"n", n}};
+        vector<solution> sol;
+
+        CoinSet knap = randomInstance(n, u, false, 1);
+        bench.run("kernel_knapsack", point, [&] { kernelComputation_knapsack(knap, 0, sol); });
+
+        CoinSet coins = randomInstance(n, u, true, 2);
+        bench.run("kernel_coinchange_simple", point, [&] { kernelComputation_coinchange_simple(coins, 0, sol); });
+        bench.run("kernel_coinchange_randomized", point, [&] { kernelComputation_coinchange_randomized(coins, 0, sol); });
+        bench.run("kernel_coinchange_adaptive", point, [&] { kernelComputation_coinchange(coins, 0, sol); });
+        if (u <= SMALL_U_MAX) {
+            bench.run("kernel_coinchange_smallU", point, [&] { kernelComputation_coinchange_smallU(coins, 0, sol); });
+        }
+    }
+
+    // propagation from a fixed kernel; every repetition restores the kernel first (a copy of k·u solutions)
+    for (int t : bench.sweep({1 << 18, 1 << 20, 1 << 22})) {
+        int u = 1024, n = 64;
+        CoinSet cs = randomInstance(n, u, false, 3);
+        vector<solution> kernel, sol;
+        kernelComputation_knapsack(cs, 0, kernel);
+        bench.run("propagation", {{"t", t}, {"u", u}, {"n", n}}, [&] {
+            sol = kernel;
+            sol.resize(max((int)kernel.size(), t + 1));
+            propagation(cs, t, sol);
+        });
+        CoinSet coins = randomInstance(n, 256, true, 4);
+        bench.run("coinChangeSmallU", {{"t", t}, {"u", 256}, {"n", n}}, [&] { keep(coinChangeSmallU(coins, t)); });
+    }
+    return bench.finish();
+}
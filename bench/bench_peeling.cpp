@@ -0,0 +1,22 @@
+#include "bench.h"
+#include "peeling.h"
+
+// Randomized k-matches reconstruction (witness peeling) on random binary strings
+int main(int argc, char** argv) {
+    Bench bench("peeling", argc, argv);
+
+    for (int n : bench.sweep({256, 512, 1024})) {
+        int m = n / 16;
+        vector<int> a = randomBits(n, 0.3, 1), b = randomBits(m, 0.3, 2);
+        string text, pat;
+        for (int x : a) text.push_back(x ? '1' : '0');
+        for (int y : b) pat.push_back(y ? '1' : '0');
+        for (int k : {4, 8}) {
+            bench.run("k_reconstruct_randomized", {{"n", n}, {"m", m}, {"k", k}},
+                      [&] { keep(k_reconstruct_randomized(text, pat, k)); });
+        }
+        bench.run("k_find_witnesses_randomized", {{"n", n}, {"m", m}, {"k", 8}},
+                  [&] { keep(k_find_witnesses_randomized(a, b, 8)); });
+    }
+    return bench.finish();
+}
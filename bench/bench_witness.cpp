@@ -0,0 +1,64 @@
+#include "bench.h"
+#include "algorithms.h"
+#include "peeling.h"
+#include "witness.h"
+
+/// n coins with distinct random weights in [1..u] and a shuffled lex order
+static CoinSet randomCoins(int n, int u, unsigned seed) {
+    mt19937 rng(seed);
+    vector<int> weights(u);
+    iota(weights.begin(), weights.end(), 1);
+    shuffle(weights.begin(), weights.end(), rng);
+    vector<int> w(n + 1), p(n + 1, -1), order(n + 1);
+    for (int i = 1; i <= n; i++) {
+        w[i] = weights[i - 1];
+        order[i] = i;
+    }
+    shuffle(order.begin() + 1, order.end(), rng);
+    return CoinSet(n, u, w, p, order);
+}
+
+// Minimum, sampled and k-witness finders on one boolean convolution of a coin indicator with a 0/1 vector
+int main(int argc, char** argv) {
+    Bench bench("witness", argc, argv);
+    const int K = 8;
+
+    for (int u : bench.sweep({1024, 4096})) {
+        int n = u / 4;
+        CoinSet cs = randomCoins(n, u, 7);
+        vector<int> a = cs.f, b = randomBits(2 * u, 0.2, 8);
+        vector<int> wanted(a.size() + b.size() - 1, 1);
+
+        bench.run("min_witness_ordered", {{"u", u}, {"n", n}}, [&] { keep(minimum_witness_boolCnv_ordered(a, b, cs)); });
+        bench.run("witness_sampling", {{"u", u}, {"n", n}}, [&] { keep(randomized_witness_sampling(a, b)); });
+        bench.run("min_witness_random", {{"u", u}, {"n", n}}, [&] { keep(minimum_witness_random(a, b, cs)); });
+        bench.run("randomized_k_witness", {{"u", u}, {"n", n}, {"k", K}},
+                  [&] { keep(randomized_k_witness(a, b, K, cs, wanted, 9)); });
+        // the peeling finder aligns a short vector against the coin indicator
+        vector<int> shortB = randomBits(64, 0.2, 9);
+        bench.run("k_find_witnesses_knapsack", {{"u", u}, {"n", n}, {"m", 64}, {"k", K}},
+                  [&] { keep(k_find_witnesses_knapsack(a, shortB, cs, K)); });
+    }
+
+    // Algorithm 4 on p independent rows of length n (weights are a permutation of [0, n))
+    for (int n : bench.sweep({256, 1024})) {
+        int rows = 8;
+        mt19937 rng(10);
+        vector<vector<int>> a(rows), b(rows), c(rows);
+        for (int i = 0; i < rows; i++) {
+            a[i] = randomBits(n, 0.3, 11 + i);
+            b[i] = randomBits(n, 0.3, 31 + i);
+            c[i] = convolution(a[i], b[i]);
+        }
+        vector<int> w(n + 1), order(n + 1);
+        for (int i = 1; i <= n; i++) {
+            w[i] = i - 1;
+            order[i] = i;
+        }
+        shuffle(w.begin() + 1, w.end(), rng);
+        shuffle(order.begin() + 1, order.end(), rng);
+        bench.run("adaptiveMinWitness_randomized", {{"n", n}, {"rows", rows}},
+                  [&] { keep(adaptiveMinWitness_randomized(a, b, c, w, order, 12)); });
+    }
+    return bench.finish();
+}
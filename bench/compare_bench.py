@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""Compares two benchmark reports (or two directories of them) written by the bench_* executables.
+
+usage: compare_bench.py BASE NEW [--threshold 0.10]
+
+Points are matched by suite, name and parameters. A point regresses if its median grew by more than the
+threshold and by more than two standard deviations of the base run. The exit code is 1 if any point regressed.
+"""
+import argparse
+import json
+import os
+import sys
+
+def load(path):
+    files = [path]
+    if os.path.isdir(path):
+        files = sorted(os.path.join(path, f) for f in os.listdir(path) if f.endswith(".json"))
+    points, commit = {}, None
+    for f in files:
+        with open(f) as fh:
+            report = json.load(fh)
+        commit = report.get("commit", commit)
+        for r in report["results"]:
+            key = (report["suite"], r["name"], tuple(sorted(r["params"].items())))
+            points[key] = r
+    return points, commit
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("base")
+    ap.add_argument("new")
+    ap.add_argument("--threshold", type=float, default=0.10)
+    args = ap.parse_args()
+
+    base, base_commit = load(args.base)
+    new, new_commit = load(args.new)
+    print(f"base {base_commit}  ->  new {new_commit}")
+    print(f"{'suite':12} {'benchmark':34} {'point':28} {'base(s)':>10} {'new(s)':>10} {'ratio':>7}")
+    regressions = 0
+    for key in sorted(base.keys() & new.keys()):
+        suite, name, params = key
+        b, n = base[key], new[key]
+        ratio = n["median_s"] / b["median_s"] if b["median_s"] > 0 else float("inf")
+        slower = n["median_s"] - b["median_s"] > max(args.threshold * b["median_s"], 2 * b["stddev_s"])
+        regressions += slower
+        point = " ".join(f"{k}={v}" for k, v in params)
+        flag = "  REGRESSION" if slower else ""
+        print(f"{suite:12} {name:34} {point:28} {b['median_s']:10.6f} {n['median_s']:10.6f} {ratio:7.3f}{flag}")
+    for key in sorted(base.keys() ^ new.keys()):
+        print(f"only in {'base' if key in base else 'new'}: {key[0]} {key[1]} {dict(key[2])}")
+    sys.exit(1 if regressions else 0)
+
+if __name__ == "__main__":
+    main()
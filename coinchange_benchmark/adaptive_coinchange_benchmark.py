@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+import os
+import subprocess
+import random
+import matplotlib.pyplot as plt
+
+# --- paths ----------------------------------------
+SCRIPT   = os.path.dirname(os.path.abspath(__file__))
+INCLUDE  = os.path.join(SCRIPT, '..', 'include')
+TRAD     = os.path.join(SCRIPT, 'coinchange_traditional')
+SIMPLE   = os.path.join(SCRIPT, 'coinchange_simplified_solver')
+ADAPTIVE = os.path.join(SCRIPT, 'coinchange_adaptive_solver')
+# --------------------------------------------------
+
+# Benchmark parameters: n = u, T = 4u
+Us      = [2**i for i in range(8, 19)]
+CHECK_U = 2**14   # only compare against the traditional DP up to this u
+ADAPTIVE_LIMIT = 300  # seconds; larger u skip the adaptive kernel once a run exceeds this
+
+def compile_solvers():
+    subprocess.run([
+        'g++-14','-std=c++20','-O2',
+        'coinchange_traditional.cpp',
+        '-o', TRAD
+    ], cwd=SCRIPT, check=True)
+
+    deps = [os.path.join('..','src',f) for f in
+            ('algorithms.cpp','dp_structs.cpp','witness.cpp','convolution.cpp','arena.cpp','memory_budget.cpp','trace.cpp','hitting_set.cpp','peeling.cpp','thread_pool.cpp','coin_set.cpp')]
+    for src, exe in (('coinchange_simplified_solver.cpp', SIMPLE),
+                     ('coinchange_adaptive_solver.cpp', ADAPTIVE)):
+        subprocess.run([
+            'g++-14','-std=c++20','-O2',
+            '-I', INCLUDE,
+            src, *deps, '-pthread',
+            '-o', exe
+        ], cwd=SCRIPT, check=True)
+
+def build_input(u, T):
+    weights = random.sample(range(1, u+1), u)
+    s = f"{u} {u} {T}\n"
+    for w in weights:
+        s += f"{w} -1\n"
+    return s
+
+def kernel_time(stderr: str):
+    for line in stderr.splitlines():
+        if line.startswith("Kernel computation took"):
+            return float(line.split()[3])
+    return None
+
+def run_benchmark():
+    print("     u    | Simple(s) Adaptive(s)  OK?")
+    print("----------+----------------------------")
+    simple_times, adaptive_times = [], []
+    adaptive_on = True
+    for u in Us:
+        inp = build_input(u, 4*u)
+        proc = subprocess.run([SIMPLE], input=inp, text=True, capture_output=True, check=True)
+        out, t_simple = proc.stdout.splitlines(), kernel_time(proc.stderr)
+        t_adaptive, ok = float('nan'), True
+        if adaptive_on:
+            try:
+                proc = subprocess.run([ADAPTIVE], input=inp, text=True, capture_output=True,
+                                      check=True, timeout=ADAPTIVE_LIMIT)
+                t_adaptive = kernel_time(proc.stderr)
+                ok = out == proc.stdout.splitlines()
+            except subprocess.TimeoutExpired:
+                adaptive_on = False
+        if u <= CHECK_U:
+            trad = subprocess.run([TRAD], input=inp, text=True, capture_output=True, check=True)
+            ok = ok and out == trad.stdout.splitlines()
+        adaptive_col = f"{t_adaptive:11.4f}" if t_adaptive == t_adaptive else f"{'> limit':>11}"
+        print(f"{u:9d} | {t_simple:9.4f} {adaptive_col}   {'Y' if ok else 'N'}")
+        simple_times.append(t_simple)
+        adaptive_times.append(t_adaptive)
+
+    plt.figure()
+    plt.plot(Us, simple_times, marker='o')
+    plt.plot(Us, adaptive_times, marker='o')
+    plt.xscale('log', base=2)
+    plt.yscale('log')
+    plt.xlabel("u (= n)")
+    plt.ylabel("Kernel time (s)")
+    plt.legend(["Simplified (sqrt n)", "Adaptive (Algorithm 4)"])
+    plt.title("CoinChange kernel: adaptive vs simplified")
+    plt.tight_layout()
+    plt.show()
+
+if __name__ == "__main__":
+    random.seed(0)
+    compile_solvers()
+    run_benchmark()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+import os
+import subprocess
+import random
+import matplotlib.pyplot as plt
+
+# --- paths ----------------------------------------
+SCRIPT  = os.path.dirname(os.path.abspath(__file__))
+INCLUDE = os.path.join(SCRIPT, '..', 'include')
+TRAD    = os.path.join(SCRIPT, 'coinchange_count_traditional')
+NTT     = os.path.join(SCRIPT, 'coinchange_count_solver')
+# --------------------------------------------------
+
+# Benchmark parameters: u = 4096, T = 2^20, growing n (countCoinChange() switches from its DP to the
+# log/exp near n = 8000, so the last points exercise the NTT path)
+U  = 4096
+T  = 2**20
+Ns = [2**i for i in range(4, 15)]
+
+def compile_solvers():
+    subprocess.run([
+        'g++-14','-std=c++20','-O2',
+        'coinchange_count_traditional.cpp',
+        '-o', TRAD
+    ], cwd=SCRIPT, check=True)
+
+    deps = [os.path.join('..','src',f) for f in
+            ('algorithms.cpp','dp_structs.cpp','witness.cpp','convolution.cpp','arena.cpp','memory_budget.cpp','trace.cpp','hitting_set.cpp','peeling.cpp','thread_pool.cpp','coin_set.cpp')]
+    subprocess.run([
+        'g++-14','-std=c++20','-O2',
+        '-I', INCLUDE,
+        'coinchange_count_solver.cpp', *deps, '-pthread',
+        '-o', NTT
+    ], cwd=SCRIPT, check=True)
+
+def build_input(n):
+    weights = random.sample(range(1, U+1), n)
+    s = f"{n} {U} {T}\n"
+    for w in weights:
+        s += f"{w} -1\n"
+    return s
+
+def count_time(stderr: str):
+    for line in stderr.splitlines():
+        if line.startswith("Counting took"):
+            return float(line.split()[2])
+    return None
+
+def run_benchmark():
+    print("     n    |   DP(s)   Lib(s)  OK?")
+    print("----------+------------------------")
+    dp_times, ntt_times = [], []
+    for n in Ns:
+        inp = build_input(n)
+        trad = subprocess.run([TRAD], input=inp, text=True, capture_output=True, check=True)
+        fast = subprocess.run([NTT], input=inp, text=True, capture_output=True, check=True)
+        ok = trad.stdout == fast.stdout
+        t_dp, t_ntt = count_time(trad.stderr), count_time(fast.stderr)
+        print(f"{n:9d} | {t_dp:8.4f} {t_ntt:8.4f}   {'Y' if ok else 'N'}")
+        dp_times.append(t_dp)
+        ntt_times.append(t_ntt)
+
+    plt.figure()
+    plt.plot(Ns, dp_times, marker='o')
+    plt.plot(Ns, ntt_times, marker='o')
+    plt.xscale('log', base=2)
+    plt.yscale('log')
+    plt.xlabel("n (u = 4096, T = 2^20)")
+    plt.ylabel("Time (s)")
+    plt.legend(["O(n T) DP", "countCoinChange (DP, then NTT log/exp)"])
+    plt.title("All-target coin change counting")
+    plt.tight_layout()
+    plt.show()
+
+if __name__ == "__main__":
+    random.seed(0)
+    compile_solvers()
+    run_benchmark()
@@ -0,0 +1,30 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "algorithms.h"
+using namespace std;
+
+int main(){
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    int n, u, T;
+    if(!(cin >> n >> u >> T)) return 0;
+
+    // Read coins (1-indexed); profits are ignored
+    vector<int> w(n+1), p(n+1);
+    for(int i = 1; i <= n; i++){
+        cin >> w[i] >> p[i];
+    }
+
+    auto t0 = chrono::high_resolution_clock::now();
+    vector<ll> ways = countCoinChange(n, w, T);
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Counting took " << chrono::duration<double>(t1 - t0).count() << " s\n";
+
+    // number of coin multisets of every sum, modulo 998244353
+    for(int t = 0; t <= T; t++){
+        cout << ways[t] << "\n";
+    }
+    return 0;
+}
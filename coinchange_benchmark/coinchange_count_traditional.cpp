@@ -0,0 +1,33 @@
+// coinchange_count_traditional.cpp
+#include <bits/stdc++.h>
+using namespace std;
+
+int main(){
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    int n,u,T;
+    if(!(cin>>n>>u>>T)) return 0;
+    vector<int> w(n), p(n);
+    for(int i=0;i<n;i++){
+        cin>>w[i]>>p[i]; // p[i] is ignored here
+    }
+
+    const int MOD = 998244353;
+    auto t0 = chrono::high_resolution_clock::now();
+    vector<int> dp(T+1, 0);
+    dp[0] = 1;
+    for(int i=0;i<n;i++){
+        for(int t=w[i]; t<=T; t++){
+            dp[t] += dp[t-w[i]];
+            if(dp[t] >= MOD) dp[t] -= MOD;
+        }
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Counting took " << chrono::duration<double>(t1 - t0).count() << " s\n";
+
+    for(int t=0; t<=T; t++){
+        cout << dp[t] << "\n";
+    }
+    return 0;
+}
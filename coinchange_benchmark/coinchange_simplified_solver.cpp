@@ -4,6 +4,7 @@
 #include <algorithm>
 #include "algorithms.h"
 #include "dp_structs.h"
+#include "arena.h"
 using namespace std;
 
 int main(){
@@ -22,10 +23,11 @@ int main(){
 
     vector<solution> sol;
     auto total_start = chrono::high_resolution_clock::now();
+    CoinSet cs(n, u, w, p, order); // shared by the kernel and the propagation
 
     // 1) Kernel computation
     auto k0 = chrono::high_resolution_clock::now();
-    kernelComputation_coinchange_simple(n, u, w, p, order, T, sol);
+    kernelComputation_coinchange_simple(cs, T, sol);
     auto k1 = chrono::high_resolution_clock::now();
     double ktime = chrono::duration<double>(k1 - k0).count();
     cerr << "Kernel computation took " << ktime << " s\n";
@@ -50,7 +52,7 @@ int main(){
 
     // 3) Witness propagation
     auto p0 = chrono::high_resolution_clock::now();
-    propagation(w, p, T, sol, order);
+    propagation(cs, T, sol);
     auto p1 = chrono::high_resolution_clock::now();
     double ptime = chrono::duration<double>(p1 - p0).count();
     cerr << "Witness propagation took " << ptime << " s\n";
@@ -59,6 +61,7 @@ int main(){
     auto total_end = chrono::high_resolution_clock::now();
     double tot = chrono::duration<double>(total_end - total_start).count();
     cerr << "Total elapsed time: " << tot << " s\n";
+    arenaReport(cerr);
 
     // 5) Emit the coin‐change result (# coins or -1)
     for(int t = 0; t <= T; t++){
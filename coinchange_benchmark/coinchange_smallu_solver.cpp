@@ -0,0 +1,37 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "small_u.h"
+using namespace std;
+
+int main(){
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    int n, u, T;
+    if(!(cin >> n >> u >> T)) return 0;
+
+    // Read coins (1-indexed) and set up identity order
+    vector<int> w(n+1), p(n+1), order(n+1);
+    for(int i = 1; i <= n; i++){
+        cin >> w[i] >> p[i];
+        order[i] = i;
+    }
+
+    auto total_start = chrono::high_resolution_clock::now();
+    CoinSet cs(n, u, w, p, order);
+    if(!smallUSupported(cs)){
+        cerr << "u = " << cs.u << " exceeds " << SMALL_U_MAX << ", use coinchange_simplified_solver\n";
+        return 1;
+    }
+    vector<ll> coins = coinChangeSmallU(cs, T);
+    auto total_end = chrono::high_resolution_clock::now();
+    double tot = chrono::duration<double>(total_end - total_start).count();
+    cerr << "Total elapsed time: " << tot << " s\n";
+
+    // Emit the coin-change result (# coins or -1)
+    for(int t = 0; t <= T; t++){
+        cout << coins[t] << "\n";
+    }
+    return 0;
+}
@@ -34,8 +34,14 @@ def compile_solvers():
         os.path.join('..','src','algorithms.cpp'),
         os.path.join('..','src','dp_structs.cpp'),
         os.path.join('..','src','witness.cpp'),
+        os.path.join('..','src','coin_set.cpp'),
         os.path.join('..','src','convolution.cpp'),
+        os.path.join('..','src','arena.cpp'),
+        os.path.join('..','src','memory_budget.cpp'),
+        os.path.join('..','src','trace.cpp'),
         os.path.join('..','src','hitting_set.cpp'),
+        os.path.join('..','src','thread_pool.cpp'),
+        '-pthread',
         '-o', SOLVER
     ], cwd=SCRIPT, check=True)
 
@@ -15,11 +15,21 @@ TRIALS = 1
 
 def compile_solver():
     subprocess.run([
-        'g++-14','-std=c++20','-O2',
+        'g++-14','-std=c++20','-O2','-DFASTKNAPSACK_INSTRUMENT',
         '-I', INCLUDE,
         'simplified_coinchange_ops.cpp',
+        os.path.join('..','src','algorithms.cpp'),
         os.path.join('..','src','dp_structs.cpp'),
+        os.path.join('..','src','witness.cpp'),
+        os.path.join('..','src','coin_set.cpp'),
         os.path.join('..','src','convolution.cpp'),
+        os.path.join('..','src','arena.cpp'),
+        os.path.join('..','src','memory_budget.cpp'),
+        os.path.join('..','src','trace.cpp'),
+        os.path.join('..','src','hitting_set.cpp'),
+        os.path.join('..','src','thread_pool.cpp'),
+        os.path.join('..','src','instrument.cpp'),
+        '-pthread',
         '-o', EXE
     ], cwd=BASE, check=True)
 
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+import os
+import subprocess
+import time
+import random
+import matplotlib.pyplot as plt
+
+# --- paths ----------------------------------------
+SCRIPT  = os.path.dirname(os.path.abspath(__file__))
+INCLUDE = os.path.join(SCRIPT, '..', 'include')
+TRAD    = os.path.join(SCRIPT, 'coinchange_traditional')
+FFT     = os.path.join(SCRIPT, 'coinchange_simplified_solver')
+BITS    = os.path.join(SCRIPT, 'coinchange_smallu_solver')
+# --------------------------------------------------
+
+# Benchmark parameters: small-denomination coin systems, T = 2^22
+T  = 2**22
+Us = [16, 32, 64, 128, 256, 511]
+N  = 12  # denominations per system
+
+DEPS = ('algorithms.cpp','dp_structs.cpp','witness.cpp','coin_set.cpp','convolution.cpp','arena.cpp','memory_budget.cpp','trace.cpp','hitting_set.cpp',
+        'thread_pool.cpp','small_u.cpp')
+
+def compile_solvers():
+    subprocess.run([
+        'g++-14','-std=c++20','-O2',
+        'coinchange_traditional.cpp',
+        '-o', TRAD
+    ], cwd=SCRIPT, check=True)
+    for src, out in (('coinchange_simplified_solver.cpp', FFT), ('coinchange_smallu_solver.cpp', BITS)):
+        subprocess.run([
+            'g++-14','-std=c++20','-O2',
+            '-I', INCLUDE,
+            src, *[os.path.join('..','src',f) for f in DEPS], '-pthread',
+            '-o', out
+        ], cwd=SCRIPT, check=True)
+
+def build_input(u):
+    weights = random.sample(range(1, u+1), min(N, u))
+    s = f"{len(weights)} {u} {T}\n"
+    for w in weights:
+        s += f"{w} -1\n"
+    return s
+
+def run(binary, inp):
+    t0 = time.time()
+    res = subprocess.run([binary], input=inp, text=True, capture_output=True, check=True)
+    return res.stdout, time.time() - t0
+
+def run_benchmark():
+    print("    u    |   DP(s)   FFT kernel(s)  bit-parallel(s)  OK?")
+    print("---------+-----------------------------------------------")
+    times = {'dp': [], 'fft': [], 'bits': []}
+    for u in Us:
+        inp = build_input(u)
+        out_dp, t_dp = run(TRAD, inp)
+        out_fft, t_fft = run(FFT, inp)
+        out_bits, t_bits = run(BITS, inp)
+        ok = out_dp == out_fft == out_bits
+        print(f"{u:8d} | {t_dp:8.4f} {t_fft:14.4f} {t_bits:16.4f}   {'Y' if ok else 'N'}")
+        times['dp'].append(t_dp)
+        times['fft'].append(t_fft)
+        times['bits'].append(t_bits)
+
+    plt.figure()
+    for key in ('dp', 'fft', 'bits'):
+        plt.plot(Us, times[key], marker='o')
+    plt.xscale('log', base=2)
+    plt.xlabel(f"u (n = {N}, T = 2^22, wall time incl. I/O)")
+    plt.ylabel("Time (s)")
+    plt.legend(["O(n T) DP", "Simplified kernel + Alg. 1", "Bit-parallel small-u engine"])
+    plt.title("All-target coin change, small denominations")
+    plt.tight_layout()
+    plt.show()
+
+if __name__ == "__main__":
+    random.seed(0)
+    compile_solvers()
+    run_benchmark()
@@ -0,0 +1,906 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "algorithms.h"
+#include "bounded.h"
+#include "classical.h"
+#include "dispatch.h"
+#include "hitting_set.h"
+#include "instrument.h"
+#include "memory_budget.h"
+#include "peeling.h"
+#include "periodic.h"
+#include "query.h"
+using namespace std;
+
+/**
+ * Differential fuzzer: every kernel, witness and convolution variant of the library against an in-process
+ * reference (the classical DPs of classical.h, brute-force witnesses, schoolbook convolutions).
+ *
+ * Case i of a run is generated from (--seed, i) alone, so `--case i` reruns it. A case is a coin set with
+ * profits, caps and a lex order, a target t and a 0/1 vector b; the witness and convolution checks take the
+ * coin indicator cs.f as the first operand and b as the second. The shapes aim at the corners of the
+ * algorithms: duplicate and dominated weights, a common gcd, a single coin, only heavy coins, dense weight
+ * ranges, equal profit/weight ratios, large and negative profits, t below u and t = 0.
+ *
+ * Every check times the library call and the reference separately; the summary prints the speedup over all
+ * cases and over the large ones only, where it means something. A failing case is shrunk (coins dropped, t,
+ * weights, profits and b reduced) for as long as the check keeps failing, printed and, with --out, written
+ * as a .case file that --replay reads back. The exit code is 1 if any check failed, so a run with many
+ * iterations is the gate a new or faster mode has to pass. A few fixed regression instances that the generator
+ * cannot reach (targets in the billions, a large hitting-set round) run first.
+ *
+ * usage: differential_fuzz [--iterations N] [--seed S] [--case I] [--filter S] [--max-n N] [--max-u U]
+ *                          [--max-t T] [--time-limit SEC] [--out DIR] [--json FILE] [--replay FILE] [--list]
+ */
+
+const int K_WITNESSES = 4;            ///< k of the k-witness checks
+const int MINIMIZE_RUNS = 3000;       ///< check runs spent on shrinking one failing case
+
+struct FuzzCase {
+    int n = 0;
+    int u = 0;                         ///< maximum weight
+    int t = 0;
+    vector<int> w, p, cap, order;      ///< 1-indexed coins, cap < 0 = unlimited, lex order σ[1..n]
+    vector<int> b;                     ///< second operand of the witness and convolution checks
+    unsigned seed = 0;                 ///< seed of the seeded randomized variants
+    string shape;
+    bool large = false;
+};
+
+struct Timing {
+    double fast = 0;
+    double reference = 0;
+};
+
+/// Runs f and adds its wall time to `seconds`.
+template <typename F>
+static auto timed(double& seconds, F&& f) {
+    auto t0 = chrono::steady_clock::now();
+    auto r = f();
+    seconds += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+/// Restores the memory budget at the end of a check that runs under a tiny one.
+class BudgetOverride {
+public:
+    explicit BudgetOverride(size_t bytes) : saved(memoryBudget()) { setMemoryBudget(bytes); }
+    ~BudgetOverride() { setMemoryBudget(saved); }
+
+private:
+    size_t saved;
+};
+
+static CoinSet coins(const FuzzCase& c) {
+    return CoinSet(c.n, c.u, c.w, c.p, c.order);
+}
+
+/// "" if equal, else the first target that differs.
+static string compareValues(const vector<ll>& got, const vector<ll>& want) {
+    if (got.size() != want.size()) {
+        return "returned " + to_string(got.size()) + " values, expected " + to_string(want.size());
+    }
+    for (size_t c = 0; c < want.size(); c++) {
+        if (got[c] != want[c]) {
+            return "target " + to_string(c) + ": got " + to_string(got[c]) + ", expected " + to_string(want[c]);
+        }
+    }
+    return "";
+}
+
+// ---------------------------------------------------------------- references
+
+/// Bounded knapsack, one 0/1 pass per copy.
+static vector<ll> referenceBounded(const FuzzCase& c) {
+    vector<ll> dp(c.t + 1, NEG_INF);
+    dp[0] = 0;
+    for (int i = 1; i <= c.n; i++) {
+        if (c.cap[i] < 0) {
+            for (int x = c.w[i]; x <= c.t; x++)
+                if (dp[x - c.w[i]] > NEG_INF) dp[x] = max(dp[x], dp[x - c.w[i]] + c.p[i]);
+            continue;
+        }
+        for (int copy = 0; copy < c.cap[i]; copy++) {
+            for (int x = c.t; x >= c.w[i]; x--)
+                if (dp[x - c.w[i]] > NEG_INF) dp[x] = max(dp[x], dp[x - c.w[i]] + c.p[i]);
+        }
+    }
+    return dp;
+}
+
+/// Number of coin multisets of every sum modulo NTT_MOD.
+static vector<ll> referenceCount(const FuzzCase& c) {
+    vector<ll> dp(c.t + 1, 0);
+    dp[0] = 1;
+    for (int i = 1; i <= c.n; i++)
+        for (int x = c.w[i]; x <= c.t; x++) dp[x] = (dp[x] + dp[x - c.w[i]]) % NTT_MOD;
+    return dp;
+}
+
+/// Smallest reachable sum of every residue modulo the smallest weight (-1 if none), by Dijkstra.
+static vector<ll> referenceResidues(const FuzzCase& c) {
+    int m = *min_element(c.w.begin() + 1, c.w.end());
+    vector<ll> dist(m, LLONG_MAX);
+    priority_queue<pair<ll,int>, vector<pair<ll,int>>, greater<>> pq;
+    dist[0] = 0;
+    pq.push({0, 0});
+    while (!pq.empty()) {
+        auto [d, r] = pq.top();
+        pq.pop();
+        if (d != dist[r]) continue;
+        for (int i = 1; i <= c.n; i++) {
+            int s = (int)((r + c.w[i]) % m);
+            if (d + c.w[i] < dist[s]) {
+                dist[s] = d + c.w[i];
+                pq.push({dist[s], s});
+            }
+        }
+    }
+    for (ll& d : dist)
+        if (d == LLONG_MAX) d = -1;
+    return dist;
+}
+
+static vector<int> schoolbookConvolution(const vector<int>& a, const vector<int>& b) {
+    vector<int> c(a.size() + b.size() - 1, 0);
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] == 0) continue;
+        for (size_t j = 0; j < b.size(); j++) c[i + j] += a[i] * b[j];
+    }
+    return c;
+}
+
+/// wit[r] = order indices x (ascending) with a[w(x)] = 1 and b[r - w(x)] = 1; coins of one weight appear once
+/// (as the smallest order index of the weight), as in the witness functions.
+static vector<vector<int>> bruteWitnesses(const CoinSet& cs, const vector<int>& a, const vector<int>& b) {
+    int R = (int)(a.size() + b.size()) - 1;
+    vector<vector<int>> wit(R);
+    for (int x = 1; x <= cs.n; x++) {
+        int wt = cs.weightAt(x);
+        if (wt >= (int)a.size() || a[wt] == 0 || cs.indexOfWeight[wt] != x) continue;
+        for (int j = 0; j < (int)b.size(); j++)
+            if (b[j]) wit[wt + j].push_back(x);
+    }
+    return wit;
+}
+
+/// "" if `got` holds min(k, |wit|) distinct members of `wit` for every entry.
+static string compareWitnessSets(const vector<vector<int>>& got, const vector<vector<int>>& wit, int k, const char* unit) {
+    if (got.size() != wit.size()) {
+        return "returned " + to_string(got.size()) + " entries, expected " + to_string(wit.size());
+    }
+    for (size_t r = 0; r < wit.size(); r++) {
+        vector<int> g = got[r];
+        sort(g.begin(), g.end());
+        for (size_t e = 0; e < g.size(); e++) {
+            if (e > 0 && g[e] == g[e - 1]) return "entry " + to_string(r) + ": " + unit + " " + to_string(g[e]) + " twice";
+            if (!binary_search(wit[r].begin(), wit[r].end(), g[e]))
+                return "entry " + to_string(r) + ": " + unit + " " + to_string(g[e]) + " is not a witness";
+        }
+        size_t want = min<size_t>(k, wit[r].size());
+        if (g.size() != want) {
+            return "entry " + to_string(r) + ": " + to_string(g.size()) + " witnesses, expected " + to_string(want);
+        }
+    }
+    return "";
+}
+
+/// "" if got[r] is the minimum of wit[r] (-1 if empty) for every entry.
+static string compareMinWitness(const vector<int>& got, const vector<vector<int>>& wit) {
+    if (got.size() != wit.size()) {
+        return "returned " + to_string(got.size()) + " entries, expected " + to_string(wit.size());
+    }
+    for (size_t r = 0; r < wit.size(); r++) {
+        int want = wit[r].empty() ? -1 : wit[r][0];
+        if (got[r] != want) {
+            return "entry " + to_string(r) + ": got " + to_string(got[r]) + ", expected " + to_string(want);
+        }
+    }
+    return "";
+}
+
+// ---------------------------------------------------------------- checks
+
+struct Check {
+    const char* name;
+    function<string(const FuzzCase&, Timing&)> run;  ///< "" if the variant agrees with the reference
+};
+
+static string checkSolve(Strategy s, Problem problem, bool streamed, const FuzzCase& c, Timing& tm) {
+    vector<ll> want = timed(tm.reference, [&] {
+        return problem == Problem::Knapsack ? classicalKnapsack(c.n, c.w, c.p, c.t) : classicalCoinChange(c.n, c.w, c.t);
+    });
+    SolveResult res;
+    if (streamed) {
+        BudgetOverride budget(1);
+        res = timed(tm.fast, [&] { return solveWith(s, problem, c.n, c.w, c.p, c.t); });
+        if (!res.streamed) return "did not stream the targets under a 1-byte budget";
+    } else {
+        res = timed(tm.fast, [&] { return solveWith(s, problem, c.n, c.w, c.p, c.t); });
+    }
+    return compareValues(res.value, want);
+}
+
+static vector<Check> allChecks() {
+    vector<Check> checks;
+    auto solveCheck = [&](const char* name, Strategy s, Problem problem, bool streamed) {
+        checks.push_back({name, [=](const FuzzCase& c, Timing& tm) { return checkSolve(s, problem, streamed, c, tm); }});
+    };
+    solveCheck("knapsack.kernel", Strategy::Kernel, Problem::Knapsack, false);
+    solveCheck("knapsack.kernel.streamed", Strategy::Kernel, Problem::Knapsack, true);
+    solveCheck("coinchange.simple", Strategy::CoinChangeSimple, Problem::CoinChange, false);
+    solveCheck("coinchange.randomized", Strategy::CoinChangeRandomized, Problem::CoinChange, false);
+    solveCheck("coinchange.adaptive", Strategy::CoinChangeAdaptive, Problem::CoinChange, false);
+    solveCheck("coinchange.smallu", Strategy::CoinChangeSmallU, Problem::CoinChange, false);
+    solveCheck("coinchange.simple.streamed", Strategy::CoinChangeSimple, Problem::CoinChange, true);
+    solveCheck("coinchange.adaptive.streamed", Strategy::CoinChangeAdaptive, Problem::CoinChange, true);
+
+    checks.push_back({"knapsack.periodic", [](const FuzzCase& c, Timing& tm) {
+        vector<ll> want = timed(tm.reference, [&] { return classicalKnapsack(c.n, c.w, c.p, c.t); });
+        PeriodicKnapsack pk;
+        if (!timed(tm.fast, [&] { return buildPeriodicKnapsack(c.n, c.u, c.w, c.p, c.order, pk); })) {
+            return string("rejected a base of ") + to_string(periodicBaseSize(coins(c))) + " targets";
+        }
+        vector<ll> got = timed(tm.fast, [&] {
+            vector<ll> v(c.t + 1);
+            for (int x = 0; x <= c.t; x++) v[x] = pk.value(x);
+            return v;
+        });
+        return compareValues(got, want);
+    }});
+    checks.push_back({"knapsack.query", [](const FuzzCase& c, Timing& tm) {
+        vector<ll> want = timed(tm.reference, [&] { return classicalKnapsack(c.n, c.w, c.p, c.t); });
+        // a descending batch, then single queries that land below what the batch propagated
+        vector<ll> targets;
+        for (int x = c.t; x >= 0; x -= max(1, c.t / 64)) targets.push_back(x);
+        vector<ll> got = timed(tm.fast, [&] {
+            TargetQuery q(coins(c));
+            vector<ll> v = q.values(targets);
+            for (int x = 0; x <= min(c.t, 2 * c.u); x++) v.push_back(q.value(x));
+            return v;
+        });
+        for (int x = 0; x <= min(c.t, 2 * c.u); x++) targets.push_back(x);
+        vector<ll> sparse(targets.size());
+        for (size_t i = 0; i < targets.size(); i++) sparse[i] = want[targets[i]];
+        return compareValues(got, sparse);
+    }});
+    checks.push_back({"knapsack.bounded", [](const FuzzCase& c, Timing& tm) {
+        vector<ll> want = timed(tm.reference, [&] { return referenceBounded(c); });
+        vector<ll> got = timed(tm.fast, [&] {
+            BoundedKnapsack bk;
+            solveBoundedKnapsack(c.n, c.w, c.p, c.cap, c.t, false, bk);
+            return bk.value;
+        });
+        string err = compareValues(got, want);
+        if (!err.empty()) return err;
+        // the kept decisions must rebuild a multiset within the caps, of weight c and profit value[c]
+        BoundedKnapsack bk;
+        solveBoundedKnapsack(c.n, c.w, c.p, c.cap, c.t, true, bk);
+        for (int x = 0; x <= c.t; x++) {
+            if (bk.value[x] == NEG_INF) continue;
+            vector<ll> cnt = bk.counts(x);
+            ll weight = 0, profit = 0;
+            for (int i = 1; i <= c.n; i++) {
+                if (cnt[i] < 0 || (c.cap[i] >= 0 && cnt[i] > c.cap[i])) return "counts(" + to_string(x) + ") exceeds a cap";
+                weight += cnt[i] * c.w[i];
+                profit += cnt[i] * c.p[i];
+            }
+            if (weight != x || profit != bk.value[x]) return "counts(" + to_string(x) + ") does not rebuild the target";
+        }
+        return string();
+    }});
+    checks.push_back({"coinchange.count", [](const FuzzCase& c, Timing& tm) {
+        vector<ll> want = timed(tm.reference, [&] { return referenceCount(c); });
+        vector<ll> got = timed(tm.fast, [&] { return countCoinChange(c.n, c.w, c.t); });
+        return compareValues(got, want);
+    }});
+    // generated cases are small enough for countCoinChange() to always pick the DP
+    checks.push_back({"coinchange.count.exp", [](const FuzzCase& c, Timing& tm) {
+        vector<ll> want = timed(tm.reference, [&] { return referenceCount(c); });
+        CoinSet cs(c.n, 0, c.w, {}, c.order);
+        vector<ll> got = timed(tm.fast, [&] { return countCoinChangeExp(cs, c.t); });
+        return compareValues(got, want);
+    }});
+    checks.push_back({"coinchange.residue", [](const FuzzCase& c, Timing& tm) {
+        vector<ll> want = timed(tm.reference, [&] { return referenceResidues(c); });
+        vector<ll> got = timed(tm.fast, [&] {
+            vector<solution> res;
+            residueTable(coins(c), res);
+            vector<ll> v(res.size());
+            for (size_t r = 0; r < res.size(); r++) v[r] = (r > 0 && res[r].size == 0) ? -1 : res[r].weight;
+            return v;
+        });
+        return compareValues(got, want);
+    }});
+
+    checks.push_back({"witness.min_ordered", [](const FuzzCase& c, Timing& tm) {
+        CoinSet cs = coins(c);
+        vector<int> a = cs.f, b = c.b;
+        auto wit = timed(tm.reference, [&] { return bruteWitnesses(cs, a, b); });
+        vector<int> got = timed(tm.fast, [&] { return minimum_witness_boolCnv_ordered(a, b, cs); });
+        return compareMinWitness(got, wit);
+    }});
+    checks.push_back({"witness.min_random", [](const FuzzCase& c, Timing& tm) {
+        CoinSet cs = coins(c);
+        vector<int> a = cs.f, b = c.b;
+        auto wit = timed(tm.reference, [&] { return bruteWitnesses(cs, a, b); });
+        vector<int> got = timed(tm.fast, [&] { return minimum_witness_random(a, b, cs); });
+        return compareMinWitness(got, wit);
+    }});
+    checks.push_back({"witness.sampling", [](const FuzzCase& c, Timing& tm) {
+        CoinSet cs = coins(c);
+        auto wit = timed(tm.reference, [&] { return bruteWitnesses(cs, cs.f, c.b); });
+        vector<int> got = timed(tm.fast, [&] { return randomized_witness_sampling(cs.f, c.b); });
+        // the sample is a weight; one witness per entry that has any
+        vector<vector<int>> asIndex(got.size());
+        for (size_t r = 0; r < got.size(); r++) {
+            if (got[r] < 0) continue;
+            asIndex[r].push_back(got[r] <= cs.u ? cs.indexOfWeight[got[r]] : -1);
+        }
+        return compareWitnessSets(asIndex, wit, 1, "weight index");
+    }});
+    checks.push_back({"witness.k", [](const FuzzCase& c, Timing& tm) {
+        CoinSet cs = coins(c);
+        auto wit = timed(tm.reference, [&] { return bruteWitnesses(cs, cs.f, c.b); });
+        vector<int> wanted(wit.size(), 1);
+        auto got = timed(tm.fast, [&] { return randomized_k_witness(cs.f, c.b, K_WITNESSES, cs, wanted, c.seed); });
+        return compareWitnessSets(got, wit, K_WITNESSES, "order index");
+    }});
+    checks.push_back({"witness.peeling", [](const FuzzCase& c, Timing& tm) {
+        CoinSet cs = coins(c);
+        vector<int> a = cs.f, b = c.b;
+        // recovered[i] = pattern positions x with a[i - x] = b[x] = 1, for i < |a| - |b| + 1
+        auto wit = timed(tm.reference, [&] {
+            vector<vector<int>> v(a.size() - b.size() + 1);
+            for (int i = 0; i < (int)v.size(); i++)
+                for (int x = 0; x <= min(i, (int)b.size() - 1); x++)
+                    if (b[x] && a[i - x]) v[i].push_back(x);
+            return v;
+        });
+        auto got = timed(tm.fast, [&] { return k_find_witnesses_randomized(a, b, K_WITNESSES); });
+        return compareWitnessSets(got, wit, K_WITNESSES, "position");
+    }});
+    checks.push_back({"witness.adaptive", [](const FuzzCase& c, Timing& tm) {
+        // a few rows sharing the coins: b, b reversed, b shifted by one
+        CoinSet cs = coins(c);
+        vector<vector<int>> a(3, cs.f), b(3, c.b), conv(3);
+        reverse(b[1].begin(), b[1].end());
+        rotate(b[2].begin(), b[2].begin() + (b[2].size() > 1), b[2].end());
+        for (int i = 0; i < 3; i++) conv[i] = convolution(a[i], b[i]);
+        auto got = timed(tm.fast, [&] { return adaptiveMinWitness_randomized(a, b, conv, cs, c.seed); });
+        // minimum witnesses under the order the call adapted
+        for (int i = 0; i < 3; i++) {
+            auto wit = timed(tm.reference, [&] { return bruteWitnesses(cs, a[i], b[i]); });
+            string err = compareMinWitness(got[i], wit);
+            if (!err.empty()) return "row " + to_string(i) + ", " + err;
+        }
+        return string();
+    }});
+
+    auto convCheck = [&](const char* name, bool boolean, size_t budget) {
+        checks.push_back({name, [=](const FuzzCase& c, Timing& tm) {
+            vector<int> a(c.u + 1, 0);
+            for (int i = 1; i <= c.n; i++) a[c.w[i]] += 1;  // multiplicities, not just the indicator
+            vector<int> want = timed(tm.reference, [&] { return schoolbookConvolution(a, c.b); });
+            if (boolean) {
+                for (int& x : a) x = x > 0;
+                for (int& x : want) x = x > 0;
+            }
+            BudgetOverride limit(budget);
+            vector<int> got = timed(tm.fast, [&] { return boolean ? boolCnv(a, c.b) : convolution(a, c.b); });
+            return compareValues(vector<ll>(got.begin(), got.end()), vector<ll>(want.begin(), want.end()));
+        }});
+    };
+    convCheck("conv.fft", false, memoryBudget());
+    convCheck("conv.fft.chunked", false, 1);
+    convCheck("conv.bool", true, memoryBudget());
+    return checks;
+}
+
+// ---------------------------------------------------------------- generation
+
+struct Limits {
+    int maxN = 100;
+    int maxU = 600;
+    int maxT = 20000;
+};
+
+static const char* SHAPES[] = {"random", "distinct", "dense", "duplicates", "gcd", "heavy",
+                               "dominated", "ties", "bigprofit", "negative", "single"};
+
+/// Case `index` of the run with seed `seed`.
+static FuzzCase generateCase(unsigned seed, int index, const Limits& lim) {
+    mt19937 rng(seed * 1000003u + (unsigned)index);
+    auto uniform = [&](int lo, int hi) { return uniform_int_distribution<int>(lo, max(lo, hi))(rng); };
+    FuzzCase c;
+    c.seed = rng();
+    c.shape = SHAPES[uniform(0, (int)size(SHAPES) - 1)];
+
+    // mostly small cases (cheap, and where the corners are), some medium ones, one in ten at the limits
+    int sizeClass = uniform(0, 9);
+    int maxU = sizeClass < 6 ? 12 : sizeClass < 9 ? 200 : lim.maxU;
+    int maxN = sizeClass < 6 ? 6 : sizeClass < 9 ? 60 : lim.maxN;
+    int maxT = sizeClass < 6 ? 60 : sizeClass < 9 ? 3000 : lim.maxT;
+    c.large = sizeClass == 9;
+    int u = c.large ? uniform(max(1, lim.maxU / 2), lim.maxU) : uniform(1, maxU);
+    int n = c.shape == "single" ? 1 : c.large ? uniform(max(1, maxN / 2), maxN) : uniform(1, maxN);
+
+    vector<int> w, p;
+    auto profit = [&](int wt) {
+        if (c.shape == "ties") return wt * 3;
+        if (c.shape == "bigprofit") return uniform(1, 1000000);
+        if (c.shape == "negative") return uniform(-50, 50);
+        return uniform(1, 100);
+    };
+    if (c.shape == "dense" || c.shape == "distinct") {
+        vector<int> pool(u);
+        iota(pool.begin(), pool.end(), 1);
+        if (c.shape == "distinct") shuffle(pool.begin(), pool.end(), rng);
+        w.assign(pool.begin(), pool.begin() + min(n, u));
+    } else if (c.shape == "duplicates") {
+        vector<int> few(uniform(1, 3));
+        for (int& x : few) x = uniform(1, u);
+        for (int i = 0; i < n; i++) w.push_back(few[uniform(0, (int)few.size() - 1)]);
+    } else if (c.shape == "gcd") {
+        int g = uniform(2, 7);
+        for (int i = 0; i < n; i++) w.push_back(g * uniform(1, max(1, u / g)));
+    } else if (c.shape == "heavy") {
+        for (int i = 0; i < n; i++) w.push_back(uniform(u - u / 8, u));
+    } else if (c.shape == "dominated") {
+        // a few base coins and multiples of them that are worth less than the copies they replace
+        int bases = max(1, n / 4);
+        for (int i = 0; i < bases; i++) w.push_back(uniform(1, max(1, u / 4)));
+        for (int i = bases; i < n; i++) w.push_back(min(u, w[uniform(0, bases - 1)] * uniform(1, 4)));
+    } else {
+        for (int i = 0; i < n; i++) w.push_back(uniform(1, u));
+    }
+    for (int wt : w) p.push_back(profit(wt));
+    if (c.shape == "dominated") {
+        for (size_t i = 0; i < w.size(); i++) p[i] = w[i] * 2 - (i >= w.size() / 4 ? uniform(0, 3) : 0);
+    }
+
+    c.n = (int)w.size();
+    c.w.assign(1, 0);
+    c.p.assign(1, 0);
+    c.cap.assign(1, 0);
+    c.w.insert(c.w.end(), w.begin(), w.end());
+    c.p.insert(c.p.end(), p.begin(), p.end());
+    for (int i = 1; i <= c.n; i++) c.cap.push_back(uniform(-1, 4));
+    c.u = *max_element(c.w.begin() + 1, c.w.end());
+    c.order.resize(c.n + 1);
+    iota(c.order.begin(), c.order.end(), 0);
+    if (uniform(0, 1)) shuffle(c.order.begin() + 1, c.order.end(), rng);
+
+    switch (uniform(0, 7)) {
+        case 0: c.t = 0; break;
+        case 1: c.t = uniform(0, c.u); break;
+        default: c.t = uniform(0, maxT);
+    }
+
+    // b no longer than the coin indicator, which the peeling check needs
+    double density = vector<double>{0.05, 0.3, 0.9}[uniform(0, 2)];
+    c.b.resize(uniform(1, c.u + 1));
+    bernoulli_distribution bit(density);
+    for (int& x : c.b) x = bit(rng);
+    return c;
+}
+
+// ---------------------------------------------------------------- minimization
+
+static void removeCoins(FuzzCase& c, int from, int count) {
+    for (int i = from + count - 1; i >= from; i--) {
+        c.w.erase(c.w.begin() + i);
+        c.p.erase(c.p.begin() + i);
+        c.cap.erase(c.cap.begin() + i);
+        c.order.erase(find(c.order.begin() + 1, c.order.end(), i));
+        for (int x = 1; x < (int)c.order.size(); x++)
+            if (c.order[x] > i) c.order[x]--;
+    }
+    c.n -= count;
+}
+
+/// Keeps u the maximum weight and b no longer than the coin indicator.
+static void normalize(FuzzCase& c) {
+    c.u = *max_element(c.w.begin() + 1, c.w.end());
+    if ((int)c.b.size() > c.u + 1) c.b.resize(c.u + 1);
+}
+
+/// Calls `tryCase` on smaller variants of `c`, most aggressive first; stops at the first it accepts.
+static bool shrinkOnce(const FuzzCase& c, const function<bool(const FuzzCase&)>& tryCase) {
+    auto attempt = [&](FuzzCase next) {
+        normalize(next);
+        return tryCase(next);
+    };
+    for (int chunk = c.n / 2; chunk >= 1; chunk /= 2) {
+        for (int from = 1; from + chunk <= c.n + 1; from += chunk) {
+            FuzzCase next = c;
+            removeCoins(next, from, chunk);
+            if (next.n >= 1 && attempt(next)) return true;
+        }
+    }
+    for (int t : {0, c.t / 2, c.t - 1}) {
+        if (t < 0 || t >= c.t) continue;
+        FuzzCase next = c;
+        next.t = t;
+        if (attempt(next)) return true;
+    }
+    for (int len : {(int)c.b.size() / 2, (int)c.b.size() - 1}) {
+        if (len < 1 || len >= (int)c.b.size()) continue;
+        FuzzCase next = c;
+        next.b.resize(len);
+        if (attempt(next)) return true;
+    }
+    for (size_t j = 0; j < c.b.size(); j++) {
+        if (!c.b[j]) continue;
+        FuzzCase next = c;
+        next.b[j] = 0;
+        if (attempt(next)) return true;
+    }
+    for (int i = 1; i <= c.n; i++) {
+        for (int wt : {c.w[i] / 2, c.w[i] - 1}) {
+            if (wt < 1 || wt >= c.w[i]) continue;
+            FuzzCase next = c;
+            next.w[i] = wt;
+            if (attempt(next)) return true;
+        }
+        for (int pr : {0, 1, c.p[i] / 2}) {
+            if (pr == c.p[i] || abs(pr) > abs(c.p[i])) continue;
+            FuzzCase next = c;
+            next.p[i] = pr;
+            if (attempt(next)) return true;
+        }
+        if (c.cap[i] != -1 && c.cap[i] != 0) {
+            FuzzCase next = c;
+            next.cap[i] = c.cap[i] - 1;
+            if (attempt(next)) return true;
+        }
+    }
+    if (!is_sorted(c.order.begin(), c.order.end())) {
+        FuzzCase next = c;
+        iota(next.order.begin(), next.order.end(), 0);
+        if (attempt(next)) return true;
+    }
+    return false;
+}
+
+/// Shrinks `c` while the check keeps failing; `message` is updated to the failure of the smallest case.
+static FuzzCase minimize(const FuzzCase& c, const Check& check, string& message, int& runs) {
+    FuzzCase cur = c;
+    runs = 0;
+    auto fails = [&](const FuzzCase& next) {
+        if (runs >= MINIMIZE_RUNS) return false;
+        runs++;
+        Timing tm;
+        string err = check.run(next, tm);
+        if (err.empty()) return false;
+        cur = next;
+        message = err;
+        return true;
+    };
+    while (runs < MINIMIZE_RUNS && shrinkOnce(cur, fails)) {}
+    return cur;
+}
+
+// ---------------------------------------------------------------- case files
+
+/// "n u t seed", then n lines "w p cap", then σ[1..n], then |b| and b as a 0/1 string.
+static void writeCase(ostream& out, const FuzzCase& c) {
+    out << c.n << " " << c.u << " " << c.t << " " << c.seed << "\n";
+    for (int i = 1; i <= c.n; i++) out << c.w[i] << " " << c.p[i] << " " << c.cap[i] << "\n";
+    for (int i = 1; i <= c.n; i++) out << c.order[i] << (i < c.n ? " " : "\n");
+    out << c.b.size() << " ";
+    for (int x : c.b) out << x;
+    out << "\n";
+}
+
+static bool readCase(istream& in, FuzzCase& c) {
+    if (!(in >> c.n >> c.u >> c.t >> c.seed) || c.n < 1) return false;
+    c.w.assign(c.n + 1, 0);
+    c.p.assign(c.n + 1, 0);
+    c.cap.assign(c.n + 1, 0);
+    c.order.assign(c.n + 1, 0);
+    for (int i = 1; i <= c.n; i++) in >> c.w[i] >> c.p[i] >> c.cap[i];
+    for (int i = 1; i <= c.n; i++) in >> c.order[i];
+    size_t len;
+    string bits;
+    if (!(in >> len >> bits) || bits.size() != len) return false;
+    c.b.clear();
+    for (char ch : bits) c.b.push_back(ch == '1');
+    c.shape = "replay";
+    return true;
+}
+
+// ---------------------------------------------------------------- fixed regressions
+
+/// Best profit of exactly `t` with unlimited copies of two coins, by enumerating the copies of the first.
+static ll twoCoinKnapsack(ll w1, ll p1, ll w2, ll p2, ll t) {
+    ll best = NEG_INF;
+    for (ll a = 0; a * w1 <= t; a++) {
+        if ((t - a * w1) % w2 == 0) best = max(best, a * p1 + (t - a * w1) / w2 * p2);
+    }
+    return best;
+}
+
+/**
+ * Instances the generated cases never reach: a best-ratio coin w_b with w_b·u far beyond INT_MAX and targets
+ * in the billions, where the references enumerate the copies of one coin, and a witness round large enough
+ * for the sampled hitting set. Returns the number of failures; `ran` counts the regressions that match the
+ * filter.
+ */
+static int runRegressions(const string& filter, int& ran) {
+    struct Regression {
+        const char* name;
+        function<string()> run;
+    };
+    auto twoCoins = [](int w1, int w2) {
+        vector<int> w = {0, w1, w2}, p = {0, 1, 1}, order = {0, 1, 2};
+        return CoinSet(2, max(w1, w2), w, p, order);
+    };
+    vector<Regression> cases = {
+        // gcd 10000 of the weights: the threshold is 5·70000 + 1, so targets in the billions are answered
+        {"regression.large_period.gcd", [&] {
+            CoinSet cs = twoCoins(60000, 70000);
+            vector<ll> targets = {5000000000LL, 5000000000LL + 10000, 1234567890000LL, 410000};
+            if (!TargetQuery::answerable(cs, targets)) return string("targets rejected");
+            TargetQuery q(cs);
+            vector<ll> got = q.values(targets), want;
+            for (ll t : targets) want.push_back(twoCoinKnapsack(60000, 1, 70000, 1, t));
+            return compareValues(got, want);
+        }},
+        // coprime weights: the base would be about 4.2·10^9 targets, so only targets below the limit are answered
+        {"regression.large_period.coprime", [&] {
+            CoinSet cs = twoCoins(60000, 69999);
+            if (TargetQuery::answerable(cs, {5000000000LL})) return string("a target of 5e9 was accepted");
+            PeriodicKnapsack pk;
+            if (buildPeriodicKnapsack(cs, pk)) return string("built a base of ") + to_string(periodicBaseSize(cs));
+            vector<ll> targets = {0, 60000, 129999, 4000000, 4199940};
+            if (!TargetQuery::answerable(cs, targets)) return string("small targets rejected");
+            TargetQuery q(cs);
+            vector<ll> got = q.values(targets), want;
+            for (ll t : targets) want.push_back(twoCoinKnapsack(60000, 1, 69999, 1, t));
+            return compareValues(got, want);
+        }},
+        // w_b = 1, p_b = 1000: 10^17 is worth 10^20, past 64 bits, so the value saturates instead of wrapping;
+        // 9·10^15 is worth 9·10^18, still exact
+        {"regression.large_period.overflow", [&] {
+            vector<int> w = {0, 1, 3}, p = {0, 1000, 1}, order = {0, 1, 2};
+            CoinSet cs(2, 3, w, p, order);
+            vector<ll> targets = {100000000000000000LL, 9000000000000000LL, LLONG_MAX};
+            vector<ll> want = {LLONG_MAX, 9000000000000000000LL, LLONG_MAX};
+            if (!TargetQuery::answerable(cs, targets)) return string("targets rejected");
+            PeriodicKnapsack pk;
+            if (!buildPeriodicKnapsack(cs, pk)) return string("base rejected");
+            vector<ll> got;
+            for (ll t : targets) got.push_back(pk.value(t));
+            string err = compareValues(got, want);
+            if (!err.empty()) return "periodic: " + err;
+            TargetQuery q(cs);
+            err = compareValues(q.values(targets), want);
+            return err.empty() ? err : "query: " + err;
+        }},
+        // a typical witness round: 40000 sets of k = 32 candidates out of |S| = 4000 of n = 20000 coins, limit
+        // |S|/2; the sample must come from the candidates and be accepted, not fall back to the greedy
+        {"regression.hitting_set.sampled", [&] {
+            const int n = 20000, candidates = 4000, k = 32, sets = 40000;
+            mt19937 rng(12345);
+            vector<int> pool(n);
+            for (int e = 0; e < n; e++) pool[e] = e + 1;
+            shuffle(pool.begin(), pool.end(), rng);
+            pool.resize(candidates);
+            SetSystem big;
+            vector<int> set;
+            for (int s = 0; s < sets; s++) {
+                set.clear();
+                for (int i = 0; i < k; i++) set.push_back(pool[rng() % candidates]);
+                sort(set.begin(), set.end());
+                set.erase(unique(set.begin(), set.end()), set.end());
+                if ((int)set.size() < k) { s--; continue; }
+                big.addSet(set);
+            }
+            unsigned long long rejected = instrumentHits("hitting_set.sample_rejected");
+            unsigned long long skipped = instrumentHits("hitting_set.sample_skipped");
+            vector<int> H = computeHittingSet_randomized(big, k, n, candidates / 2, 7);
+            vector<char> inH(n + 1, 0);
+            for (int e : H) inH[e] = 1;
+            for (int s = 0; s < big.size(); s++) {
+                bool hit = false;
+                for (int i = big.start[s]; i < big.start[s + 1]; i++) hit |= inH[big.elems[i]];
+                if (!hit) return "set " + to_string(s) + " is not hit";
+            }
+            if ((int)H.size() > candidates / 2) return "|H| = " + to_string(H.size()) + " above the limit";
+            if (instrumentHits("hitting_set.sample_rejected") != rejected) return string("sample rejected");
+            if (instrumentHits("hitting_set.sample_skipped") != skipped) return string("sampling skipped");
+            return string();
+        }},
+    };
+    int failures = 0;
+    ran = 0;
+    for (const Regression& r : cases) {
+        if (!filter.empty() && string(r.name).find(filter) == string::npos) continue;
+        ran++;
+        string err = r.run();
+        cout << (err.empty() ? "ok   " : "FAIL ") << r.name << (err.empty() ? "" : ": " + err) << "\n";
+        failures += !err.empty();
+    }
+    return failures;
+}
+
+static string describe(const FuzzCase& c) {
+    ostringstream s;
+    s << "n=" << c.n << " u=" << c.u << " t=" << c.t << " |b|=" << c.b.size() << " shape " << c.shape;
+    return s.str();
+}
+
+// ---------------------------------------------------------------- driver
+
+struct CheckStats {
+    int cases = 0;
+    int failures = 0;
+    double fast = 0, reference = 0;
+    double fastLarge = 0, referenceLarge = 0;
+};
+
+struct Failure {
+    string check;
+    int index;
+    string message;
+    FuzzCase minimized;
+    string file;
+};
+
+static string speedup(double reference, double fast) {
+    if (fast <= 0 || reference <= 0) return "-";
+    ostringstream s;
+    s << fixed << setprecision(2) << reference / fast << "x";
+    return s.str();
+}
+
+static void writeJson(const string& path, unsigned seed, int cases, const vector<Check>& checks,
+                      const vector<CheckStats>& stats, const vector<Failure>& failures) {
+    ofstream out(path);
+    out << "{\n  \"seed\": " << seed << ",\n  \"cases\": " << cases << ",\n  \"checks\": [";
+    for (size_t i = 0; i < checks.size(); i++) {
+        const CheckStats& s = stats[i];
+        out << (i ? "," : "") << "\n    {\"name\": \"" << checks[i].name << "\", \"cases\": " << s.cases
+            << ", \"failures\": " << s.failures << ", \"reference_seconds\": " << s.reference
+            << ", \"fast_seconds\": " << s.fast << ", \"reference_seconds_large\": " << s.referenceLarge
+            << ", \"fast_seconds_large\": " << s.fastLarge << "}";
+    }
+    out << "\n  ],\n  \"failures\": [";
+    for (size_t i = 0; i < failures.size(); i++) {
+        ostringstream msg;
+        for (char ch : failures[i].message) {
+            if (ch == '"' || ch == '\\') msg << '\\';
+            msg << ch;
+        }
+        out << (i ? "," : "") << "\n    {\"check\": \"" << failures[i].check << "\", \"case\": " << failures[i].index
+            << ", \"message\": \"" << msg.str() << "\", \"file\": \"" << failures[i].file << "\"}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    int iterations = 200, onlyCase = -1;
+    unsigned seed = 1;
+    double timeLimit = 0;
+    Limits lim;
+    string filter, outDir, jsonPath, replayPath;
+    bool list = false;
+    for (int a = 1; a < argc; a++) {
+        auto value = [&]() -> const char* {
+            if (a + 1 >= argc) {
+                cerr << argv[a] << " needs a value\n";
+                exit(2);
+            }
+            return argv[++a];
+        };
+        if (strcmp(argv[a], "--iterations") == 0) iterations = atoi(value());
+        else if (strcmp(argv[a], "--seed") == 0) seed = (unsigned)strtoul(value(), nullptr, 10);
+        else if (strcmp(argv[a], "--case") == 0) onlyCase = atoi(value());
+        else if (strcmp(argv[a], "--filter") == 0) filter = value();
+        else if (strcmp(argv[a], "--max-n") == 0) lim.maxN = max(1, atoi(value()));
+        else if (strcmp(argv[a], "--max-u") == 0) lim.maxU = max(1, atoi(value()));
+        else if (strcmp(argv[a], "--max-t") == 0) lim.maxT = max(0, atoi(value()));
+        else if (strcmp(argv[a], "--time-limit") == 0) timeLimit = atof(value());
+        else if (strcmp(argv[a], "--out") == 0) outDir = value();
+        else if (strcmp(argv[a], "--json") == 0) jsonPath = value();
+        else if (strcmp(argv[a], "--replay") == 0) replayPath = value();
+        else if (strcmp(argv[a], "--list") == 0) list = true;
+        else {
+            cerr << "unknown option " << argv[a] << "\n";
+            return 2;
+        }
+    }
+
+    vector<Check> checks;
+    for (Check& c : allChecks())
+        if (filter.empty() || string(c.name).find(filter) != string::npos) checks.push_back(move(c));
+    if (list) {
+        for (const Check& c : checks) cout << c.name << "\n";
+        return 0;
+    }
+    if (!replayPath.empty()) {
+        ifstream in(replayPath);
+        FuzzCase c;
+        if (!in || !readCase(in, c)) {
+            cerr << "cannot read case " << replayPath << "\n";
+            return 2;
+        }
+        normalize(c);
+        bool failed = false;
+        for (const Check& check : checks) {
+            Timing tm;
+            string err = check.run(c, tm);
+            cout << (err.empty() ? "ok   " : "FAIL ") << check.name << (err.empty() ? "" : ": " + err) << "\n";
+            failed |= !err.empty();
+        }
+        return failed ? 1 : 0;
+    }
+
+    int ran, regressionFailures = runRegressions(filter, ran);
+    if (checks.empty()) {
+        if (ran == 0) cerr << "no check matches " << filter << "\n";
+        return ran == 0 ? 2 : regressionFailures > 0;
+    }
+
+    vector<CheckStats> stats(checks.size());
+    vector<Failure> failures;
+    auto start = chrono::steady_clock::now();
+    int cases = 0;
+    for (int index = 0; index < iterations; index++) {
+        if (onlyCase >= 0 && index != onlyCase) continue;
+        if (timeLimit > 0 && chrono::duration<double>(chrono::steady_clock::now() - start).count() > timeLimit) break;
+        FuzzCase c = generateCase(seed, index, lim);
+        cases++;
+        for (size_t i = 0; i < checks.size(); i++) {
+            Timing tm;
+            string err = checks[i].run(c, tm);
+            CheckStats& s = stats[i];
+            s.cases++;
+            s.fast += tm.fast;
+            s.reference += tm.reference;
+            if (c.large) {
+                s.fastLarge += tm.fast;
+                s.referenceLarge += tm.reference;
+            }
+            if (err.empty()) continue;
+            s.failures++;
+            cout << "FAIL " << checks[i].name << " on case " << index << " (" << describe(c) << "): " << err << "\n";
+            if (s.failures > 1) continue;  // the first failure of a check is minimized, the others only counted
+
+            Failure f{checks[i].name, index, err, c, ""};
+            int runs;
+            f.minimized = minimize(c, checks[i], f.message, runs);
+            cout << "  minimized in " << runs << " runs to " << describe(f.minimized) << ": " << f.message << "\n";
+            writeCase(cout, f.minimized);
+            if (!outDir.empty()) {
+                f.file = outDir + "/" + checks[i].name + "-" + to_string(seed) + "-" + to_string(index) + ".case";
+                ofstream out(f.file);
+                writeCase(out, f.minimized);
+                if (!out) cerr << "cannot write " << f.file << "\n";
+                else cout << "  written to " << f.file << "\n";
+            }
+            failures.push_back(move(f));
+        }
+    }
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "\n" << cases << " cases (seed " << seed << ") in " << fixed << setprecision(1) << elapsed << " s\n";
+    cout << left << setw(30) << "check" << right << setw(7) << "cases" << setw(7) << "fail" << setw(11) << "ref s"
+         << setw(11) << "fast s" << setw(10) << "speedup" << setw(10) << "large" << "\n";
+    for (size_t i = 0; i < checks.size(); i++) {
+        const CheckStats& s = stats[i];
+        cout << left << setw(30) << checks[i].name << right << setw(7) << s.cases << setw(7) << s.failures
+             << setprecision(3) << setw(11) << s.reference << setw(11) << s.fast
+             << setw(10) << speedup(s.reference, s.fast) << setw(10) << speedup(s.referenceLarge, s.fastLarge) << "\n";
+    }
+    if (!jsonPath.empty()) writeJson(jsonPath, seed, cases, checks, stats, failures);
+    return failures.empty() && regressionFailures == 0 ? 0 : 1;
+}
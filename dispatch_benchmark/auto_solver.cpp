@@ -0,0 +1,67 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include "dispatch.h"
+using namespace std;
+
+// usage: auto_solver [--coinchange] [--strategy classical|kernel|simple|randomized|adaptive|smallu] [--profile FILE]
+//                    [--memory-budget SIZE] < instance
+int main(int argc, char** argv){
+    Problem problem = Problem::Knapsack;
+    string forced, profilePath;
+    for(int a = 1; a < argc; a++){
+        if(strcmp(argv[a], "--coinchange") == 0) problem = Problem::CoinChange;
+        else if(strcmp(argv[a], "--strategy") == 0 && a + 1 < argc) forced = argv[++a];
+        else if(strcmp(argv[a], "--profile") == 0 && a + 1 < argc) profilePath = argv[++a];
+        else if(strcmp(argv[a], "--memory-budget") == 0 && a + 1 < argc){
+            size_t budget;
+            if(!parseByteSize(argv[++a], budget)){
+                cerr << "cannot parse the memory budget " << argv[a] << "\n";
+                return 1;
+            }
+            setMemoryBudget(budget);
+        }
+    }
+
+    int n, u, t;
+    if(!(cin >> n >> u >> t)) return 0;
+    vector<int> w(n+1), p(n+1);
+    for(int i = 1; i <= n; i++){
+        cin >> w[i] >> p[i];
+    }
+
+    CostProfile profile = defaultCostProfile();
+    if(!profilePath.empty() && !profile.load(profilePath)){
+        cerr << "cannot read profile " << profilePath << "\n";
+        return 1;
+    }
+
+    Strategy forcedStrategy = Strategy::Classical;
+    if(!forced.empty()){
+        bool found = false;
+        for(Strategy c : {Strategy::Classical, Strategy::Kernel, Strategy::CoinChangeSimple,
+                          Strategy::CoinChangeRandomized, Strategy::CoinChangeAdaptive, Strategy::CoinChangeSmallU}){
+            if(forced == strategyName(c)){ forcedStrategy = c; found = true; }
+        }
+        if(!found){
+            cerr << "unknown strategy " << forced << "\n";
+            return 1;
+        }
+    }
+
+    auto t0 = chrono::high_resolution_clock::now();
+    SolveResult res = forced.empty() ? solve(problem, n, w, p, t, profile)
+                                     : solveWith(forcedStrategy, problem, n, w, p, t);
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Strategy: " << strategyName(res.strategy) << (res.streamed ? " (targets streamed)" : "") << "\n";
+    cerr << "Total elapsed time: " << chrono::duration<double>(t1 - t0).count() << " s\n";
+    memoryReport(cerr);
+
+    // knapsack: best profit or -1e9; coin change: min coins or -1
+    for(int c = 0; c <= t; c++){
+        cout << res.value[c] << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""
+Throughput of batch_solver on streams of many small instances: the batch scheduler (work units on the shared
+thread pool, results streamed in input order) against --sequential, which solves one instance after the other.
+Both must print the same lines. Set FASTKNAPSACK_THREADS to vary the pool size.
+"""
+import os
+import random
+import subprocess
+import tempfile
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+SOLVER = os.path.join(SCRIPT_DIR, "batch_solver")
+
+# (problem, instances, max n, max u, max T)
+CASES = [
+    ("knapsack",   20000,  20,  100,   2000),
+    ("knapsack",    5000,  50,  500,  20000),
+    ("knapsack",     200, 200, 2000, 500000),
+    ("coinchange", 20000,  20,  100,   2000),
+]
+
+def compile_solver():
+    deps = [os.path.join(SCRIPT_DIR, "..", "src", f) for f in
+            ("convolution.cpp", "arena.cpp", "memory_budget.cpp", "trace.cpp", "witness.cpp", "coin_set.cpp", "hitting_set.cpp", "dp_structs.cpp",
+             "algorithms.cpp", "thread_pool.cpp", "preprocess.cpp", "classical.cpp", "small_u.cpp", "dispatch.cpp",
+             "instance_io.cpp", "batch.cpp")]
+    subprocess.run([
+        "g++-14", "-std=c++20", "-O2",
+        "-I", os.path.join(SCRIPT_DIR, "..", "include"),
+        *deps,
+        os.path.join(SCRIPT_DIR, "batch_solver.cpp"),
+        "-pthread",
+        "-o", SOLVER
+    ], check=True)
+
+def write_stream(path, count, max_n, max_u, max_t):
+    with open(path, "w") as f:
+        for _ in range(count):
+            n = random.randint(1, max_n)
+            u = random.randint(1, max_u)
+            t = random.randint(0, max_t)
+            f.write(f"{n} {u} {t}\n")
+            f.writelines(f"{random.randint(1, u)} {random.randint(1, 1000)}\n" for _ in range(n))
+
+def run(problem, path, extra):
+    cmd = [SOLVER, "--input", path] + (["--coinchange"] if problem == "coinchange" else []) + extra
+    res = subprocess.run(cmd, capture_output=True, text=True, check=True)
+    rate = next(float(l.split("(")[1].split()[3]) for l in res.stderr.splitlines() if l.startswith("Solved"))
+    return res.stdout, rate
+
+def main():
+    compile_solver()
+    print(f"{'problem':>10} | {'count':>6} | {'sequential (inst/s)':>19} | {'batch (inst/s)':>14} | same")
+    print("-" * 68)
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "stream.txt")
+        for problem, count, max_n, max_u, max_t in CASES:
+            write_stream(path, count, max_n, max_u, max_t)
+            seq_out, seq_rate = run(problem, path, ["--sequential"])
+            batch_out, batch_rate = run(problem, path, [])
+            print(f"{problem:>10} | {count:6d} | {seq_rate:19.0f} | {batch_rate:14.0f} | {seq_out == batch_out}")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include "batch.h"
+using namespace std;
+
+// One line per instance: the values of every target 0..t, separated by spaces (an empty line if it was rejected).
+static void writeLine(ostream& out, const vector<ll>& values, vector<char>& buf){
+    buf.resize(21 * values.size() + 1);
+    char* at = buf.data();
+    for(size_t c = 0; c < values.size(); c++){
+        if(c > 0) *at++ = ' ';
+        at = to_chars(at, at + 20, values[c]).ptr;
+    }
+    *at++ = '\n';
+    out.write(buf.data(), at - buf.data());
+}
+
+// usage: batch_solver [--coinchange] [--profile FILE] [--input FILE] [--output FILE] [--window N] [--sequential]
+//   Solves every instance of the input (text instances on stdin or in FILE, or concatenated binary instances
+//   in FILE, see instance_io.h) with the strategy dispatch.h picks for it.
+//   Output: one line per instance on stdout, or one binary results record per instance in the --output FILE.
+//   --sequential solves the instances one after another without the batch scheduler (the baseline).
+int main(int argc, char** argv){
+    BatchOptions options;
+    string input, output, profilePath;
+    bool sequential = false;
+    for(int a = 1; a < argc; a++){
+        if(strcmp(argv[a], "--coinchange") == 0) options.problem = Problem::CoinChange;
+        else if(strcmp(argv[a], "--profile") == 0 && a + 1 < argc) profilePath = argv[++a];
+        else if(strcmp(argv[a], "--input") == 0 && a + 1 < argc) input = argv[++a];
+        else if(strcmp(argv[a], "--output") == 0 && a + 1 < argc) output = argv[++a];
+        else if(strcmp(argv[a], "--window") == 0 && a + 1 < argc) options.window = atoi(argv[++a]);
+        else if(strcmp(argv[a], "--sequential") == 0) sequential = true;
+        else {
+            cerr << "usage: " << argv[0] << " [--coinchange] [--profile FILE] [--input FILE] [--output FILE]"
+                 << " [--window N] [--sequential]\n";
+            return 2;
+        }
+    }
+    ios::sync_with_stdio(false);
+
+    CostProfile profile = defaultCostProfile();
+    if(!profilePath.empty() && !profile.load(profilePath)){
+        cerr << "cannot read profile " << profilePath << "\n";
+        return 1;
+    }
+    options.profile = &profile;
+
+    InstanceStream in;
+    if(!in.open(input)){
+        cerr << "cannot read the instances " << input << "\n";
+        return 1;
+    }
+    ofstream file;
+    if(!output.empty()){
+        file.open(output, ios::binary);
+        if(!file){
+            cerr << "cannot write the results to " << output << "\n";
+            return 1;
+        }
+    }
+
+    vector<ll> strategies(6, 0);
+    vector<char> buf;
+    auto emit = [&](ll, const SolveResult& res){
+        strategies[(int)res.strategy]++;
+        if(output.empty()) writeLine(cout, res.value, buf);
+        else appendBinaryResults(file, res.value);
+    };
+    auto next = [&](Instance& inst){ return in.next(inst); };
+
+    auto t0 = chrono::high_resolution_clock::now();
+    BatchStats stats;
+    if(sequential){
+        Instance inst;
+        while(next(inst)){
+            bool ok = inst.t >= 0 && inst.t <= INT_MAX - 1
+                      && all_of(inst.w.begin() + 1, inst.w.end(), [](int x){ return x >= 1; });
+            emit(stats.instances++, ok ? solve(options.problem, inst.n, inst.w, inst.p, (int)inst.t, profile)
+                                       : SolveResult{Strategy::Classical, {}});
+            stats.units++;
+        }
+    } else {
+        stats = solveBatch(next, emit, options);
+    }
+    cout.flush();
+    auto t1 = chrono::high_resolution_clock::now();
+    double secs = chrono::duration<double>(t1 - t0).count();
+
+    if(in.failed()) cerr << "malformed instance after " << stats.instances << " instances\n";
+    cerr << "Solved " << stats.instances << " instances in " << secs << " s (" << stats.units << " work units, "
+         << stats.instances / max(secs, 1e-9) << " instances/s)\n";
+    cerr << "Strategies:";
+    for(int s = 0; s < 6; s++){
+        if(strategies[s] > 0) cerr << " " << strategyName((Strategy)s) << " " << strategies[s];
+    }
+    cerr << "\n";
+    if(!output.empty() && !file.flush()){
+        cerr << "cannot write the results to " << output << "\n";
+        return 1;
+    }
+    return in.failed() ? 1 : 0;
+}
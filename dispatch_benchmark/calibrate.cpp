@@ -0,0 +1,27 @@
+#include <iostream>
+#include <chrono>
+#include "dispatch.h"
+using namespace std;
+
+// usage: calibrate [FILE] — measures the cost model constants of this host and writes them to FILE
+// (default fastknapsack.profile); point FASTKNAPSACK_PROFILE at it to use them.
+int main(int argc, char** argv){
+    string path = argc > 1 ? argv[1] : "fastknapsack.profile";
+    auto t0 = chrono::high_resolution_clock::now();
+    CostProfile cp = calibrateCostProfile();
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Calibration took " << chrono::duration<double>(t1 - t0).count() << " s\n";
+    if(!cp.save(path)){
+        cerr << "cannot write " << path << "\n";
+        return 1;
+    }
+    cout << "classical   " << cp.classical << "\n"
+         << "propagation " << cp.propagation << "\n"
+         << "kernel      " << cp.kernel << "\n"
+         << "simple      " << cp.simple << "\n"
+         << "randomized  " << cp.randomized << "\n"
+         << "adaptive    " << cp.adaptive << "\n"
+         << "smallu      " << cp.smallU << "\n"
+         << "written to " << path << "\n";
+    return 0;
+}
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+import os
+import subprocess
+import random
+
+# --- directory setup -----------------------------------------
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+SOLVER     = os.path.join(SCRIPT_DIR, "auto_solver")
+CALIBRATE  = os.path.join(SCRIPT_DIR, "calibrate")
+PROFILE    = os.path.join(SCRIPT_DIR, "fastknapsack.profile")
+# --------------------------------------------------------------
+
+# (problem, n, u, T): weights are drawn from (u/2, u] so that no coin dominates another
+CASES = [
+    ("knapsack",   200,  400,  500000),
+    ("knapsack",   500, 1000, 3000000),
+    ("knapsack",  3000, 2000, 4000000),
+    ("coinchange", 100, 1000, 1000000),
+    ("coinchange", 500,  200, 2000000),
+    ("coinchange",  30,   64, 4000000),
+]
+STRATEGIES = {
+    "knapsack":   ["classical", "kernel"],
+    "coinchange": ["classical", "simple", "randomized", "adaptive", "smallu"],
+}
+
+def compile_tools():
+    deps = [os.path.join(SCRIPT_DIR, "..", "src", f) for f in
+            ("convolution.cpp", "arena.cpp", "memory_budget.cpp", "trace.cpp", "witness.cpp", "coin_set.cpp", "hitting_set.cpp", "dp_structs.cpp",
+             "algorithms.cpp", "thread_pool.cpp", "preprocess.cpp", "classical.cpp", "small_u.cpp", "dispatch.cpp")]
+    for tool, out in (("auto_solver.cpp", SOLVER), ("calibrate.cpp", CALIBRATE)):
+        subprocess.run([
+            "g++-14", "-std=c++20", "-O2",
+            "-I", os.path.join(SCRIPT_DIR, "..", "include"),
+            *deps,
+            os.path.join(SCRIPT_DIR, tool),
+            "-pthread",
+            "-o", out
+        ], check=True)
+
+def build_input(n, u, T):
+    lines = [f"{n} {u} {T}\n"]
+    for _ in range(n):
+        lines.append(f"{random.randint(u // 2 + 1, u)} {random.randint(1, 1000)}\n")
+    return "".join(lines)
+
+def parse(stderr: str):
+    strategy, secs = None, None
+    for line in stderr.splitlines():
+        if line.startswith("Strategy:"):
+            strategy = line.split()[1]
+        if line.startswith("Total elapsed time:"):
+            secs = float(line.split()[3])
+    return strategy, secs
+
+def run(problem, args, inp):
+    cmd = [SOLVER, "--profile", PROFILE] + (["--coinchange"] if problem == "coinchange" else []) + args
+    res = subprocess.run(cmd, input=inp, text=True, capture_output=True, check=True)
+    return res.stdout, parse(res.stderr)
+
+def run_benchmark():
+    subprocess.run([CALIBRATE, PROFILE], check=True)
+    print("  problem     n     u        T  | auto choice     time(s) | fastest         time(s) | OK?")
+    print("--------------------------------+-------------------------+-------------------------+----")
+    for problem, n, u, T in CASES:
+        inp = build_input(n, u, T)
+        out, (choice, t_auto) = run(problem, [], inp)
+        ok, best = True, None
+        for s in STRATEGIES[problem]:
+            forced_out, (_, secs) = run(problem, ["--strategy", s], inp)
+            ok = ok and forced_out == out
+            if best is None or secs < best[1]:
+                best = (s, secs)
+        print(f"{problem:>10} {n:5d} {u:5d} {T:8d} | {choice:<12} {t_auto:9.4f} | {best[0]:<12} {best[1]:9.4f} | {'Y' if ok else 'N'}")
+
+if __name__ == "__main__":
+    random.seed(0)
+    compile_tools()
+    run_benchmark()
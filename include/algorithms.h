@@ -7,6 +7,8 @@
 #include "dp_structs.h"
 #include "witness.h"
 #include "hitting_set.h"
+#include "coin_set.h"
+#include <functional>
 
 // Algorithm 1: Witness Propagation
 void propagation(
@@ -16,8 +18,20 @@ void propagation(
     vector<solution>& sol, 
     const vector<int>& order
 );
+void propagation(const CoinSet& cs, int t, vector<solution>& sol);
+void propagation(const CoinSet& cs, int from, int t, vector<solution>& sol); // resumes on (from, t]
+
+/**
+ * Algorithm 1 over a window of u + 1 solutions instead of the table [0..t]: sol[j] is final once the targets
+ * below j have been propagated and is only read by its own step, so it goes to emit(j, sol[j]) and its slot
+ * takes target j + u + 1. `kernel` is the output of a kernel computation (any length, e.g. with t = 0) and is
+ * consumed. Same solutions as propagation(), in O(k·u + u) solutions of memory.
+ */
+void propagationStreamed(const CoinSet& cs, int t, vector<solution>& kernel, const function<void(int, const solution&)>& emit);
 
 // Algorithm 2: Kernel Computation
+// The CoinSet overloads reuse the tables of `cs`; the others build a CoinSet for the call.
+// Variants that adapt the lex order write it back into `cs` (resp. `order`).
 void kernelComputation_knapsack(
     int n, int u,
     const vector<int>& w,
@@ -26,6 +40,7 @@ void kernelComputation_knapsack(
     int t,
     vector<solution>& sol
 );
+void kernelComputation_knapsack(const CoinSet& cs, int t, vector<solution>& sol);
 
 void kernelComputation_coinchange_simple(
     int n, int u,
@@ -35,6 +50,7 @@ void kernelComputation_coinchange_simple(
     int t,
     vector<solution>& sol
 );
+void kernelComputation_coinchange_simple(const CoinSet& cs, int t, vector<solution>& sol);
 
 void kernelComputation_coinchange_randomized(
     int n,                              // number of coins
@@ -45,6 +61,7 @@ void kernelComputation_coinchange_randomized(
     int t,                          // (unused) global target bound
     vector<solution>& sol              // output: sol[c] for c∈[0..k·u]
 );
+void kernelComputation_coinchange_randomized(CoinSet& cs, int t, vector<solution>& sol);
 
 void kernelComputation_coinchange(
     int n, int u,
@@ -54,6 +71,25 @@ void kernelComputation_coinchange(
     int t,
     vector<solution>& sol
 );
+void kernelComputation_coinchange(CoinSet& cs, int t, vector<solution>& sol);
+
+// Residue Table: kernel with the "value = sum" objective, then res[r] = lex-minimum multiset of the smallest
+// reachable sum ≡ r (mod smallest weight), for every residue r
+void kernelComputation_residue(const CoinSet& cs, vector<solution>& sol);
+void residueTable(const CoinSet& cs, vector<solution>& res);
+void residueTable(
+    int n, int u,
+    const vector<int>& w,
+    const vector<int>& order,
+    vector<solution>& res
+);
+
+// All-Target Counting: number of coin multisets of every sum in [0..t], modulo NTT_MOD (t < NTT_MOD).
+// countCoinChange() picks the cheaper of the O(n·t) DP and the O(t log t) power series exp.
+vector<ll> countCoinChange(const CoinSet& cs, int t);
+vector<ll> countCoinChangeDP(const CoinSet& cs, int t);
+vector<ll> countCoinChangeExp(const CoinSet& cs, int t);
+vector<ll> countCoinChange(int n, const vector<int>& w, int t);
 
 // Algorithm 4: Adaptive Minimum Witness
 void adaptiveMinWitness(
@@ -67,8 +103,25 @@ vector<vector<int>> adaptiveMinWitness_randomized(
     vector<vector<int>>& a,
     vector<vector<int>>& b,
     vector<vector<int>>& c,
-    vector<int>& w,
+    const vector<int>& w,
     vector<int>& order
 );
 
+// Same, with all randomness derived from `seed` (independent of the number of threads)
+vector<vector<int>> adaptiveMinWitness_randomized(
+    vector<vector<int>>& a,
+    vector<vector<int>>& b,
+    vector<vector<int>>& c,
+    const vector<int>& w,
+    vector<int>& order,
+    unsigned seed
+);
+vector<vector<int>> adaptiveMinWitness_randomized(
+    vector<vector<int>>& a,
+    vector<vector<int>>& b,
+    vector<vector<int>>& c,
+    CoinSet& cs,
+    unsigned seed
+);
+
 #endif
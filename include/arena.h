@@ -0,0 +1,130 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "constants.h"
+#include "memory_budget.h"
+#include <atomic>
+#include <memory_resource>
+
+/**
+ * Per-thread scratch arenas for the temporaries of the kernel, witness, peeling and convolution code.
+ *
+ * Every thread owns one ScratchArena, a bump allocator behind the std::pmr interface. Scratch containers
+ * (pmr::vector, pmr::unordered_set, ...) are created inside an ArenaScope and take their memory from the
+ * arena top; deallocation is a no-op and the scope hands everything back at once when it ends. Scopes nest
+ * like the calls that open them, which also holds for pool tasks a waiting thread runs inside parallelFor().
+ *
+ * The arena starts empty and grows by blocks. When the outermost scope of a thread ends after the arena had
+ * to grow, its blocks are replaced by a single block of the peak size, so the first iteration sizes the arena
+ * and every later iteration of the same shape runs without malloc/free. Containers must not outlive their
+ * scope; results that are returned keep using std::vector.
+ *
+ * A scope opened with a MemSubsystem charges what is allocated while it is the innermost scope to that
+ * subsystem (memory_budget.h) until it ends; a scope without one charges the subsystem of the enclosing scope.
+ * The charge is taken in refills of at least 64 KiB rather than per allocation, so the shared counters see one
+ * update per refill and a scope overstates its usage by less than one refill.
+ */
+class ScratchArena : public pmr::memory_resource {
+public:
+    ScratchArena();
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    struct Mark {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+
+    Mark mark() const { return {current, offset, used}; }
+
+    /// Frees everything allocated since `m`; at depth 0 consolidates the blocks into one of the peak size.
+    void release(const Mark& m);
+
+    size_t peakBytes() const { return peak.load(memory_order_relaxed); }
+    size_t capacityBytes() const { return capacity.load(memory_order_relaxed); }
+    ll blockAllocations() const { return mallocs.load(memory_order_relaxed); }
+    ll allocations() const { return requests.load(memory_order_relaxed); }
+
+private:
+    friend class ArenaScope;
+
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    vector<Block> blocks;
+    size_t current;      ///< block the next allocation is tried in
+    size_t offset;       ///< first free byte of blocks[current]
+    size_t used;         ///< bytes handed out and not yet released, including padding and skipped block tails
+    int depth;           ///< open scopes
+    int subsystem;       ///< MemSubsystem charged by the innermost scope, -1 if none
+    size_t charged;      ///< bytes the innermost scope charged to its subsystem so far, in refills
+    size_t credit;       ///< charged bytes the innermost scope has not handed out yet
+
+    // written only by the owning thread, read by arenaStats() from other threads
+    atomic<size_t> peak;
+    atomic<size_t> capacity;
+    atomic<ll> mallocs;
+    atomic<ll> requests;
+};
+
+/// The arena of the calling thread; created on first use and kept until exit.
+ScratchArena& threadArena();
+
+/// Opens a scope on the thread's arena; everything allocated through it is released by the destructor.
+class ArenaScope {
+public:
+    ArenaScope() : ArenaScope(threadArena().subsystem) {}
+    explicit ArenaScope(MemSubsystem s) : ArenaScope((int)s) {}
+    ~ArenaScope() {
+        if (arena.subsystem >= 0) memRelease((MemSubsystem)arena.subsystem, arena.charged);
+        arena.subsystem = outerSubsystem;
+        arena.charged = outerCharged;
+        arena.credit = outerCredit;
+        arena.depth--;
+        arena.release(start);
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    /// Resource for the scratch containers of the scope.
+    pmr::memory_resource* resource() { return &arena; }
+
+private:
+    explicit ArenaScope(int s)
+      : arena(threadArena()), start(arena.mark()), outerSubsystem(arena.subsystem), outerCharged(arena.charged),
+        outerCredit(arena.credit) {
+        arena.depth++;
+        arena.subsystem = s;
+        arena.charged = 0;
+        arena.credit = 0;
+    }
+
+    ScratchArena& arena;
+    ScratchArena::Mark start;
+    int outerSubsystem;
+    size_t outerCharged;
+    size_t outerCredit;
+};
+
+struct ArenaStats {
+    int threads = 0;          ///< arenas created (one per thread that used scratch)
+    size_t peakBytes = 0;     ///< largest peak of any arena
+    size_t totalPeak = 0;     ///< sum of the peaks
+    ll blockAllocations = 0;  ///< malloc calls of all arenas (growth and consolidation)
+    ll allocations = 0;       ///< scratch allocations served
+};
+
+ArenaStats arenaStats();
+
+/// One line: arenas, peak sizes, allocations served and the mallocs they needed.
+void arenaReport(ostream& out);
+
+#endif // ARENA_H
@@ -0,0 +1,43 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "constants.h"
+#include "dispatch.h"
+#include "instance_io.h"
+#include <functional>
+
+/**
+ * Throughput mode for streams of many small, independent instances.
+ *
+ * Instances are read `window` at a time. A window is cut into work units of consecutive instances whose
+ * estimated running time (CostProfile of the strategy chooseStrategy() picks for the unreduced n, u, t) adds up
+ * to about `unitSeconds`: thousands of small instances become a few dozen pool tasks instead of one each, and
+ * a unit runs its instances back to back on one worker. An instance above the budget is a unit of its own and
+ * still parallelizes internally. Units run on the shared thread pool while the next window is
+ * read; the results go to `emit` in input order, each as soon as every earlier instance is done.
+ *
+ * Every instance goes through solve() (dispatch.h), so the values are those of the single-instance path.
+ */
+struct BatchOptions {
+    Problem problem = Problem::Knapsack;
+    int window = 1024;                    ///< instances read ahead and scheduled together
+    double unitSeconds = 2e-3;            ///< estimated work per unit
+    const CostProfile* profile = nullptr; ///< defaultCostProfile() if null
+};
+
+struct BatchStats {
+    ll instances = 0;
+    ll units = 0;
+};
+
+/**
+ * Solves the instances `next` yields until it returns false and calls emit(index, result) in input order
+ * (index counts from 0). An instance with t outside [0, INT_MAX - 1] or a weight below 1 gets an empty value.
+ */
+BatchStats solveBatch(
+    const function<bool(Instance&)>& next,
+    const function<void(ll, const SolveResult&)>& emit,
+    const BatchOptions& options = BatchOptions()
+);
+
+#endif // BATCH_H
@@ -0,0 +1,78 @@
+#ifndef BOUNDED_H
+#define BOUNDED_H
+
+#include "constants.h"
+#include "dp_structs.h"
+#include "memory_budget.h"
+
+/**
+ * All-Target Bounded Knapsack: item i can be used at most cap[i] times.
+ *
+ * Items whose cap allows t / w_i copies (or cap[i] < 0) are unbounded within [0, t]; they are solved together by
+ * the kernel computation + witness propagation. Every other item is folded in by one pass over [0, t]: along each
+ * residue class modulo w_i, the best of the last cap[i] + 1 entries (shifted by their copies' profit) is kept in a
+ * monotone queue, so an item costs O(t) whatever its cap, and the capped part O(t · #capped items). When the cost
+ * model (dispatch.h) prices the kernel of the unbounded items above folding them in, they are folded in as well,
+ * with t / w_i copies.
+ *
+ * The decisions (copies of every capped item for every target) take ⌈log₂(cap[i] + 1)⌉ bits, rounded up to a power
+ * of two, per item and target. They are charged to MemSubsystem::Solutions together with the tables, and are not
+ * kept if they would not fit what is left of the memory budget.
+ */
+class BoundedKnapsack {
+public:
+    int n;                  ///< number of items
+    int t;                  ///< largest target
+    vector<ll> value;       ///< value[c] = best profit of weight exactly c, or NEG_INF if c is not reachable
+
+    BoundedKnapsack();
+
+    /// Optimal number of copies of every item (1-indexed) for target c; empty if c is not reachable
+    /// or the decisions were not kept.
+    vector<ll> counts(int c) const;
+
+    /// False if counts() cannot answer: the decisions were not asked for, or did not fit the memory budget.
+    bool decisionsKept() const;
+
+private:
+    struct Capped {
+        int item;       ///< item index
+        int w;          ///< weight of one copy
+        int cap;        ///< copies allowed; t / w for an unbounded item folded in instead of going to the kernel
+        int bits;       ///< bits per target in `decisions`: a power of two ≥ ⌈log₂(cap + 1)⌉
+        size_t offset;  ///< first word of the item in `decisions`
+    };
+
+    vector<Capped> capped;                     ///< items folded in one by one, in that order
+    vector<unsigned long long> decisions;      ///< copies of capped[i] used for target c, packed per item
+    bool keptDecisions;
+    vector<solution> base;                     ///< solutions of the unbounded items
+    vector<int> unboundedItem;                 ///< unboundedItem[x] = item at order index x of the unbounded part
+    MemoryCharge charge;                       ///< value, base and decisions
+
+    friend void solveBoundedKnapsack(
+        int n,
+        const vector<int>& w,
+        const vector<int>& p,
+        const vector<int>& cap,
+        int t,
+        bool keepDecisions,
+        BoundedKnapsack& bk
+    );
+};
+
+/**
+ * Solves every target in [0, t]. With keepDecisions the copies of every capped item are stored per target (if they
+ * fit the memory budget) so that counts() can reconstruct the multiplicities.
+ */
+void solveBoundedKnapsack(
+    int n,
+    const vector<int>& w,       // weights of the items (1-indexed)
+    const vector<int>& p,       // profits of the items (1-indexed)
+    const vector<int>& cap,     // maximum copies of the items (1-indexed), negative for unlimited
+    int t,
+    bool keepDecisions,
+    BoundedKnapsack& bk
+);
+
+#endif // BOUNDED_H
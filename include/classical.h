@@ -0,0 +1,14 @@
+#ifndef CLASSICAL_H
+#define CLASSICAL_H
+
+#include "constants.h"
+
+// Classical O(n·t) dynamic programs, the baselines of knapsack_benchmark/ and coinchange_benchmark/
+
+/// value[c] = max profit of weight exactly c with unlimited copies, or NEG_INF if c is unreachable (1-indexed w, p)
+vector<ll> classicalKnapsack(int n, const vector<int>& w, const vector<int>& p, int t);
+
+/// count[c] = min number of coins of sum exactly c, or -1 if c is unreachable (1-indexed w)
+vector<ll> classicalCoinChange(int n, const vector<int>& w, int t);
+
+#endif // CLASSICAL_H
@@ -0,0 +1,36 @@
+#ifndef COIN_SET_H
+#define COIN_SET_H
+
+#include "constants.h"
+
+/**
+ * Preprocessed coin set, built once per instance and shared by every algorithm.
+ * Coins are 1-indexed; an order index x ∈ [1..n] refers to the coin order[x].
+ */
+class CoinSet {
+public:
+    int n;                      ///< number of coins
+    int u;                      ///< maximum coin weight
+    vector<int> w;              ///< w[coin] = weight (1-indexed)
+    vector<int> p;              ///< p[coin] = profit (1-indexed)
+    vector<int> order;          ///< lex order σ[1..n]
+    vector<int> inverseOrder;   ///< inverseOrder[coin] = order index of the coin
+    vector<int> f;              ///< f[x] = 1 iff some coin has weight x, for x ∈ [0..u] (duplicates collapsed)
+    vector<int> weightStart;    ///< order indices of the coins of weight x: byWeight[weightStart[x] .. weightStart[x+1])
+    vector<int> byWeight;       ///< order indices grouped by weight, ascending within each weight
+    vector<int> indexOfWeight;  ///< smallest order index with weight x, or -1
+
+    CoinSet();
+    CoinSet(int n, int u, const vector<int>& w, const vector<int>& p, const vector<int>& order);
+
+    /// Replaces σ and rebuilds the order-dependent tables.
+    void setOrder(const vector<int>& order);
+
+    /// Weight of the coin at order index x.
+    int weightAt(int x) const { return w[order[x]]; }
+
+    /// Profit of the coin at order index x.
+    int profitAt(int x) const { return p[order[x]]; }
+};
+
+#endif // COIN_SET_H
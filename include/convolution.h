@@ -2,6 +2,8 @@
 #define CONVOLUTION_H
 
 #include "constants.h"
+#include <memory_resource>
+#include <span>
 
 #define rep(i, a, b) for(int i = a; i < (b); ++i)
 #define all(x) begin(x), end(x)
@@ -12,12 +14,52 @@ typedef vector<double> vd;
 
 void fft(vector<C>& a);
 vd conv(const vd& a, const vd& b);
-vector<int> convolution(const vector<int>& a, const vector<int>& b);
+// Integer convolution through the FFT; spans, so std and arena (pmr) vectors are accepted alike.
+// The overloads with `out` write the |a| + |b| - 1 entries into a buffer the caller reuses, without allocating.
+vector<int> convolution(span<const int> a, span<const int> b);
+void convolution(span<const int> a, span<const int> b, span<int> out);
+
+/**
+ * Products of many int sequences with one fixed operand b, as in the dilution rounds of the witness searches:
+ * the transform of b is computed once, and pair() gets a1 * b and a2 * b from one forward and one inverse
+ * transform of a1 + i·a2 (b is real), instead of the four transforms of two convolution() calls. The transform
+ * is kept in `mem`, so the object must not outlive the arena scope that provides it; it is not chunked under
+ * a memory budget.
+ */
+class FixedOperandConv {
+public:
+    /// Prepares b for operands of up to `maxA` entries.
+    FixedOperandConv(span<const int> b, int maxA, pmr::memory_resource* mem);
+
+    /// out1 = a1 * b and out2 = a2 * b, |a1| = |a2| ≤ maxA; both outputs have |a1| + |b| - 1 entries.
+    void pair(span<const int> a1, span<const int> a2, span<int> out1, span<int> out2) const;
+
+private:
+    int n;                 ///< transform size
+    int bLen;
+    pmr::vector<C> bHat;   ///< transform of b, zero-padded to n
+};
 
 // (max, +) convolution
 vector<ll> maxPlusCnv(const vector<ll>& a, const vector<ll>& b);
 
+// (max, +) convolution carrying (value, min-witness) pairs under lexicographic max:
+// witness[c] = min bWit[j] over all maximizers a[c-j] + b[j] (-1 if c is unreachable)
+vector<ll> maxPlusCnv_minWitness(const vector<ll>& a, const vector<ll>& b, const vector<int>& bWit, vector<int>& witness);
+
 // Boolean OR‐convolution (0/1 result)
-vector<int> boolCnv(const vector<int>& a, const vector<int>& b);
+vector<int> boolCnv(span<const int> a, span<const int> b);
+void boolCnv(span<const int> a, span<const int> b, span<int> out);
+
+// Number-theoretic transform modulo NTT_MOD = 119·2^23 + 1 (in place, sizes are powers of two);
+// large transforms run their butterflies on the shared thread pool
+const ll NTT_MOD = 998244353, NTT_ROOT = 62;
+void ntt(vector<ll>& a);
+vector<ll> nttConv(const vector<ll>& a, const vector<ll>& b);
+
+// Power series modulo x^n and NTT_MOD, in O(n log n): 1/a (a[0] != 0), ln a (a[0] = 1), exp a (a[0] = 0)
+vector<ll> polyInverse(const vector<ll>& a, int n);
+vector<ll> polyLog(const vector<ll>& a, int n);
+vector<ll> polyExp(const vector<ll>& a, int n);
 
 #endif // CONVOLUTION_H
@@ -0,0 +1,117 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "constants.h"
+#include "preprocess.h"
+#include "memory_budget.h"
+
+enum class Problem {
+    Knapsack,   ///< All-Target Unbounded Knapsack: max profit of every weight
+    CoinChange  ///< All-Target CoinChange: min number of coins of every sum
+};
+
+enum class Strategy {
+    Classical,            ///< O(n·t) dynamic program
+    Kernel,               ///< Algorithm 2 + Algorithm 1 with the (max, +) kernel (knapsack only)
+    CoinChangeSimple,     ///< kernelComputation_coinchange_simple() + Algorithm 1
+    CoinChangeRandomized, ///< kernelComputation_coinchange_randomized() + Algorithm 1
+    CoinChangeAdaptive,   ///< kernelComputation_coinchange() + Algorithm 1; forced only, see chooseStrategy()
+    CoinChangeSmallU      ///< coinChangeSmallU() (small_u.h); CoinChangeSimple if u > SMALL_U_MAX
+};
+
+const char* strategyName(Strategy s);
+
+/**
+ * The quantities the cost model is evaluated on, taken after reduceInstance(): n then counts the
+ * undominated distinct weights, so dense instances (many weights, few of them useful) are priced as
+ * the small instances they reduce to. Profits do not enter, all kernels are comparison-based.
+ */
+struct InstanceStats {
+    int n;  ///< number of remaining coins
+    int u;  ///< maximum remaining weight
+    int t;  ///< largest reduced target
+};
+
+InstanceStats instanceStats(const ReducedInstance& ri, int t);
+
+/**
+ * Seconds per unit of every model term, calibrated once per host (see calibrateCostProfile()).
+ * With L = log₂ u, k = ⌊2L + 1⌋ kernel iterations and K = k·u kernel capacities, the terms are
+ *   classical:   (n + 1)·t                      (one pass per coin plus the table itself)
+ *   propagation: t·(L + 1)                      (Algorithm 1, shared by every kernel path)
+ *   kernel:      k·K·u                          (quadratic (max, +) pass of the frontier against the coins)
+ *   simple:      k·K·√n·log₂ K                  (√n FFTs per iteration)
+ *   randomized:  k·K·log₂² K                    (prefix doubling with witness sampling)
+ *   adaptive:    k·K·log₂² K·L                  (k-witnesses + hitting sets, per round)
+ *   smallU:      t·(L + 1 + ⌈n / 64⌉)           (bit-parallel propagation, replaces the propagation term)
+ */
+class CostProfile {
+public:
+    double classical, propagation, kernel, simple, randomized, adaptive, smallU;
+
+    /// Constants measured on the development machine.
+    CostProfile();
+
+    /// Reads "<term> <seconds>" lines ('#' starts a comment); false if the file cannot be read.
+    bool load(const string& path);
+    bool save(const string& path) const;
+
+    /// Predicted running time of `s` in seconds.
+    double estimate(Strategy s, const InstanceStats& st) const;
+};
+
+/// The profile named by FASTKNAPSACK_PROFILE if it is set and readable, the built-in constants otherwise.
+const CostProfile& defaultCostProfile();
+
+/// Times every strategy on a few small instances and fits the constants; takes a few seconds.
+CostProfile calibrateCostProfile();
+
+/// The strategy with the lowest estimate for the problem. CoinChangeAdaptive is never chosen: it is still 40-50x
+/// slower than CoinChangeSimple at every u measured, and only runs when forced.
+Strategy chooseStrategy(Problem problem, const InstanceStats& st, const CostProfile& profile);
+
+/**
+ * Pre-flight peak memory of `s` per subsystem, in bytes. Rough estimates from the same quantities as the
+ * cost model: every kernel capacity and target holding a solution of (log₂ u + 1) / 2 coins, the FFT of the
+ * widest kernel window, the witness scratch of one kernel iteration. `streamed` prices the kernel paths when
+ * they stream the targets through propagationStreamed() (algorithms.h), which holds k·u + u + 1 solutions.
+ */
+MemoryEstimate estimateMemory(Strategy s, const InstanceStats& st, bool streamed = false);
+
+/**
+ * Does `s` have to stream its targets to stay within the memory budget? True for the kernel paths when a
+ * budget is set and their estimate exceeds what is left of it; solve() then computes the kernel alone and
+ * runs Algorithm 1 through a window of u + 1 solutions, emitting every value as soon as it is final.
+ */
+bool streamsTargets(Strategy s, const InstanceStats& st);
+
+struct SolveResult {
+    Strategy strategy;      ///< the path that ran
+    vector<ll> value;       ///< knapsack: max profit or NEG_INF; coin change: min coins or -1, for every c ∈ [0..t]
+    bool streamed = false;  ///< the targets were streamed to stay within the memory budget
+};
+
+/**
+ * Reduces the instance, then solves all targets in [0..t] with the strategy the cost model predicts
+ * to be the fastest (1-indexed w and p; p is ignored for CoinChange).
+ */
+SolveResult solve(
+    Problem problem,
+    int n,
+    const vector<int>& w,
+    const vector<int>& p,
+    int t,
+    const CostProfile& profile = defaultCostProfile()
+);
+
+/// Reduces the instance and runs the given strategy.
+SolveResult solveWith(
+    Strategy strategy,
+    Problem problem,
+    int n,
+    const vector<int>& w,
+    const vector<int>& p,
+    int t
+);
+
+#endif // DISPATCH_H
@@ -26,3 +26,9 @@ public:
     //Copies s1 over to s2
     void copy(solution &s2);
 };
+
+/// Heap bytes of one svec entry: a map<int, ll> tree node with its malloc header.
+const size_t SVEC_NODE_BYTES = 64;
+
+/// Heap bytes of sol[from..to]: the solutions and one tree node per svec entry (for the memory accounting).
+size_t solutionTableBytes(const vector<solution>& sol, int from, int to);
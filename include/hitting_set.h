@@ -3,8 +3,46 @@
 
 #include "constants.h"
 
-// Given `sets` (u subsets of [0..n)), each of size ≥ R,
-// returns a hitting set H ⊆ [0..n) with |H| ≤ ⌈(n/R)·ln(u)⌉.
+/**
+ * A family of subsets of [1..n] in CSR form: set s is elems[start[s] .. start[s+1]).
+ */
+struct SetSystem {
+    vector<int> start;
+    vector<int> elems;
+
+    SetSystem();
+
+    /// Bulk construction straight from the witness lists (one allocation, no intermediate vector<vector<int>>).
+    explicit SetSystem(const vector<const vector<int>*>& lists);
+
+    /// Number of sets.
+    int size() const;
+
+    /// Appends one set.
+    void addSet(const vector<int>& set);
+};
+
+// Given `sets` (each a subset of [1..n]) of size ≥ R,
+// returns a hitting set H ⊆ [1..n] with |H| ≤ ⌈(n/R)·ln(#sets)⌉.
+vector<int> computeHittingSet(
+    const SetSystem& sets,
+    int R,
+    int n
+);
+
+// Randomized parallel variant: keeps every element that occurs in some set with probability
+// q = min(1, ln(#sets)/R), checks all sets in parallel and greedily repairs the missed ones. Falls back to the
+// greedy above if q times the number of distinct elements, or the result, exceeds `limit`. Deterministic for
+// a given seed, whatever the number of threads.
+vector<int> computeHittingSet_randomized(
+    const SetSystem& sets,
+    int R,
+    int n,
+    int limit,
+    unsigned seed
+);
+
+// Same as the greedy, for u sets given as separate vectors.
 vector<int> computeHittingSet(
     const vector<vector<int>>& sets,
     int u,
@@ -0,0 +1,154 @@
+#ifndef INSTANCE_IO_H
+#define INSTANCE_IO_H
+
+#include "constants.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/uio.h>
+#include <type_traits>
+
+/**
+ * Instance and result files for the solvers.
+ *
+ * Text instance:   "n u t" followed by n lines "w p" (what the solvers always read from stdin).
+ * Binary instance: little-endian, 24-byte header then two arrays
+ *     char magic[4] = "FKIN", uint32 version = 1, int32 n, int32 u, int64 t,
+ *     int32 w[n], int32 p[n]
+ * Binary results:  little-endian, 16-byte header then one array
+ *     char magic[4] = "FKRS", uint32 version = 1, int64 count, int64 value[count]
+ *
+ * Files are memory-mapped: a binary instance is validated and then read in place through an InstanceView,
+ * a text file is parsed straight from the mapping without stream buffering. Results are written with one write().
+ */
+
+const char INSTANCE_MAGIC[4] = {'F', 'K', 'I', 'N'};
+const char RESULTS_MAGIC[4]  = {'F', 'K', 'R', 'S'};
+const unsigned INSTANCE_IO_VERSION = 1;
+
+template <typename T>
+T loadLE(const char* p) {
+    typename make_unsigned<T>::type x = 0;
+    if constexpr (endian::native == endian::little) {
+        memcpy(&x, p, sizeof(T));
+    } else {
+        for (int i = (int)sizeof(T) - 1; i >= 0; i--) x = (x << 8) | (unsigned char)p[i];
+    }
+    return (T)x;
+}
+
+template <typename T>
+void storeLE(char* p, T v) {
+    auto x = (typename make_unsigned<T>::type)v;
+    if constexpr (endian::native == endian::little) {
+        memcpy(p, &x, sizeof(T));
+    } else {
+        for (size_t i = 0; i < sizeof(T); i++, x >>= 8) p[i] = (char)(x & 0xff);
+    }
+}
+
+/// Writes every iovec completely to `fd` (a file or a socket), resuming after partial writes.
+bool writeFully(int fd, vector<iovec> iov);
+
+/// A whole file mapped read-only; unmapped by the destructor.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Maps `path`, replacing any earlier mapping; false if it cannot be opened or mapped.
+    bool open(const string& path);
+    void close();
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const char* ptr;
+    size_t len;
+};
+
+/// The coins of a binary instance, read in place from its bytes (no copy on little-endian hosts).
+struct InstanceView {
+    int n;
+    int u;
+    ll t;
+    const char* weights;  ///< n little-endian int32
+    const char* profits;  ///< n little-endian int32
+
+    int weight(int i) const;  ///< weight of coin i, 1-indexed
+    int profit(int i) const;  ///< profit of coin i, 1-indexed
+};
+
+/// An instance in the layout of the solvers: 1-indexed w and p, entry 0 unused.
+struct Instance {
+    int n = 0;
+    int u = 0;
+    ll t = 0;
+    vector<int> w, p;
+};
+
+/// Validates a binary instance (magic, version, sizes) and points `view` into `data`.
+bool parseBinaryInstance(const char* data, size_t size, InstanceView& view);
+
+/// Copies the coins of a binary instance into the solver layout.
+void instanceFromView(const InstanceView& view, Instance& inst);
+
+/// Parses a text instance from memory.
+bool parseTextInstance(const char* data, size_t size, Instance& inst);
+
+/// Text instance from a stream, e.g. stdin.
+bool readTextInstance(istream& in, Instance& inst);
+
+/// Maps `path` and reads it as a binary instance if it starts with the magic, as a text instance otherwise.
+bool readInstance(const string& path, Instance& inst);
+
+/// Reads `path`, or stdin (text only) if `path` is empty.
+bool loadInstance(const string& path, Instance& inst);
+
+/// The bytes of the binary instance file of `inst`.
+string encodeBinaryInstance(const Instance& inst);
+
+bool writeBinaryInstance(const string& path, const Instance& inst);
+
+/// Binary results, written with a single write() on little-endian hosts.
+bool writeBinaryResults(const string& path, const vector<ll>& values);
+
+/// One value per line, formatted into one buffer instead of going through the stream per line.
+bool writeTextResults(ostream& out, const vector<ll>& values);
+
+/// One binary results record (header and values) appended to a stream; a batch writes one per instance.
+bool appendBinaryResults(ostream& out, const vector<ll>& values);
+
+/// Binary results to `path`, or text lines to stdout if `path` is empty.
+bool storeResults(const string& path, const vector<ll>& values);
+
+/// Reads binary results back (for tests and benchmarks).
+bool readBinaryResults(const string& path, vector<ll>& values);
+
+/**
+ * A sequence of instances, read one at a time: concatenated binary instances or whitespace-separated
+ * text instances in a mapped file, or text instances on stdin.
+ */
+class InstanceStream {
+public:
+    /// Reads `path`, or stdin if `path` is empty; false if the file cannot be mapped.
+    bool open(const string& path);
+
+    /// The next instance; false at the end of the input or at malformed input (then failed() is true).
+    bool next(Instance& inst);
+
+    bool failed() const { return bad; }
+
+private:
+    MappedFile file;
+    size_t offset = 0;
+    bool fromStdin = false;
+    bool binary = false;
+    bool bad = false;
+};
+
+#endif // INSTANCE_IO_H
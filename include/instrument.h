@@ -0,0 +1,107 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include "constants.h"
+#include <atomic>
+#include <string>
+
+/**
+ * Hot-path instrumentation: named counters, size histograms and scoped timers.
+ *
+ * Built in only when FASTKNAPSACK_INSTRUMENT is defined (CMake option of the same name); otherwise every FK_ macro
+ * expands to nothing and the hot paths are exactly the uninstrumented code. Each macro call site owns a probe that
+ * registers itself on first use and lives until exit, so a hit costs two relaxed atomic adds. Probes with the
+ * same name are merged in the report, which is written to stderr at exit, or to the file named by
+ * FASTKNAPSACK_INSTRUMENT_REPORT.
+ */
+
+/// Counter probe: number of hits and their summed amount.
+struct InstrumentCounter {
+    const char* name;
+    atomic<unsigned long long> hits;
+    atomic<unsigned long long> total;
+
+    explicit InstrumentCounter(const char* name);
+    void add(unsigned long long amount) {
+        hits.fetch_add(1, memory_order_relaxed);
+        total.fetch_add(amount, memory_order_relaxed);
+    }
+};
+
+/// Histogram probe: hits bucketed by ⌊log₂ size⌋ (bucket 0 also takes size 0).
+struct InstrumentHistogram {
+    static const int BUCKETS = 64;
+    const char* name;
+    atomic<unsigned long long> buckets[BUCKETS];
+    atomic<unsigned long long> total;
+
+    explicit InstrumentHistogram(const char* name);
+    void add(unsigned long long size) {
+        int b = size == 0 ? 0 : 63 - __builtin_clzll(size);
+        buckets[b].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(size, memory_order_relaxed);
+    }
+};
+
+/// Timer probe: number of scopes and their summed wall time.
+struct InstrumentTimer {
+    const char* name;
+    atomic<unsigned long long> calls;
+    atomic<unsigned long long> nanos;
+
+    explicit InstrumentTimer(const char* name);
+};
+
+/// Adds the lifetime of the scope to a timer probe.
+class InstrumentScope {
+public:
+    explicit InstrumentScope(InstrumentTimer& timer)
+      : timer(timer), start(chrono::steady_clock::now())
+    {}
+    ~InstrumentScope() {
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        timer.calls.fetch_add(1, memory_order_relaxed);
+        timer.nanos.fetch_add((unsigned long long)ns, memory_order_relaxed);
+    }
+
+private:
+    InstrumentTimer& timer;
+    chrono::steady_clock::time_point start;
+};
+
+/// True iff the library was built with FASTKNAPSACK_INSTRUMENT.
+bool instrumentEnabled();
+
+/// Writes every probe hit so far, merged by name and sorted, to `out`.
+void instrumentReport(ostream& out);
+
+/// Zeroes every probe, e.g. between the runs of a benchmark.
+void instrumentReset();
+
+/// Summed amount of the probes called `name`: counter amounts, histogram sizes or timer nanoseconds; 0 if none.
+unsigned long long instrumentTotal(const string& name);
+
+/// Number of hits of the probes called `name`; 0 if there is none.
+unsigned long long instrumentHits(const string& name);
+
+#define FK_CONCAT_(a, b) a##b
+#define FK_CONCAT(a, b) FK_CONCAT_(a, b)
+
+#ifdef FASTKNAPSACK_INSTRUMENT
+/// Counts one hit of `name` with the given amount.
+#define FK_COUNT(name, amount) \
+    do { static InstrumentCounter& fk_probe_ = *new InstrumentCounter(name); fk_probe_.add(amount); } while (0)
+/// Records `size` in the histogram `name`.
+#define FK_HISTOGRAM(name, size) \
+    do { static InstrumentHistogram& fk_probe_ = *new InstrumentHistogram(name); fk_probe_.add(size); } while (0)
+/// Times the rest of the enclosing scope under `name`.
+#define FK_SCOPED_TIMER(name) \
+    static InstrumentTimer& FK_CONCAT(fk_timer_, __LINE__) = *new InstrumentTimer(name); \
+    InstrumentScope FK_CONCAT(fk_scope_, __LINE__)(FK_CONCAT(fk_timer_, __LINE__))
+#else
+#define FK_COUNT(name, amount) do {} while (0)
+#define FK_HISTOGRAM(name, size) do {} while (0)
+#define FK_SCOPED_TIMER(name) do {} while (0)
+#endif
+
+#endif // INSTRUMENT_H
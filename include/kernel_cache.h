@@ -0,0 +1,67 @@
+#ifndef KERNEL_CACHE_H
+#define KERNEL_CACHE_H
+
+#include "constants.h"
+#include "dp_structs.h"
+#include "coin_set.h"
+#include <string>
+
+/**
+ * Persistent cache of kernels (the output of Algorithm 2, sol[0..k·u]).
+ *
+ * A kernel depends only on the coins, their profits, the lex order and the algorithm, so it is stored in a file
+ * named after the FNV-1a fingerprint of exactly these: <dir>/<16 hex digits>-<kind>.kernel. The file keeps the
+ * coins it was built from (a load compares them, so a fingerprint collision is a miss, never a wrong kernel) and,
+ * for the algorithms that adapt the order, the adapted order. A warm start maps the file and rebuilds sol from its
+ * arrays without any convolution; propagation() or the query path continue from there.
+ *
+ * Files are written to a temporary name and renamed, so concurrent writers and readers never see a partial file.
+ * The arrays are stored in host byte order; a file written on a host of the other endianness is a miss.
+ */
+
+enum class KernelKind {
+    Knapsack = 1,           ///< kernelComputation_knapsack
+    CoinChangeSimple,       ///< kernelComputation_coinchange_simple
+    CoinChangeRandomized,   ///< kernelComputation_coinchange_randomized (adapts the order)
+    CoinChangeAdaptive,     ///< kernelComputation_coinchange (adapts the order)
+    CoinChangeSmallU        ///< kernelComputation_coinchange_smallU
+};
+
+const char* kernelKindName(KernelKind kind);
+
+/// FNV-1a (64 bit) of the algorithm, n, u, the weights, the profits and the order.
+unsigned long long kernelFingerprint(KernelKind kind, const CoinSet& cs);
+
+class KernelCache {
+public:
+    /// Caches in `dir`, which is created if it does not exist yet.
+    explicit KernelCache(const string& dir);
+
+    /// File holding the kernel of `cs` (with its current order) for `kind`.
+    string path(KernelKind kind, const CoinSet& cs) const;
+
+    /**
+     * Fills sol[0..max(k·u, t)] from the cache; false on a miss. A file that does not match `cs` or fails the
+     * consistency checks (entry offsets, coin indices, the adapted order) is a miss, and `sol` and `cs` are untouched.
+     * For the kinds that adapt the order, `cs` receives the adapted order of the cached run.
+     */
+    bool load(KernelKind kind, CoinSet& cs, int t, vector<solution>& sol) const;
+
+    /**
+     * Stores the kernel `sol` that `kind` computed for the coins of `cs` with the lex order `inputOrder`
+     * (cs.order may since have been adapted by the algorithm). False if the file cannot be written or `sol` is
+     * shorter than the kernel (k·u + 1 solutions), which would otherwise load as a hit.
+     */
+    bool store(KernelKind kind, const vector<int>& inputOrder, const CoinSet& cs, const vector<solution>& sol) const;
+
+private:
+    string dir;
+};
+
+/**
+ * Algorithm 2 of `kind` on `cs` through `cache`: loads the kernel on a hit, computes and stores it on a miss.
+ * Without a cache this is just the kernel computation. Returns true iff the kernel came from the cache.
+ */
+bool computeKernel(KernelKind kind, CoinSet& cs, int t, vector<solution>& sol, const KernelCache* cache = nullptr);
+
+#endif // KERNEL_CACHE_H
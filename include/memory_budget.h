@@ -0,0 +1,91 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include "constants.h"
+#include <string>
+
+/**
+ * Memory accounting per subsystem and the memory budget.
+ *
+ * Every subsystem keeps a live and a peak byte count. Scratch memory is charged by the arena scopes that carry
+ * a subsystem (arena.h), in refills of at least 64 KiB rather than per allocation, so a scope's usage may read up
+ * to one refill high; the solution tables are charged by their owners through MemoryCharge. The counters are
+ * process-wide relaxed atomics updated once per refill or charge, and are exact only up to what concurrently
+ * running threads hold at the same instant.
+ *
+ * The budget (0 = unlimited) comes from FASTKNAPSACK_MEMORY ("512M", "2G", ...) or setMemoryBudget(). It is
+ * not a hard limit: the code that can trade memory for time asks memoryAvailable() before its big allocations
+ * and falls back to a chunked or streaming variant (chunked FFT convolutions, chunked peeling tables, Algorithm 1
+ * through a window of u + 1 solutions instead of one table of t + 1) when the regular one would not fit.
+ */
+enum class MemSubsystem {
+    Convolution, ///< FFT buffers and the double/int copies of the operands
+    Witness,     ///< minimum witness and k-witness scratch, including the kernel's per-row scratch
+    Peeling,     ///< peeling families and their intersection tables
+    Solutions    ///< solution tables, DP tables and value arrays
+};
+
+const int MEM_SUBSYSTEMS = 4;
+
+const char* memSubsystemName(MemSubsystem s);
+
+void memCharge(MemSubsystem s, size_t bytes);
+void memRelease(MemSubsystem s, size_t bytes);
+
+/// Charges `bytes` to a subsystem for as long as it lives; set() moves the charge to the current size.
+class MemoryCharge {
+public:
+    MemoryCharge(MemSubsystem s, size_t bytes = 0) : sub(s), bytes(bytes) { memCharge(sub, bytes); }
+    ~MemoryCharge() { memRelease(sub, bytes); }
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    void set(size_t now) {
+        if (now > bytes) memCharge(sub, now - bytes);
+        else memRelease(sub, bytes - now);
+        bytes = now;
+    }
+    size_t held() const { return bytes; }
+
+private:
+    MemSubsystem sub;
+    size_t bytes;
+};
+
+struct MemoryUsage {
+    size_t live[MEM_SUBSYSTEMS] = {};
+    size_t peak[MEM_SUBSYSTEMS] = {};
+    size_t liveTotal = 0;
+    size_t peakTotal = 0;  ///< peak of the sum over the subsystems, not the sum of their peaks
+};
+
+MemoryUsage memoryUsage();
+
+/// One line per subsystem with a nonzero peak, then the total and the budget.
+void memoryReport(ostream& out);
+
+/// Bytes the process may use for the accounted subsystems; 0 if unlimited.
+size_t memoryBudget();
+void setMemoryBudget(size_t bytes);
+
+/// Bytes left under the budget (SIZE_MAX if unlimited, 0 if it is already exceeded).
+size_t memoryAvailable();
+
+/// Parses "123", "64K", "512M", "2G" (binary units, case-insensitive); false on anything else.
+bool parseByteSize(const string& text, size_t& bytes);
+
+/// "12.3 MiB"
+string formatBytes(size_t bytes);
+
+/// Per-subsystem peak estimate of a run (see estimateMemory() in dispatch.h).
+struct MemoryEstimate {
+    size_t bytes[MEM_SUBSYSTEMS] = {};
+
+    size_t& operator[](MemSubsystem s) { return bytes[(int)s]; }
+    size_t total() const;
+};
+
+/// "total X (solutions A, convolution B, ...)" over the nonzero subsystems.
+void printEstimate(ostream& out, const MemoryEstimate& est);
+
+#endif // MEMORY_BUDGET_H
@@ -2,6 +2,7 @@
 #define PEELING_H
 
 #include "constants.h"
+#include "coin_set.h"
 
 /**
  * Randomized k-matches reconstruction.
@@ -35,4 +36,12 @@ vector<vector<int>> k_find_witnesses_knapsack(
     int k
 );
 
+// Same, with the weight -> coin lookup served by the dense index of `cs`
+vector<vector<int>> k_find_witnesses_knapsack(
+    vector<int> &a,
+    vector<int> &b,
+    const CoinSet &cs,
+    int k
+);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef PERIODIC_H
+#define PERIODIC_H
+
+#include "constants.h"
+#include "dp_structs.h"
+#include "coin_set.h"
+
+/**
+ * Closed-form answers for targets far beyond the kernel (All-Target Unbounded Knapsack / CoinChange).
+ *
+ * Let b be the coin with the best profit/weight ratio, g the gcd of w_b and the other weights and u' the
+ * heaviest other coin. The prefix sums of any w_b / g coins other than b take at most w_b / g - 1 nonzero
+ * residues modulo w_b, so two of them (or one and 0) coincide: some non-empty sub-multiset weighs a multiple
+ * of w_b, and swapping it for copies of b never loses profit. So some optimal solution uses fewer than w_b / g
+ * other coins, i.e. at most (w_b / g - 1)·u' of its weight is not b. Hence for every target
+ * c ≥ threshold = (w_b / g - 1)·u' + 1: OPT(c) = OPT(c - w_b) + p_b, and c is feasible iff c - w_b is.
+ *
+ * Only sol[0 .. threshold + period) is materialized, every other target is answered in O(1). That base is
+ * O(u·w_b) solutions, so it is only built up to PERIODIC_MAX_BASE targets; coin sets with a larger base are
+ * rejected (buildPeriodicKnapsack() returns false).
+ */
+class PeriodicKnapsack {
+public:
+    int best;               ///< order index of the coin with the best profit/weight ratio
+    ll threshold;           ///< the recurrence holds for every target ≥ threshold
+    ll period;              ///< weight of the best coin
+    ll periodProfit;        ///< profit of the best coin
+    vector<solution> base;  ///< sol[c] for c ∈ [0, threshold + period)
+
+    PeriodicKnapsack();
+
+    /// Is the target t reachable at all?
+    bool feasible(ll t) const;
+
+    /// Optimal value for target t, or NEG_INF if t is not reachable; saturates, see periodicValue().
+    ll value(ll t) const;
+
+    /// An optimal multiset for target t (order index → count, like solution::svec); empty if not reachable.
+    map<int,ll> multiset(ll t) const;
+
+private:
+    /// Splits t into a base target in [0, threshold + period) plus `copies` extra copies of the best coin.
+    ll reduce(ll t, ll& copies) const;
+};
+
+/// Largest base [0, threshold + period) that is materialized: one solution (about 100 bytes plus 64 per coin
+/// in its support) per target, so roughly 1-2 GiB at the limit.
+const ll PERIODIC_MAX_BASE = 1 << 23;
+
+/**
+ * baseValue + copies·profit, the value of a target `copies` periods above its base target. Far targets of a
+ * heavy-profit coin exceed 64 bits (w_b = 1, p_b = 1000, t = 10^17 is worth 10^20), so the sum is formed in
+ * 128 bits and saturated to ±LLONG_MAX. Values are exact as long as copies ≤ (LLONG_MAX - |baseValue|) / |p_b|,
+ * i.e. for every target below about LLONG_MAX / p_b · w_b.
+ */
+ll periodicValue(ll baseValue, ll copies, ll profit);
+
+/// Order index of the coin with the best profit/weight ratio; ties go to the lighter coin.
+int bestRatioCoin(const CoinSet& cs);
+
+/// The threshold above for the coin at order index `best`, in 64 bits (it exceeds INT_MAX for large w_b·u).
+ll periodicThreshold(const CoinSet& cs, int best);
+
+/// threshold + period of the best-ratio coin of `cs`: the size of the base table.
+ll periodicBaseSize(const CoinSet& cs);
+
+/**
+ * Builds the kernel, propagates it over one period past the threshold and stores the result in `pk`.
+ * Runs in O(u·w_b·log u) on top of the kernel computation, independently of the queried targets.
+ * False, with `pk` untouched, if the base would exceed PERIODIC_MAX_BASE targets.
+ */
+bool buildPeriodicKnapsack(
+    int n, int u,
+    const vector<int>& w,
+    const vector<int>& p,
+    const vector<int>& order,
+    PeriodicKnapsack& pk
+);
+bool buildPeriodicKnapsack(const CoinSet& cs, PeriodicKnapsack& pk);
+
+#endif // PERIODIC_H
@@ -0,0 +1,49 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include "constants.h"
+#include "coin_set.h"
+
+/**
+ * Instance reduction ahead of the kernel computation (All-Target Unbounded Knapsack / CoinChange).
+ *
+ * A coin i is dominated by a coin j if w_i = m·w_j for an integer m ≥ 1 and p_i ≤ m·p_j: m copies of j
+ * replace i in any solution without losing profit. This covers same-weight coins with lower profit and,
+ * for m = 1 and p_i = p_j, duplicates (the coin earlier in the lex order is kept). The remaining weights
+ * are divided by their gcd g, so only targets that are multiples of g are reachable and target t
+ * becomes t / g. The optimal value of every target is preserved.
+ */
+class ReducedInstance {
+public:
+    int n;                      ///< number of remaining coins
+    int u;                      ///< maximum remaining weight (after scaling)
+    int g;                      ///< gcd of the remaining weights
+    vector<int> w;              ///< w[i] = weight of remaining coin i divided by g (1-indexed)
+    vector<int> p;              ///< p[i] = profit of remaining coin i (1-indexed)
+    vector<int> order;          ///< lex order of the remaining coins, induced by the original order
+    vector<int> original;       ///< original[i] = index of remaining coin i in the input
+
+    ReducedInstance();
+
+    /// Target of the reduced instance for the original target t, or -1 if t is not a multiple of g.
+    ll target(ll t) const;
+
+    /// Translates a multiset of the reduced instance (order index → count, like solution::svec) to original coin indices.
+    map<int,ll> originalMultiset(const map<int,ll>& svec) const;
+
+    /// CoinSet of the reduced instance.
+    CoinSet coins() const;
+};
+
+/**
+ * Removes dominated and duplicate coins and scales the weights by their gcd, in O(n + u log u).
+ */
+void reduceInstance(
+    int n, int u,
+    const vector<int>& w,
+    const vector<int>& p,
+    const vector<int>& order,
+    ReducedInstance& ri
+);
+
+#endif // PREPROCESS_H
@@ -0,0 +1,93 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "constants.h"
+#include "instance_io.h"
+#include <string>
+
+/**
+ * Wire protocol of knapsack_server (Unix domain stream socket, little-endian).
+ *
+ * Every message is a 40-byte header followed by `payloadLen` bytes:
+ *     request:  char magic[4] = "FKRQ", uint32 version = 1, uint32 type, uint32 reserved,
+ *               uint64 id, int64 deadlineMicros, uint64 payloadLen
+ *     response: char magic[4] = "FKRP", uint32 version = 1, uint32 status, uint32 flags,
+ *               uint64 id, int64 computeMicros, uint64 payloadLen
+ *
+ * Request payloads:
+ *     Solve     a binary instance (instance_io.h); answered with int64 value[t + 1], like knapsack_solver
+ *     Query     int64 q, int64 target[q], then a binary instance (its t is ignored); answered with int64 value[q]
+ *     Stats     empty; answered with a text summary of the server counters
+ *     Shutdown  empty; the server answers, stops accepting and exits once the requests in flight are answered
+ * Unreachable targets have the value -1000000000. A response with a status other than Ok carries a text message.
+ *
+ * A connection may send several requests without waiting; the responses come back in the order they finish,
+ * matched by `id`. deadlineMicros (0 = none) is counted from the moment the server read the request.
+ */
+
+const char REQUEST_MAGIC[4]  = {'F', 'K', 'R', 'Q'};
+const char RESPONSE_MAGIC[4] = {'F', 'K', 'R', 'P'};
+const unsigned PROTOCOL_VERSION = 1;
+const size_t MESSAGE_HEADER = 40;
+const char DEFAULT_SOCKET_PATH[] = "/tmp/fastknapsack.sock";
+
+enum class RequestType : uint32_t {
+    Solve = 1,
+    Query = 2,
+    Stats = 3,
+    Shutdown = 4
+};
+
+enum class ResponseStatus : uint32_t {
+    Ok = 0,
+    BadRequest = 1,
+    DeadlineExceeded = 2,
+    ShuttingDown = 3,
+    ResourceExhausted = 4, ///< over the server's target limit or memory budget, or out of memory while answering
+    InternalError = 5      ///< the request failed inside the solver; the server keeps running
+};
+
+const uint32_t RESPONSE_KERNEL_WARM = 1;    ///< flag: the kernel was still in the server's memory
+const uint32_t RESPONSE_KERNEL_CACHED = 2;  ///< flag: the kernel was loaded from the --kernel-cache directory
+
+struct Request {
+    RequestType type = RequestType::Stats;
+    uint64_t id = 0;
+    ll deadlineMicros = 0;
+    string payload;
+};
+
+struct Response {
+    ResponseStatus status = ResponseStatus::Ok;
+    uint32_t flags = 0;
+    uint64_t id = 0;
+    ll computeMicros = 0;   ///< time the server spent on the request, without queueing
+    string payload;
+};
+
+const char* responseStatusName(ResponseStatus status);
+
+/// Reads exactly `len` bytes; false on EOF or error.
+bool readFully(int fd, char* buf, size_t len);
+
+/// Reads one request; false on EOF, on a malformed header or if the payload exceeds `maxPayload`.
+bool readRequest(int fd, Request& req, size_t maxPayload);
+bool writeRequest(int fd, const Request& req);
+
+bool readResponse(int fd, Response& res);
+bool writeResponse(int fd, const Response& res);
+
+/// Payload of a Query request.
+string encodeQuery(const vector<ll>& targets, const Instance& inst);
+
+/// Splits a Query payload; false if it is malformed.
+bool decodeQuery(const string& payload, vector<ll>& targets, InstanceView& view);
+
+/// int64 values as a response payload, and back.
+string encodeValues(const vector<ll>& values);
+bool decodeValues(const string& payload, vector<ll>& values);
+
+/// Connects to the server at `path`; the socket, or -1 (errno is set).
+int connectSocket(const string& path);
+
+#endif // PROTOCOL_H
@@ -0,0 +1,72 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "constants.h"
+#include "dp_structs.h"
+#include "coin_set.h"
+#include "kernel_cache.h"
+#include "memory_budget.h"
+
+/**
+ * Sparse target queries (All-Target Unbounded Knapsack / CoinChange with p = -1).
+ *
+ * The kernel is built once. A query for target t walks back from t in steps of w_b (the coin with the
+ * best profit/weight ratio, w_b ≤ u) until it lands below threshold + period, see periodic.h; the walk is
+ * a single division. Solutions below that bound are memoized: Algorithm 1 runs only up to the largest
+ * landing point asked for so far and resumes from there when a later query lands higher. Answering a
+ * batch therefore costs O(min(max target, w_b·u)·log u) on top of the kernel instead of O(t log u), and
+ * every further query in the propagated range is O(1).
+ *
+ * Landing points are bounded by PERIODIC_MAX_BASE (periodic.h). When threshold + period exceeds it, targets
+ * below PERIODIC_MAX_BASE are still propagated directly, but larger ones cannot be answered: callers check
+ * answerable() before asking.
+ */
+class TargetQuery {
+public:
+    /// Builds the kernel of `cs` (copied, so the query object is self-contained), or loads it from `cache`.
+    explicit TargetQuery(const CoinSet& cs, const KernelCache* cache = nullptr);
+
+    /// Did the kernel come from the cache?
+    bool cachedKernel() const { return fromCache; }
+
+    /// Does the target land below PERIODIC_MAX_BASE? value() and multiset() need this; negative targets pass.
+    bool answerable(ll t) const;
+
+    /// The same for every target, on the coins alone: validates a request before any kernel is built.
+    static bool answerable(const CoinSet& cs, const vector<ll>& targets);
+
+    /// Optimal value of target t, or NEG_INF if t is not reachable (or not answerable()); saturates like
+    /// periodicValue() past LLONG_MAX / p_b periods.
+    ll value(ll t);
+
+    /// An optimal multiset of target t (order index → count, like solution::svec); empty if not reachable.
+    map<int,ll> multiset(ll t);
+
+    /// value() of every target; propagates once up to the largest answerable landing point of the batch.
+    vector<ll> values(const vector<ll>& targets);
+
+    /// Solutions are final on [0, propagated()].
+    int propagated() const { return done; }
+
+    /// Every target ≥ threshold() is answered through the period.
+    ll threshold() const { return thresholdTarget; }
+
+private:
+    CoinSet cs;
+    vector<solution> sol;
+    int best;                ///< order index of the best-ratio coin
+    ll period;               ///< w_b
+    ll periodProfit;         ///< p_b
+    ll thresholdTarget;      ///< periodicThreshold(), about (w_b - 1)·u + 1
+    int done;                ///< sol[0..done] is final
+    bool fromCache;
+    MemoryCharge table;      ///< bytes of sol, charged to MemSubsystem::Solutions
+
+    /// Target in [0, threshold + period) with the same answer up to `copies` extra copies of the best coin.
+    ll land(ll t, ll& copies) const;
+
+    /// Makes sol[0..limit] final.
+    void extend(ll limit);
+};
+
+#endif // QUERY_H
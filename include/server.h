@@ -0,0 +1,122 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "constants.h"
+#include "preprocess.h"
+#include "protocol.h"
+#include "query.h"
+#include "kernel_cache.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+/**
+ * Resident solver behind a Unix domain socket (protocol.h).
+ *
+ * A process per request pays the start-up, the FFT and NTT root tables (built lazily and kept in convolution.cpp)
+ * and the kernel every time. The server keeps all three: the root tables live as long as the process, and the
+ * kernels of the last `maxKernels` distinct instances stay in memory as TargetQuery objects, so a repeated
+ * instance costs only its propagation, or nothing for targets already propagated. Instances are reduced
+ * (preprocess.h) before the lookup, so instances that differ only in dominated coins or in the gcd share
+ * a kernel. With a kernel cache directory, kernels evicted from memory or computed by an earlier server are
+ * loaded from disk (kernel_cache.h).
+ *
+ * One reader thread per connection parses requests into a queue; `workers` threads answer them concurrently
+ * (the kernel code itself still parallelizes over the shared thread pool). Requests for the same kernel are
+ * serialized on it, since a TargetQuery is not thread-safe. A deadline is checked when a worker takes the
+ * request, after the kernel and before the answer is sent; the kernel computation itself is not interrupted,
+ * so a late request still leaves its kernel warm for the next one.
+ *
+ * A request asking for more than `maxTargets` targets, or whose estimated memory (estimateMemory() of the
+ * solution table it needs, plus its values and answer) exceeds memoryAvailable(), is refused with
+ * ResourceExhausted before anything is allocated. A request that still throws (bad_alloc included) is answered
+ * with an error status; it does not take the other connections down.
+ */
+class KnapsackServer {
+public:
+    struct Options {
+        string socketPath = DEFAULT_SOCKET_PATH;
+        int workers = 1;
+        int maxKernels = 64;            ///< kernels kept in memory, least recently used evicted first
+        string kernelCacheDir;          ///< empty: no disk cache
+        size_t maxPayload = 16ull << 20; ///< bytes; larger requests close the connection
+        ll maxTargets = 1 << 22;         ///< targets one request may ask for (t + 1 for a dense Solve)
+    };
+
+    explicit KnapsackServer(const Options& options);
+    ~KnapsackServer();
+
+    /// Binds and listens on the socket (replacing a stale socket file); false with errno set on failure.
+    bool listen();
+
+    /// Accepts connections and answers requests until shutdown(), then waits for the requests in flight.
+    void run();
+
+    /// Stops accepting; safe from any thread, including a worker answering a Shutdown request.
+    void shutdown();
+
+    /// Request, kernel and queue counters, as answered to a Stats request.
+    string stats();
+
+private:
+    /// A kernel in memory: the reduced instance it belongs to and the query object over it.
+    struct KernelEntry {
+        ReducedInstance ri;             ///< only the coins matter; the gcd of a request is taken from its own reduction
+        mutex lock;                     ///< held while the query object is used
+        unique_ptr<TargetQuery> query;  ///< built by the first request
+    };
+
+    struct Connection {
+        int fd;
+        mutex writeLock;
+        explicit Connection(int fd) : fd(fd) {}
+        ~Connection();
+    };
+
+    struct Job {
+        shared_ptr<Connection> conn;
+        Request req;
+        chrono::steady_clock::time_point received;
+    };
+
+    void readerLoop(shared_ptr<Connection> conn);
+
+    /// Joins the reader threads that have returned, or all of them with `all`.
+    void joinReaders(bool all);
+    void workerLoop();
+    Response answer(Job& job);
+    Response solve(const Job& job, const InstanceView& view, const vector<ll>* targets);
+
+    /// The kernel entry of the coins of `ri`, created (and the least recently used evicted) if it is not in memory.
+    shared_ptr<KernelEntry> kernel(const ReducedInstance& ri);
+
+    bool expired(const Job& job) const;
+
+    Options options;
+    unique_ptr<KernelCache> diskCache;
+    int listenFd;
+    atomic<bool> stopping;
+
+    mutex queueLock;
+    condition_variable queueReady;
+    deque<Job> queue;
+    bool draining;                      ///< no more jobs will come; workers exit once the queue is empty
+
+    mutex connLock;                     ///< guards connections, readerThreads and finishedReaders
+    vector<weak_ptr<Connection>> connections;
+    unordered_map<thread::id, thread> readerThreads;
+    vector<thread::id> finishedReaders; ///< readers that returned and can be joined without blocking
+
+    mutex kernelLock;                   ///< guards kernels and lru
+    list<unsigned long long> lru;       ///< fingerprints, most recently used first
+    unordered_map<unsigned long long, pair<shared_ptr<KernelEntry>, list<unsigned long long>::iterator>> kernels;
+
+    atomic<ll> requests, failed, late, kernelHits, kernelBuilds, diskHits;
+};
+
+#endif // SERVER_H
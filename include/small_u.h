@@ -0,0 +1,37 @@
+#ifndef SMALL_U_H
+#define SMALL_U_H
+
+#include "constants.h"
+#include "dp_structs.h"
+#include "coin_set.h"
+
+/**
+ * Bit-parallel engine for All-Target CoinChange with small weights.
+ *
+ * For u < 64·W the coin indicator f is W machine words. The kernel iterations become shift-ORs of f by
+ * every frontier capacity, and the ordered minimum witnesses become shifted ANDs of the frontier with the
+ * capacities still missing one, coin by coin in the lex order. The engine is instantiated for
+ * W = 1..SMALL_U_MAX_WORDS; no FFT is involved.
+ */
+const int SMALL_U_MAX_WORDS = 8;
+const int SMALL_U_MAX = 64 * SMALL_U_MAX_WORDS - 1;
+
+/// Can the bit-parallel engine handle the coin set (u ≤ SMALL_U_MAX)?
+bool smallUSupported(const CoinSet& cs);
+
+/// Same kernel (identical solutions) as kernelComputation_coinchange_simple(), which it falls back to for
+/// u > SMALL_U_MAX.
+void kernelComputation_coinchange_smallU(const CoinSet& cs, int t, vector<solution>& sol);
+
+/**
+ * Minimum number of coins for every c ∈ [0..t], or -1 if c is unreachable. For u > SMALL_U_MAX it falls back to
+ * the simplified kernel and propagationStreamed().
+ *
+ * Algorithm 1 on values only: every target keeps its coin count and, as a W-word mask over the distinct
+ * weights, the union of the supports of all optimal candidates that reached it. That union contains the
+ * support of the solution Algorithm 1 would keep, so propagating along its bits finds the same counts
+ * without building or comparing multisets. Only the masks of the next u targets are kept.
+ */
+vector<ll> coinChangeSmallU(const CoinSet& cs, int t);
+
+#endif // SMALL_U_H
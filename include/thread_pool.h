@@ -0,0 +1,58 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "constants.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * Work-stealing thread pool.
+ * Every worker owns a deque: it pops its own tasks from the front and steals from the back of the others.
+ * A thread waiting in parallelFor() keeps executing queued tasks, so nested parallelFor() calls cannot deadlock,
+ * and blocks only once there is nothing left to steal.
+ */
+class ThreadPool {
+public:
+    /// Starts `threads` - 1 workers; the thread calling parallelFor() is the last one.
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    /// Number of threads that execute tasks, including the caller of parallelFor().
+    int size() const;
+
+    /// Runs fn(i) for every i in [begin, end) and returns once all of them finished. If fn throws, the other
+    /// indices still run and the first exception is rethrown to the caller.
+    void parallelFor(int begin, int end, const function<void(int)>& fn);
+
+private:
+    struct Worker {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    void workerLoop(int id);
+    bool runOne(int id); ///< runs one queued task (own queue first, then stealing); false if none was found
+
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+    mutex sleepLock;
+    condition_variable wake;            ///< workers: a task was queued, or stopping
+    condition_variable idle;            ///< callers of parallelFor(): a task was queued, or a call finished
+    atomic<int> queued;
+    atomic<unsigned> nextQueue;
+    bool stopping;
+};
+
+/// The process-wide pool, sized by FASTKNAPSACK_THREADS or the hardware concurrency.
+ThreadPool& sharedThreadPool();
+
+/// Seed of an independent RNG stream, e.g. streamSeed(base, round, row) is the same for any thread count.
+unsigned streamSeed(unsigned base, unsigned a, unsigned b);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "constants.h"
+#include <atomic>
+#include <string>
+
+/**
+ * Structured phase tracing in the Chrome trace format (chrome://tracing, Perfetto).
+ *
+ * Unlike include/instrument.h the trace is switched at run time: a TraceScope outside of traceStart() / traceStop()
+ * costs one relaxed load. While recording, every scope becomes a complete ("X") event on the track of the thread
+ * that ran it, buffered per thread, with up to two integer arguments. Where perf_event_open is permitted, each event
+ * also carries the cycles, instructions and cache misses of its thread during the scope; a counter read is a system
+ * call, so only scopes of at least a few microseconds (convolutions, rounds, blocks) are traced.
+ */
+
+extern atomic<bool> traceActive;
+
+/// Is a trace being recorded?
+inline bool traceEnabled() {
+    return traceActive.load(memory_order_relaxed);
+}
+
+/// Drops any earlier events and starts recording; `counters` = false skips the hardware counters.
+void traceStart(bool counters = true);
+
+/// Stops recording and writes every event to `path` as Chrome trace JSON; false if the file cannot be written.
+bool traceStop(const string& path);
+
+/// Were hardware counters available on the threads traced so far?
+bool traceHasCounters();
+
+/// One traced scope; `name` and the argument keys must be string literals (they are stored as pointers).
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* cat = "phase",
+                        const char* key1 = nullptr, ll value1 = 0,
+                        const char* key2 = nullptr, ll value2 = 0)
+      : active(traceEnabled())
+    {
+        if (active) begin(name, cat, key1, value1, key2, value2);
+    }
+    ~TraceScope() {
+        if (active) end();
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    void begin(const char* name, const char* cat, const char* key1, ll value1, const char* key2, ll value2);
+    void end();
+
+    bool active;
+    int event;           ///< index into the thread's event buffer
+    ll counters[3];      ///< hardware counters at the start of the scope
+};
+
+#define FK_TRACE_CONCAT_(a, b) a##b
+#define FK_TRACE_CONCAT(a, b) FK_TRACE_CONCAT_(a, b)
+
+/// Traces the rest of the enclosing scope: FK_TRACE(name[, cat[, key1, value1[, key2, value2]]]).
+#define FK_TRACE(...) TraceScope FK_TRACE_CONCAT(fk_trace_, __LINE__)(__VA_ARGS__)
+
+#endif // TRACE_H
@@ -3,6 +3,7 @@
 
 #include "constants.h"
 #include "convolution.h"
+#include "coin_set.h"
 //algorithms related to witnesses in boolean convolutions
 
 /**
@@ -12,15 +13,30 @@
  */
 vector<int> minimum_witness_boolCnv_ordered(vector<int>& a, vector<int>& b, const vector<int>& w, vector<int>& order);
 
+/**
+ * The overloads taking a CoinSet return order indices of `cs` and read a as an indicator of coin weights
+ * (every x with a[x] != 0 must be the weight of some coin); weights are mapped to order indices through the
+ * dense tables of `cs`, so nothing is rebuilt per call
+ */
+vector<int> minimum_witness_boolCnv_ordered(vector<int>& a, vector<int>& b, const CoinSet& cs);
+
 /**
  * Uniformly samples a witness for each result element, in expected O(n log^2 n) time
  */
-vector<int> randomized_witness_sampling(vector<int>& a, vector<int>& b);
+vector<int> randomized_witness_sampling(span<const int> a, span<const int> b);
 
 /**
  * Finds the minimum witness with respect to a random order in expected O~(n) time.
  */
 vector<int> minimum_witness_random(vector<int>& a, vector<int>& b, const vector<int>& w, vector<int>& order);
+vector<int> minimum_witness_random(vector<int>& a, vector<int>& b, const CoinSet& cs);
 
+/**
+ * Finds min(k, #witnesses) witnesses (as order indices) for each result element
+ * The overload with `wanted` only resolves the result elements i with wanted[i] != 0, using the RNG stream `seed`
+ * Scratch vectors of all witness functions come from the thread's arena (arena.h); only the results are std vectors
+ */
 vector<vector<int>> randomized_k_witness(vector<int>& a, vector<int>& b, int k, const vector<int>& w, vector<int>& order);
+vector<vector<int>> randomized_k_witness(vector<int>& a, vector<int>& b, int k, const vector<int>& w, vector<int>& order, const vector<int>& wanted, unsigned seed);
+vector<vector<int>> randomized_k_witness(span<const int> a, span<const int> b, int k, const CoinSet& cs, span<const int> wanted, unsigned seed);
 #endif
\ No newline at end of file
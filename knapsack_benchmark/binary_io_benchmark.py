@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Compares the text and the binary I/O of knapsack_solver on the same instances:
+text instance on stdin + text results on stdout versus a binary instance (--input) + binary results (--output).
+The results of both runs must agree; the table shows the wall time of each run.
+"""
+import os
+import random
+import struct
+import subprocess
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+SOLVER = os.path.join(SCRIPT_DIR, "knapsack_solver_io")
+
+N = 200
+U = 1000
+TS = [1 << 16, 1 << 18, 1 << 20, 1 << 22]
+
+def compile_solver():
+    deps = [os.path.join(SCRIPT_DIR, "..", "src", f) for f in
+            ("convolution.cpp", "arena.cpp", "memory_budget.cpp", "trace.cpp", "witness.cpp", "coin_set.cpp", "preprocess.cpp", "periodic.cpp", "query.cpp",
+             "instance_io.cpp", "kernel_cache.cpp", "small_u.cpp", "classical.cpp", "dispatch.cpp", "hitting_set.cpp", "dp_structs.cpp", "algorithms.cpp",
+             "thread_pool.cpp")]
+    subprocess.run([
+        "g++-14", "-std=c++20", "-O2",
+        "-I", os.path.join(SCRIPT_DIR, "..", "include"),
+        *deps,
+        os.path.join(SCRIPT_DIR, "knapsack.cpp"),
+        "-pthread",
+        "-o", SOLVER
+    ], check=True)
+
+def write_text_instance(path, t, w, p):
+    with open(path, "w") as f:
+        f.write(f"{len(w)} {U} {t}\n")
+        f.writelines(f"{wi} {pi}\n" for wi, pi in zip(w, p))
+
+def write_binary_instance(path, t, w, p):
+    # see include/instance_io.h
+    with open(path, "wb") as f:
+        f.write(b"FKIN" + struct.pack("<Iiiq", 1, len(w), U, t))
+        f.write(struct.pack(f"<{len(w)}i", *w))
+        f.write(struct.pack(f"<{len(p)}i", *p))
+
+def read_binary_results(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    assert data[:4] == b"FKRS"
+    _, count = struct.unpack_from("<Iq", data, 4)
+    return list(struct.unpack_from(f"<{count}q", data, 16))
+
+def run(args, stdin_path=None):
+    start = time.perf_counter()
+    with open(stdin_path or os.devnull) as fin:
+        proc = subprocess.run([SOLVER, *args], stdin=fin, capture_output=True, text=True, check=True)
+    return time.perf_counter() - start, proc.stdout
+
+def main():
+    compile_solver()
+    print(f"{'t':>9} | {'text (s)':>9} | {'binary (s)':>10} | same")
+    print("-" * 42)
+    with tempfile.TemporaryDirectory() as tmp:
+        txt = os.path.join(tmp, "instance.txt")
+        binp = os.path.join(tmp, "instance.bin")
+        res = os.path.join(tmp, "results.bin")
+        for t in TS:
+            w = random.sample(range(1, U + 1), N)
+            p = [random.randint(1, U) for _ in range(N)]
+            write_text_instance(txt, t, w, p)
+            write_binary_instance(binp, t, w, p)
+            text_time, out = run([], txt)
+            bin_time, _ = run(["--input", binp, "--output", res])
+            same = [int(x) for x in out.split()] == read_binary_results(res)
+            print(f"{t:9d} | {text_time:9.3f} | {bin_time:10.3f} | {same}")
+
+if __name__ == "__main__":
+    main()
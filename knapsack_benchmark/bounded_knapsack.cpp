@@ -0,0 +1,51 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include "bounded.h"
+using namespace std;
+
+int main(int argc, char** argv){
+    // --counts: also print the optimal copies of every item after each value
+    bool withCounts = argc > 1 && strcmp(argv[1], "--counts") == 0;
+
+    int n, u, t;
+    // read number of items, max weight per item, and max target weight
+    if(!(cin >> n >> u >> t)) return 0;
+
+    // 1-indexed arrays: weight, profit and maximum copies (negative = unlimited)
+    vector<int> w(n+1), p(n+1), cap(n+1);
+    for(int i = 1; i <= n; i++){
+        cin >> w[i] >> p[i] >> cap[i];
+    }
+
+    BoundedKnapsack bk;
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        solveBoundedKnapsack(n, w, p, cap, t, withCounts, bk);
+        auto t1 = chrono::high_resolution_clock::now();
+        double secs = chrono::duration<double>(t1 - t0).count();
+        cerr << "Bounded knapsack took " << secs << " s\n";
+    }
+    if(withCounts && !bk.decisionsKept()){
+        cerr << "The decisions do not fit the memory budget (FASTKNAPSACK_MEMORY), printing the values only\n";
+        withCounts = false;
+    }
+
+    // best profit for each c in [0..t], optionally followed by " item:copies" pairs
+    for(int c = 0; c <= t; c++){
+        if(bk.value[c] == NEG_INF) {
+            cout << -1000000000 << "\n";
+            continue;
+        }
+        cout << bk.value[c];
+        if(withCounts){
+            vector<ll> cnt = bk.counts(c);
+            for(int i = 1; i <= n; i++){
+                if(cnt[i] > 0) cout << " " << i << ":" << cnt[i];
+            }
+        }
+        cout << "\n";
+    }
+    return 0;
+}
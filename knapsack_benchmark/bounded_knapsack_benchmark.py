@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+import os
+import subprocess
+import random
+import matplotlib.pyplot as plt
+
+# --- directory setup -----------------------------------------
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+SOLVER     = os.path.join(SCRIPT_DIR, "bounded_knapsack_solver")
+TRAD       = os.path.join(SCRIPT_DIR, "bounded_knapsack_traditional")
+# --------------------------------------------------------------
+
+# List of target values to test
+Ts = [2**i for i in range(10, 21)]
+
+# Problem size parameters
+n = 1000     # number of item types
+u = 1000     # maximum item weight/value
+MAX_CAP = 31 # caps are drawn from [1, MAX_CAP], or unlimited
+
+def compile_solvers():
+    deps = [os.path.join(SCRIPT_DIR, "..", "src", f) for f in
+            ("convolution.cpp", "arena.cpp", "memory_budget.cpp", "trace.cpp", "witness.cpp", "coin_set.cpp", "hitting_set.cpp", "dp_structs.cpp",
+             "algorithms.cpp", "thread_pool.cpp", "preprocess.cpp", "classical.cpp", "small_u.cpp", "dispatch.cpp",
+             "bounded.cpp")]
+    subprocess.run([
+        "g++-14", "-std=c++20", "-O2",
+        "-I", os.path.join(SCRIPT_DIR, "..", "include"),
+        *deps,
+        os.path.join(SCRIPT_DIR, "bounded_knapsack.cpp"),
+        "-pthread",
+        "-o", SOLVER
+    ], check=True)
+    # classic O(n·t) bounded DP
+    subprocess.run([
+        "g++-14", "-std=c++20", "-O2",
+        os.path.join(SCRIPT_DIR, "traditional_bounded_knapsack.cpp"),
+        "-o", TRAD
+    ], check=True)
+
+def build_input(T):
+    weights = random.sample(range(1, u+1), n)
+    lines = [f"{n} {u} {T}\n"]
+    for w in weights:
+        cap = random.choice([-1] + list(range(1, MAX_CAP + 1)))
+        lines.append(f"{w} {random.randint(1, u)} {cap}\n")
+    return "".join(lines)
+
+def solve_time(stderr: str):
+    for line in stderr.splitlines():
+        if line.startswith("Bounded knapsack took"):
+            return float(line.split()[3])
+    return None
+
+def run_benchmark():
+    print("     T     |  Folds(s)   DP(s)   OK?")
+    print("-----------+------------------------")
+    fast_times, trad_times = [], []
+    for T in Ts:
+        inp = build_input(T)
+        fast = subprocess.run([SOLVER], input=inp, text=True, capture_output=True, check=True)
+        trad = subprocess.run([TRAD], input=inp, text=True, capture_output=True, check=True)
+        ok = fast.stdout == trad.stdout
+        t_fast, t_trad = solve_time(fast.stderr), solve_time(trad.stderr)
+        print(f"{T:10d} | {t_fast:9.4f} {t_trad:8.4f}   {'Y' if ok else 'N'}")
+        fast_times.append(t_fast)
+        trad_times.append(t_trad)
+
+    plt.figure()
+    plt.plot(Ts, fast_times, marker='o')
+    plt.plot(Ts, trad_times, marker='o')
+    plt.xscale('log', base=2)
+    plt.yscale('log')
+    plt.xlabel(f"T (n = u = {n}, caps <= {MAX_CAP})")
+    plt.ylabel("Time (s)")
+    plt.legend(["Kernel + monotone-queue folds", "Monotone-queue DP"])
+    plt.title("All-target bounded knapsack")
+    plt.tight_layout()
+    plt.show()
+
+if __name__ == "__main__":
+    random.seed(0)
+    compile_solvers()
+    run_benchmark()
@@ -3,39 +3,155 @@
 #include <chrono>
 #include <algorithm>
 #include <utility>
+#include <cstring>
+#include <memory>
 #include "algorithms.h"
 #include "dp_structs.h"
+#include "preprocess.h"
+#include "query.h"
+#include "periodic.h"
+#include "trace.h"
+#include "instance_io.h"
+#include "kernel_cache.h"
+#include "arena.h"
+#include "dispatch.h"
 using namespace std;
 
-int main(){
-    int n, u, t;
-    // read number of item types, max weight per item, and max target weight
-    if(!(cin >> n >> u >> t)) return 0;
+// storeResults(), reporting a failed write here so that other failures keep their own message
+static int writeResults(const string& output, const vector<ll>& values){
+    if(storeResults(output, values)) return 0;
+    cerr << "cannot write the results to " << (output.empty() ? "stdout" : output) << "\n";
+    return 1;
+}
+
+// --queries: read q and q targets from stdin (after the coins if the instance comes from stdin too),
+// and answer only those (t is ignored)
+static int answerQueries(int n, int u, const vector<int>& w, const vector<int>& p, const vector<int>& order,
+                         const string& output, const KernelCache* cache){
+    int q;
+    if(!(cin >> q)) return 0;
+    vector<ll> targets(q);
+    for(ll& x : targets) cin >> x;
+
+    auto t0 = chrono::high_resolution_clock::now();
+    ReducedInstance ri;
+    {
+        FK_TRACE("preprocess");
+        reduceInstance(n, u, w, p, order, ri);
+    }
+    // targets that are not multiples of the gcd are unreachable
+    vector<ll> reduced;
+    for(ll x : targets) reduced.push_back(ri.target(x));
+    if(!TargetQuery::answerable(ri.coins(), reduced)){
+        cerr << "Some targets land beyond " << PERIODIC_MAX_BASE << " (the periodic threshold of the best-ratio coin"
+             << " is too large for this instance); use the dense mode or smaller targets\n";
+        return 1;
+    }
+    TargetQuery tq(ri.coins(), cache);
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Kernel computation took " << chrono::duration<double>(t1 - t0).count() << " s"
+         << (tq.cachedKernel() ? " (cached)" : "") << "\n";
+
+    vector<ll> values;
+    {
+        FK_TRACE("queries", "phase", "q", q);
+        values = tq.values(reduced);
+    }
+    auto t2 = chrono::high_resolution_clock::now();
+    cerr << "Queries took " << chrono::duration<double>(t2 - t1).count() << " s (propagated up to "
+         << tq.propagated() << ")\n";
+    cerr << "Total elapsed time: " << chrono::duration<double>(t2 - t0).count() << " s\n";
+
+    for(ll& v : values){
+        if(v == NEG_INF) v = -1000000000;
+    }
+    return writeResults(output, values);
+}
+
+// Algorithm 2 alone, then Algorithm 1 through a window of u + 1 solutions (propagationStreamed()), for
+// instances whose table of all t + 1 solutions would not fit the memory budget
+static int streamAll(const ReducedInstance& ri, int t, const string& output, const KernelCache* cache,
+                     chrono::high_resolution_clock::time_point total_start){
+    CoinSet cs = ri.coins();
+    int rt = static_cast<int>(t / ri.g);
+    vector<solution> kernel;
+    {
+        FK_TRACE("kernel", "phase", "n", cs.n, "u", cs.u);
+        auto t0 = chrono::high_resolution_clock::now();
+        bool cached = computeKernel(KernelKind::Knapsack, cs, 0, kernel, cache);
+        auto t1 = chrono::high_resolution_clock::now();
+        cerr << "Kernel computation took " << chrono::duration<double>(t1 - t0).count() << " s"
+             << (cached ? " (cached)" : "") << "\n";
+    }
+
+    vector<ll> reduced(rt + 1, -1000000000), values(t + 1);
+    MemoryCharge held(MemSubsystem::Solutions, (reduced.size() + values.size()) * sizeof(ll));
+    {
+        FK_TRACE("propagation", "phase", "t", rt);
+        auto t0 = chrono::high_resolution_clock::now();
+        propagationStreamed(cs, rt, kernel, [&](int c, const solution& s){
+            if(c == 0 || s.size != 0) reduced[c] = s.value;
+        });
+        auto t1 = chrono::high_resolution_clock::now();
+        cerr << "Streamed witness propagation took " << chrono::duration<double>(t1 - t0).count() << " s\n";
+    }
+    auto total_end = chrono::high_resolution_clock::now();
+    cerr << "Total elapsed time: " << chrono::duration<double>(total_end - total_start).count() << " s\n";
 
+    for(int c = 0; c <= t; c++){
+        ll rc = ri.target(c);
+        values[c] = rc < 0 ? -1000000000 : reduced[rc];
+    }
+    return writeResults(output, values);
+}
+
+// Algorithms 2 + 1 on the reduced instance, then best profit for every c in [0..t]
+static int solveAll(int n, int u, int t, const vector<int>& w, const vector<int>& p, const vector<int>& order,
+                    const string& output, const KernelCache* cache){
     // record overall start
     auto total_start = chrono::high_resolution_clock::now();
 
-    // 1-indexed arrays
-    vector<int> w(n+1), p(n+1), order(n+1);
-    for(int i = 1; i <= n; i++){
-        cin >> w[i] >> p[i];
-        order[i] = i;                // identity lex order
+    // 0) Drop dominated / duplicate coins and divide the weights by their gcd
+    ReducedInstance ri;
+    {
+        FK_TRACE("preprocess", "phase", "n", n, "u", u);
+        auto t0 = chrono::high_resolution_clock::now();
+        reduceInstance(n, u, w, p, order, ri);
+        auto t1 = chrono::high_resolution_clock::now();
+        double secs = chrono::duration<double>(t1 - t0).count();
+        cerr << "Preprocessing took " << secs << " s (n " << n << " -> " << ri.n
+             << ", u " << u << " -> " << ri.u << ", gcd " << ri.g << ")\n";
+    }
+    CoinSet cs = ri.coins();          // shared by the kernel and the propagation
+    int rt = static_cast<int>(t / ri.g); // largest reduced target
+
+    // pre-flight memory estimate; past the budget the targets are streamed instead of held in one table
+    InstanceStats st = instanceStats(ri, t);
+    cerr << "Estimated peak memory: ";
+    printEstimate(cerr, estimateMemory(Strategy::Kernel, st));
+    cerr << "\n";
+    if(streamsTargets(Strategy::Kernel, st)){
+        cerr << "Over the memory budget of " << formatBytes(memoryBudget()) << ", streaming the targets: ";
+        printEstimate(cerr, estimateMemory(Strategy::Kernel, st, true));
+        cerr << "\n";
+        return streamAll(ri, t, output, cache, total_start);
     }
 
     // 1) Kernel computation (Alg.2)
     vector<solution> sol;           // will hold sol[0..max(k·u, t)]
     {
+        FK_TRACE("kernel", "phase", "n", cs.n, "u", cs.u);
         auto t0 = chrono::high_resolution_clock::now();
-        kernelComputation_knapsack(n, u, w, p, order, t, sol);
+        bool cached = computeKernel(KernelKind::Knapsack, cs, rt, sol, cache);
         auto t1 = chrono::high_resolution_clock::now();
         double secs = chrono::duration<double>(t1 - t0).count();
-        cerr << "Kernel computation took " << secs << " s\n";
+        cerr << "Kernel computation took " << secs << " s" << (cached ? " (cached)" : "") << "\n";
     }
 
     // compute max support size over the kernels
     int maxSize = 0;
     int maxInd = -1;
-    for (int i = 0; i <= t && i < (int)sol.size(); i++) {
+    for (int i = 0; i <= rt && i < (int)sol.size(); i++) {
         maxSize = max(maxSize, static_cast<int>(sol[i].svec.size()));
         maxInd = i;
     }
@@ -52,12 +168,14 @@ int main(){
 
     // 2) Witness‐propagation (Alg.1)
     {
+        FK_TRACE("propagation", "phase", "t", rt);
         auto t0 = chrono::high_resolution_clock::now();
-        propagation(w, p, t, sol, order);
+        propagation(cs, rt, sol);
         auto t1 = chrono::high_resolution_clock::now();
         double secs = chrono::duration<double>(t1 - t0).count();
         cerr << "Witness propagation took " << secs << " s\n";
     }
+    MemoryCharge table(MemSubsystem::Solutions, solutionTableBytes(sol, 0, (int)sol.size() - 1));
 
     // record and print total time
     {
@@ -67,14 +185,83 @@ int main(){
     }
 
     // 3) Output results: best profit for each c in [0..t]
-    //    Only these go to stdout.
+    //    Only these go to stdout, or to the --output file. Targets that are not multiples of the gcd are unreachable.
+    FK_TRACE("output", "phase", "t", t);
+    vector<ll> values(t + 1);
+    table.set(table.held() + values.size() * sizeof(ll));
     for(int cval = 0; cval <= t; cval++){
-        if(sol[cval].size == 0 && cval != 0) {
-            cout << -1000000000 << "\n";
+        ll rc = ri.target(cval);
+        if(rc < 0 || (sol[rc].size == 0 && rc != 0)) {
+            values[cval] = -1000000000;
         } else {
-            cout << sol[cval].value << "\n";
+            values[cval] = sol[rc].value;
         }
     }
+    return writeResults(output, values);
+}
 
-    return 0;
+// usage: knapsack_solver [--queries] [--input FILE] [--output FILE] [--kernel-cache DIR] [--trace FILE]
+//                        [--memory-budget SIZE]
+//   --input reads the instance from FILE, binary or text (see instance_io.h), instead of stdin
+//   --output writes the results to FILE in the binary result format instead of text lines to stdout
+//   --kernel-cache loads the kernel from DIR when an earlier run with the same coins stored it (see kernel_cache.h)
+//   --trace writes a Chrome trace (chrome://tracing, Perfetto) of every phase, kernel iteration, convolution,
+//   witness round and propagation block to FILE, with hardware counters where perf_event_open is permitted
+//   --memory-budget (or FASTKNAPSACK_MEMORY) caps the accounted memory, e.g. 512M or 2G (see memory_budget.h):
+//   convolutions and peeling tables are chunked and the targets streamed rather than exceeding it
+int main(int argc, char** argv){
+    bool queries = false;
+    const char* tracePath = nullptr;
+    string input, output, cacheDir;
+    size_t budget;
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--queries") == 0) queries = true;
+        else if(strcmp(argv[i], "--input") == 0 && i + 1 < argc) input = argv[++i];
+        else if(strcmp(argv[i], "--output") == 0 && i + 1 < argc) output = argv[++i];
+        else if(strcmp(argv[i], "--kernel-cache") == 0 && i + 1 < argc) cacheDir = argv[++i];
+        else if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else if(strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc && parseByteSize(argv[i + 1], budget)){
+            setMemoryBudget(budget);
+            i++;
+        }
+        else {
+            cerr << "usage: " << argv[0]
+                 << " [--queries] [--input FILE] [--output FILE] [--kernel-cache DIR] [--trace FILE]"
+                 << " [--memory-budget SIZE]\n";
+            return 2;
+        }
+    }
+    ios::sync_with_stdio(false);
+
+    // number of item types, max weight per item, max target weight and the 1-indexed coins
+    Instance inst;
+    if(!loadInstance(input, inst)){
+        if(!input.empty()) cerr << "cannot read the instance " << input << "\n";
+        return input.empty() ? 0 : 1;
+    }
+    if(inst.t > INT_MAX - 1){
+        cerr << "t = " << inst.t << " is too large\n";
+        return 1;
+    }
+    int n = inst.n, u = inst.u, t = (int)inst.t;
+    vector<int> order(n+1);
+    for(int i = 1; i <= n; i++) order[i] = i; // identity lex order
+
+    unique_ptr<KernelCache> cache;
+    if(!cacheDir.empty()) cache = make_unique<KernelCache>(cacheDir);
+
+    if(tracePath) traceStart();
+    int status = queries ? answerQueries(n, u, inst.w, inst.p, order, output, cache.get())
+                         : solveAll(n, u, t, inst.w, inst.p, order, output, cache.get());
+    arenaReport(cerr);
+    memoryReport(cerr);
+    if(tracePath){
+        if(!traceStop(tracePath)){
+            cerr << "cannot write the trace to " << tracePath << "\n";
+            return 1;
+        }
+        cerr << "Trace written to " << tracePath
+             << (traceHasCounters() ? "" : " (hardware counters unavailable)") << "\n";
+    }
+    return status;
 }
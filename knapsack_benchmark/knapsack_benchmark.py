@@ -26,11 +26,25 @@ def compile_solvers():
         "g++-14", "-std=c++20", "-O2",
         "-I", os.path.join(SCRIPT_DIR, "..", "include"),
         os.path.join(SCRIPT_DIR, "..", "src", "convolution.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "arena.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "memory_budget.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "trace.cpp"),
         os.path.join(SCRIPT_DIR, "..", "src", "witness.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "coin_set.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "preprocess.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "periodic.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "query.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "instance_io.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "kernel_cache.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "small_u.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "classical.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "dispatch.cpp"),
         os.path.join(SCRIPT_DIR, "..", "src", "hitting_set.cpp"),
         os.path.join(SCRIPT_DIR, "..", "src", "dp_structs.cpp"),
         os.path.join(SCRIPT_DIR, "..", "src", "algorithms.cpp"),
+        os.path.join(SCRIPT_DIR, "..", "src", "thread_pool.cpp"),
         os.path.join(SCRIPT_DIR, "knapsack.cpp"),
+        "-pthread",
         "-o", os.path.join(SCRIPT_DIR, "knapsack_solver")
     ], check=True)
     # classic DP solver
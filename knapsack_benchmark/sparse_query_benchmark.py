@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+import os
+import subprocess
+import time
+import random
+
+# --- directory setup -----------------------------------------
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+SOLVER     = os.path.join(SCRIPT_DIR, "knapsack_solver")
+# --------------------------------------------------------------
+
+# Problem size parameters
+n = 1000        # number of coin types
+T = 10**7       # targets are drawn from [0, T]
+Us = [100, 300, 1000, 3000]
+Qs = [10, 100, 1000]
+
+def compile_solver():
+    deps = [os.path.join(SCRIPT_DIR, "..", "src", f) for f in
+            ("convolution.cpp", "arena.cpp", "memory_budget.cpp", "trace.cpp", "witness.cpp", "coin_set.cpp", "preprocess.cpp", "periodic.cpp", "query.cpp",
+             "instance_io.cpp", "kernel_cache.cpp", "small_u.cpp", "classical.cpp", "dispatch.cpp", "hitting_set.cpp", "dp_structs.cpp", "algorithms.cpp",
+             "thread_pool.cpp")]
+    subprocess.run([
+        "g++-14", "-std=c++20", "-O2",
+        "-I", os.path.join(SCRIPT_DIR, "..", "include"),
+        *deps,
+        os.path.join(SCRIPT_DIR, "knapsack.cpp"),
+        "-pthread",
+        "-o", SOLVER
+    ], check=True)
+
+def run(args, inp):
+    t0 = time.time()
+    res = subprocess.run([SOLVER] + args, input=inp, text=True, capture_output=True, check=True)
+    return res.stdout.split("\n"), time.time() - t0
+
+def run_benchmark():
+    print("    u       q | dense(s)  queries(s)  OK?")
+    print("--------------+---------------------------")
+    for u in Us:
+        coins = "".join(f"{random.randint(1, u)} {random.randint(1, 1000)}\n" for _ in range(n))
+        dense, t_dense = run([], f"{n} {u} {T}\n" + coins)
+        for q in Qs:
+            targets = [random.randint(0, T) for _ in range(q)]
+            inp = f"{n} {u} 0\n" + coins + f"{q}\n" + "\n".join(map(str, targets)) + "\n"
+            answers, t_sparse = run(["--queries"], inp)
+            ok = all(dense[x] == a for x, a in zip(targets, answers))
+            print(f"{u:5d} {q:7d} | {t_dense:8.3f} {t_sparse:10.3f}   {'Y' if ok else 'N'}")
+
+def check_large_period():
+    # w_b·u beyond INT_MAX: the landing point of a target in the billions used to wrap and crash the solver
+    inp = "2 60000 3\n60000 70000\n1 1\n1\n5000000000\n"
+    res = subprocess.run([SOLVER, "--queries"], input=inp, text=True, capture_output=True)
+    ok = res.returncode == 0 and res.stdout.split() == ["5833330000"]
+    print(f"large period, small threshold: {'Y' if ok else 'N'} (rc {res.returncode})")
+    # coprime weights: the base of the period would be ~3.6e9 targets, so the query is rejected cleanly
+    inp = "2 60000 3\n60000 70000\n59999 1\n1\n5000000000\n"
+    res = subprocess.run([SOLVER, "--queries"], input=inp, text=True, capture_output=True)
+    ok = res.returncode == 1 and res.stdout == ""
+    print(f"large period, rejected:        {'Y' if ok else 'N'} (rc {res.returncode})")
+
+if __name__ == "__main__":
+    random.seed(0)
+    compile_solver()
+    check_large_period()
+    run_benchmark()
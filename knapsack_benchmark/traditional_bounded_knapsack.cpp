@@ -0,0 +1,50 @@
+// traditional_bounded_knapsack.cpp
+#include <bits/stdc++.h>
+using namespace std;
+typedef long long ll;
+
+// classic O(n·t) bounded knapsack:
+// dp[c] = max profit with total weight exactly c, or -inf if impossible,
+// each item i used at most cap[i] times (negative = unlimited).
+// For every residue r mod w_i, dp_new[r + k·w] = max over k - m ≤ j ≤ k of dp[r + j·w] + (k - j)·p,
+// evaluated with a monotone deque over j of dp[r + j·w] - j·p.
+int main(){
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    int n,u,t;
+    if(!(cin>>n>>u>>t)) return 0;
+    vector<int> w(n+1), p(n+1), cap(n+1);
+    for(int i=1;i<=n;i++){
+        cin>>w[i]>>p[i]>>cap[i];
+    }
+    const ll NEG_INF = -1000000000;
+    auto t0 = chrono::high_resolution_clock::now();
+    vector<ll> dp(t+1, NEG_INF), nxt(t+1);
+    dp[0] = 0;
+    vector<pair<int,ll>> dq(t+1); // (j, dp[r + j·w] - j·p)
+    for(int i=1;i<=n;i++){
+        if(w[i] > t || cap[i] == 0) continue;
+        ll m = cap[i] < 0 ? t / w[i] : cap[i];
+        for(int r=0;r<w[i];r++){
+            int head = 0, tail = 0;
+            for(int k=0, c=r; c<=t; k++, c+=w[i]){
+                if(dp[c] > NEG_INF){
+                    ll key = dp[c] - (ll)k * p[i];
+                    while(tail > head && dq[tail-1].second <= key) tail--;
+                    dq[tail++] = {k, key};
+                }
+                while(tail > head && dq[head].first < k - m) head++;
+                nxt[c] = tail > head ? dq[head].second + (ll)k * p[i] : NEG_INF;
+            }
+        }
+        swap(dp, nxt);
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Bounded knapsack took " << chrono::duration<double>(t1 - t0).count() << " s\n";
+
+    for(int c=0;c<=t;c++){
+        cout<<dp[c]<<"\n";
+    }
+    return 0;
+}
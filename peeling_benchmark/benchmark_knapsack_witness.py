@@ -57,8 +57,14 @@ def compile_solver():
         os.path.join(BASE, 'knapsack_k_witness_solver.cpp'),
         # library implementations
         os.path.join(SRC_DIR, 'convolution.cpp'),
+        os.path.join(SRC_DIR, 'arena.cpp'),
+        os.path.join(SRC_DIR, 'memory_budget.cpp'),
+        os.path.join(SRC_DIR, 'trace.cpp'),
+        os.path.join(SRC_DIR, 'thread_pool.cpp'),
         os.path.join(SRC_DIR, 'witness.cpp'),
+        os.path.join(SRC_DIR, 'coin_set.cpp'),
         os.path.join(SRC_DIR, 'peeling.cpp'),
+        '-pthread',
         '-o', os.path.join(BASE, 'knapsack_k_witness_bench')
     ], check=True)
 
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+import os
+import subprocess
+import random
+import matplotlib.pyplot as plt
+
+# --- paths ----------------------------------------
+SCRIPT   = os.path.dirname(os.path.abspath(__file__))
+INCLUDE  = os.path.join(SCRIPT, '..', 'include')
+DIJKSTRA = os.path.join(SCRIPT, 'residue_dijkstra')
+KERNEL   = os.path.join(SCRIPT, 'residue_solver')
+# --------------------------------------------------
+
+# Benchmark parameters: n = u/4 coins with weights in [u/2, u], so w_min ~ u/2
+Us = [2**i for i in range(8, 17)]
+
+def compile_solvers():
+    subprocess.run([
+        'g++-14','-std=c++20','-O2',
+        'residue_dijkstra.cpp',
+        '-o', DIJKSTRA
+    ], cwd=SCRIPT, check=True)
+
+    deps = [os.path.join('..','src',f) for f in
+            ('algorithms.cpp','dp_structs.cpp','witness.cpp','convolution.cpp','arena.cpp','memory_budget.cpp','trace.cpp','hitting_set.cpp','peeling.cpp','thread_pool.cpp','coin_set.cpp')]
+    subprocess.run([
+        'g++-14','-std=c++20','-O2',
+        '-I', INCLUDE,
+        'residue_solver.cpp', *deps, '-pthread',
+        '-o', KERNEL
+    ], cwd=SCRIPT, check=True)
+
+def build_input(u):
+    n = max(1, u // 4)
+    weights = random.sample(range(u // 2, u + 1), n)
+    return f"{n} {u}\n" + "\n".join(map(str, weights)) + "\n"
+
+def table_time(stderr: str):
+    for line in stderr.splitlines():
+        if line.startswith("Residue table took"):
+            return float(line.split()[3])
+    return None
+
+def run_benchmark():
+    print("     u    | Dijkstra(s) Kernel(s)  OK?")
+    print("----------+----------------------------")
+    dijkstra_times, kernel_times = [], []
+    for u in Us:
+        inp = build_input(u)
+        dij = subprocess.run([DIJKSTRA], input=inp, text=True, capture_output=True, check=True)
+        ker = subprocess.run([KERNEL], input=inp, text=True, capture_output=True, check=True)
+        # the kernel solver also prints the multiset, only the sums are compared
+        ok = dij.stdout.split("\n") == [line.split(" ")[0] for line in ker.stdout.split("\n")]
+        t_dij, t_ker = table_time(dij.stderr), table_time(ker.stderr)
+        print(f"{u:9d} | {t_dij:11.4f} {t_ker:9.4f}   {'Y' if ok else 'N'}")
+        dijkstra_times.append(t_dij)
+        kernel_times.append(t_ker)
+
+    plt.figure()
+    plt.plot(Us, dijkstra_times, marker='o')
+    plt.plot(Us, kernel_times, marker='o')
+    plt.xscale('log', base=2)
+    plt.yscale('log')
+    plt.xlabel("u (n = u/4, w_min ~ u/2)")
+    plt.ylabel("Time (s)")
+    plt.legend(["Dijkstra over residues", "Kernel + support propagation"])
+    plt.title("Residue Table")
+    plt.tight_layout()
+    plt.show()
+
+if __name__ == "__main__":
+    random.seed(0)
+    compile_solvers()
+    run_benchmark()
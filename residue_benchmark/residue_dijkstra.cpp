@@ -0,0 +1,40 @@
+// residue_dijkstra.cpp
+#include <bits/stdc++.h>
+using namespace std;
+
+int main(){
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    int n,u;
+    if(!(cin>>n>>u)) return 0;
+    vector<int> w(n);
+    for(int i=0;i<n;i++) cin>>w[i];
+
+    // Dijkstra over the residues modulo the smallest weight, along every coin
+    auto t0 = chrono::high_resolution_clock::now();
+    int m = *min_element(w.begin(), w.end());
+    const long long INF = LLONG_MAX;
+    vector<long long> dist(m, INF);
+    priority_queue<pair<long long,int>, vector<pair<long long,int>>, greater<>> pq;
+    dist[0] = 0;
+    pq.push({0, 0});
+    while(!pq.empty()){
+        auto [d, r] = pq.top(); pq.pop();
+        if(d != dist[r]) continue;
+        for(int x : w){
+            int nr = (int)((r + (long long)x) % m);
+            if(d + x < dist[nr]){
+                dist[nr] = d + x;
+                pq.push({dist[nr], nr});
+            }
+        }
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Residue table took " << chrono::duration<double>(t1 - t0).count() << " s\n";
+
+    for(int r=0;r<m;r++){
+        cout << (dist[r]==INF ? -1 : dist[r]) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "algorithms.h"
+#include "dp_structs.h"
+using namespace std;
+
+int main(){
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    int n, u;
+    if(!(cin >> n >> u)) return 0;
+
+    // Read coin weights (1-indexed) and set up identity order
+    vector<int> w(n+1), order(n+1);
+    for(int i = 1; i <= n; i++){
+        cin >> w[i];
+        order[i] = i;
+    }
+
+    auto t0 = chrono::high_resolution_clock::now();
+    CoinSet cs(n, u, w, {}, order);
+    vector<solution> res;
+    residueTable(cs, res);
+    auto t1 = chrono::high_resolution_clock::now();
+    cerr << "Residue table took " << chrono::duration<double>(t1 - t0).count() << " s\n";
+
+    // smallest sum for each residue modulo the smallest weight (-1 if unreachable), then its multiset
+    for(int r = 0; r < (int)res.size(); r++){
+        if(res[r].size == 0 && r != 0){
+            cout << -1 << "\n";
+            continue;
+        }
+        cout << res[r].weight;
+        for(auto &e : res[r].svec){
+            cout << " " << order[e.first] << "x" << e.second;
+        }
+        cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include "protocol.h"
+using namespace std;
+
+// One round trip; false (with a message) if the connection fails.
+static bool roundTrip(int fd, const Request& req, Response& res){
+    if(!writeRequest(fd, req) || !readResponse(fd, res) || res.id != req.id){
+        cerr << "lost the connection to the server\n";
+        return false;
+    }
+    return true;
+}
+
+// usage: knapsack_client [--socket PATH] [--queries] [--input FILE] [--output FILE] [--deadline-ms N] [--repeat N]
+//        knapsack_client [--socket PATH] --stats | --shutdown
+// Sends the instance (read like knapsack_solver does: --input FILE, or text on stdin) to knapsack_server and
+// prints the same results as knapsack_solver: every target 0..t, or with --queries the q targets that follow
+// on stdin. --repeat sends the request N times on one connection (the later ones find the kernel warm).
+int main(int argc, char** argv){
+    string socketPath = DEFAULT_SOCKET_PATH, input, output;
+    bool queries = false;
+    ll deadlineMs = 0;
+    int repeat = 1;
+    RequestType type = RequestType::Solve;
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--socket") == 0 && i + 1 < argc) socketPath = argv[++i];
+        else if(strcmp(argv[i], "--queries") == 0) queries = true;
+        else if(strcmp(argv[i], "--input") == 0 && i + 1 < argc) input = argv[++i];
+        else if(strcmp(argv[i], "--output") == 0 && i + 1 < argc) output = argv[++i];
+        else if(strcmp(argv[i], "--deadline-ms") == 0 && i + 1 < argc) deadlineMs = atoll(argv[++i]);
+        else if(strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else if(strcmp(argv[i], "--stats") == 0) type = RequestType::Stats;
+        else if(strcmp(argv[i], "--shutdown") == 0) type = RequestType::Shutdown;
+        else {
+            cerr << "usage: " << argv[0] << " [--socket PATH] [--queries] [--input FILE] [--output FILE]"
+                 << " [--deadline-ms N] [--repeat N] | --stats | --shutdown\n";
+            return 2;
+        }
+    }
+    ios::sync_with_stdio(false);
+    signal(SIGPIPE, SIG_IGN);
+
+    Request req;
+    req.type = type;
+    req.deadlineMicros = deadlineMs * 1000;
+    if(type == RequestType::Solve){
+        Instance inst;
+        if(!loadInstance(input, inst)){
+            if(!input.empty()) cerr << "cannot read the instance " << input << "\n";
+            return input.empty() ? 0 : 1;
+        }
+        if(queries){
+            int q;
+            if(!(cin >> q)) return 0;
+            vector<ll> targets(q);
+            for(ll& x : targets) cin >> x;
+            req.type = RequestType::Query;
+            req.payload = encodeQuery(targets, inst);
+        } else {
+            req.payload = encodeBinaryInstance(inst);
+        }
+    }
+
+    int fd = connectSocket(socketPath);
+    if(fd < 0){
+        cerr << "cannot connect to " << socketPath << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    Response res;
+    for(int r = 0; r < repeat; r++){
+        req.id = r + 1;
+        auto t0 = chrono::high_resolution_clock::now();
+        if(!roundTrip(fd, req, res)){
+            close(fd);
+            return 1;
+        }
+        auto t1 = chrono::high_resolution_clock::now();
+        if(res.status != ResponseStatus::Ok) break;
+        if(type == RequestType::Solve){
+            cerr << "Request " << req.id << ": server " << res.computeMicros / 1e6 << " s, round trip "
+                 << chrono::duration<double>(t1 - t0).count() << " s"
+                 << ((res.flags & RESPONSE_KERNEL_WARM) ? " (warm kernel)"
+                     : (res.flags & RESPONSE_KERNEL_CACHED) ? " (cached kernel)" : "") << "\n";
+        }
+    }
+    close(fd);
+
+    if(res.status != ResponseStatus::Ok){
+        cerr << "server: " << responseStatusName(res.status) << ": " << res.payload << "\n";
+        return 1;
+    }
+    if(type != RequestType::Solve){
+        cout << res.payload;
+        return 0;
+    }
+    vector<ll> values;
+    if(!decodeValues(res.payload, values)){
+        cerr << "malformed response\n";
+        return 1;
+    }
+    if(!storeResults(output, values)){
+        cerr << "cannot write the results to " << output << "\n";
+        return 1;
+    }
+    return 0;
+}
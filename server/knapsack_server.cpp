@@ -0,0 +1,58 @@
+#include <iostream>
+#include <cstring>
+#include <csignal>
+#include "memory_budget.h"
+#include "server.h"
+using namespace std;
+
+static KnapsackServer* running = nullptr;
+
+static void stopOnSignal(int){
+    if(running) running->shutdown(); // only sets a flag and shuts the listening socket down
+}
+
+// usage: knapsack_server [--socket PATH] [--workers N] [--max-kernels N] [--kernel-cache DIR] [--max-payload MIB]
+//                       [--max-targets N] [--memory-budget SIZE]
+//   --socket       Unix socket to listen on (default /tmp/fastknapsack.sock)
+//   --workers      requests answered concurrently (default 1; every request also uses the shared thread pool)
+//   --max-kernels  distinct kernels kept in memory (default 64)
+//   --kernel-cache also keeps kernels in DIR, across evictions and server restarts (see kernel_cache.h)
+//   --max-payload  largest request accepted, in MiB (default 16); a larger one closes its connection
+//   --max-targets  targets one request may ask for, t + 1 for a dense request (default 4194304)
+//   --memory-budget (or FASTKNAPSACK_MEMORY) refuses requests whose estimated memory does not fit, e.g. 2G
+// Runs until a client sends a shutdown request (knapsack_client --shutdown), SIGINT or SIGTERM.
+int main(int argc, char** argv){
+    KnapsackServer::Options options;
+    size_t budget;
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--socket") == 0 && i + 1 < argc) options.socketPath = argv[++i];
+        else if(strcmp(argv[i], "--workers") == 0 && i + 1 < argc) options.workers = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--max-kernels") == 0 && i + 1 < argc) options.maxKernels = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--kernel-cache") == 0 && i + 1 < argc) options.kernelCacheDir = argv[++i];
+        else if(strcmp(argv[i], "--max-payload") == 0 && i + 1 < argc) options.maxPayload = (size_t)max(1, atoi(argv[++i])) << 20;
+        else if(strcmp(argv[i], "--max-targets") == 0 && i + 1 < argc) options.maxTargets = max(1LL, atoll(argv[++i]));
+        else if(strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc && parseByteSize(argv[i + 1], budget)){
+            setMemoryBudget(budget);
+            i++;
+        }
+        else {
+            cerr << "usage: " << argv[0] << " [--socket PATH] [--workers N] [--max-kernels N] [--kernel-cache DIR] [--max-payload MIB]"
+                 << " [--max-targets N] [--memory-budget SIZE]\n";
+            return 2;
+        }
+    }
+
+    KnapsackServer server(options);
+    if(!server.listen()){
+        cerr << "cannot listen on " << options.socketPath << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    running = &server;
+    signal(SIGINT, stopOnSignal);
+    signal(SIGTERM, stopOnSignal);
+    cerr << "Listening on " << options.socketPath << " with " << max(1, options.workers) << " worker(s)\n";
+    server.run();
+    running = nullptr;
+    cerr << server.stats();
+    return 0;
+}
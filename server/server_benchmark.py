@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Process per request versus the resident server on the same stream of sparse query requests.
+Each of ROUNDS rounds sends every instance once, so from the second round on the server finds the kernels warm,
+while knapsack_solver --queries starts from scratch every time. The answers of both must agree.
+"""
+import os
+import random
+import subprocess
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+SRC_DIR = os.path.join(SCRIPT_DIR, "..", "src")
+SOLVER = os.path.join(SCRIPT_DIR, "knapsack_solver_srv")
+SERVER = os.path.join(SCRIPT_DIR, "knapsack_server")
+CLIENT = os.path.join(SCRIPT_DIR, "knapsack_client")
+
+INSTANCES = 4
+ROUNDS = 5
+N = 200
+U = 2000
+Q = 100
+
+def compile_all():
+    deps = [os.path.join(SRC_DIR, f) for f in
+            ("convolution.cpp", "arena.cpp", "memory_budget.cpp", "trace.cpp", "witness.cpp", "coin_set.cpp", "preprocess.cpp", "periodic.cpp", "query.cpp",
+             "instance_io.cpp", "kernel_cache.cpp", "small_u.cpp", "classical.cpp", "dispatch.cpp", "hitting_set.cpp", "dp_structs.cpp", "algorithms.cpp",
+             "thread_pool.cpp", "protocol.cpp", "server.cpp")]
+    for main, out in ((os.path.join(SCRIPT_DIR, "..", "knapsack_benchmark", "knapsack.cpp"), SOLVER),
+                      (os.path.join(SCRIPT_DIR, "knapsack_server.cpp"), SERVER),
+                      (os.path.join(SCRIPT_DIR, "knapsack_client.cpp"), CLIENT)):
+        subprocess.run([
+            "g++-14", "-std=c++20", "-O2",
+            "-I", os.path.join(SCRIPT_DIR, "..", "include"),
+            *deps, main,
+            "-pthread",
+            "-o", out
+        ], check=True)
+
+def write_request(path):
+    w = random.sample(range(1, U + 1), N)
+    p = [random.randint(1, 10 * U) for _ in range(N)]
+    targets = [random.randint(0, 10**12) for _ in range(Q)]
+    with open(path, "w") as f:
+        f.write(f"{N} {U} 0\n")
+        f.writelines(f"{wi} {pi}\n" for wi, pi in zip(w, p))
+        f.write(f"{Q}\n" + "\n".join(map(str, targets)) + "\n")
+
+def timed(cmd, stdin_path):
+    start = time.perf_counter()
+    with open(stdin_path) as fin:
+        out = subprocess.run(cmd, stdin=fin, capture_output=True, text=True, check=True).stdout
+    return time.perf_counter() - start, out
+
+def main():
+    compile_all()
+    with tempfile.TemporaryDirectory() as tmp:
+        sock = os.path.join(tmp, "server.sock")
+        requests = [os.path.join(tmp, f"request{i}.txt") for i in range(INSTANCES)]
+        for path in requests:
+            write_request(path)
+
+        server = subprocess.Popen([SERVER, "--socket", sock], stderr=subprocess.DEVNULL)
+        while not os.path.exists(sock):
+            time.sleep(0.01)
+        try:
+            print(f"{'round':>5} | {'process (s)':>11} | {'server (s)':>10} | same")
+            print("-" * 42)
+            for r in range(ROUNDS):
+                proc_time = server_time = 0.0
+                same = True
+                for path in requests:
+                    pt, expected = timed([SOLVER, "--queries"], path)
+                    st, got = timed([CLIENT, "--socket", sock, "--queries"], path)
+                    proc_time += pt
+                    server_time += st
+                    same = same and expected == got
+                print(f"{r + 1:5d} | {proc_time:11.3f} | {server_time:10.3f} | {same}")
+        finally:
+            subprocess.run([CLIENT, "--socket", sock, "--shutdown"], capture_output=True)
+            server.wait()
+
+if __name__ == "__main__":
+    main()
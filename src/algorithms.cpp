@@ -1,4 +1,10 @@
 #include "algorithms.h"
+#include "thread_pool.h"
+#include "instrument.h"
+#include "trace.h"
+#include "arena.h"
+#include "memory_budget.h"
+#include <bit>
 
 // Algorithm 1: Witness Propagation
 /**
@@ -13,26 +19,103 @@ void propagation(
     vector<solution>& sol, //sol[c] <- properties related to solution for the weight sum = c
     const vector<int>& order //the lexicographical order of the coins
 ) {
-    for (int j = 1; j <= t; j++) {
-        if (sol[j].size == 0) continue;
-        for (auto const C : sol[j].svec) { //use the svec instead of supp
-            int x = C.first;
-            int nxt = j + w[order[x]];
-            if (nxt > t) continue;
-            sol[j].svec[x]++;
-            sol[j].value += p[order[x]];
-            sol[j].weight += w[order[x]];
-            if (sol[nxt].size == 0
-                || sol[j].value > sol[nxt].value
-                || (sol[j].value == sol[nxt].value && sol[j].lexCmp(sol[nxt]))) //lexCmp should take (log n)^2 time
-            {
-                sol[j].copy(sol[nxt]);
+    CoinSet cs((int)order.size() - 1, 0, w, p, order);
+    propagation(cs, t, sol);
+}
+
+void propagation(const CoinSet& cs, int t, vector<solution>& sol) {
+    propagation(cs, 0, t, sol);
+}
+
+/**
+ * Resumes Algorithm 1 on (from, t]: sol[0..from] must already be final.
+ * Targets above `from` receive the candidates of every j in the same order as in a single run up to t,
+ * so the result (including the lex tie-breaks) is identical.
+ */
+void propagation(const CoinSet& cs, int from, int t, vector<solution>& sol) {
+    FK_SCOPED_TIMER("propagation");
+    // the targets are walked in blocks only so that a trace shows the progress of long runs
+    const ll BLOCK = 1 << 16;
+    for (ll lo = max(1, from - cs.u + 1); lo <= t; lo += BLOCK) {
+        int hi = (int)min((ll)t, lo + BLOCK - 1);
+        FK_TRACE("propagation.block", "propagation", "from", lo, "to", hi);
+        for (int j = (int)lo; j <= hi; j++) {
+            if (sol[j].size == 0) continue;
+            for (auto const C : sol[j].svec) { //use the svec instead of supp
+                int x = C.first;
+                int nxt = j + cs.weightAt(x);
+                if (nxt > t || nxt <= from) continue;
+                sol[j].svec[x]++;
+                sol[j].value += cs.profitAt(x);
+                sol[j].weight += cs.weightAt(x);
+                if (sol[nxt].size == 0
+                    || sol[j].value > sol[nxt].value
+                    || (sol[j].value == sol[nxt].value && sol[j].lexCmp(sol[nxt]))) //lexCmp should take (log n)^2 time
+                {
+                    sol[j].copy(sol[nxt]);
+                }
+                sol[j].svec[x]--;
+                sol[j].value -= cs.profitAt(x);
+                sol[j].weight -= cs.weightAt(x);
+            }
+        }
+    }
+}
+
+void propagationStreamed(const CoinSet& cs, int t, vector<solution>& kernel, const function<void(int, const solution&)>& emit) {
+    FK_SCOPED_TIMER("propagation.streamed");
+    int W = cs.u + 1;
+    vector<solution> ring(W);
+    MemoryCharge table(MemSubsystem::Solutions);
+    auto load = [&](int c) { // target c enters the window
+        solution& s = ring[c % W];
+        s = c < (int)kernel.size() ? move(kernel[c]) : solution();
+    };
+    for (int c = 0; c <= min(t, cs.u); c++) load(c);
+    const ll BLOCK = 1 << 16;
+    for (ll lo = 0; lo <= t; lo += BLOCK) {
+        int hi = (int)min((ll)t, lo + BLOCK - 1);
+        FK_TRACE("propagation.block", "propagation", "from", lo, "to", hi);
+        for (int j = (int)lo; j <= hi; j++) {
+            solution& cur = ring[j % W];
+            if (j > 0 && cur.size != 0) {
+                for (auto const C : cur.svec) {
+                    int x = C.first;
+                    int nxt = j + cs.weightAt(x);
+                    if (nxt > t) continue;
+                    solution& to = ring[nxt % W];
+                    cur.svec[x]++;
+                    cur.value += cs.profitAt(x);
+                    cur.weight += cs.weightAt(x);
+                    if (to.size == 0
+                        || cur.value > to.value
+                        || (cur.value == to.value && cur.lexCmp(to)))
+                    {
+                        cur.copy(to);
+                    }
+                    cur.svec[x]--;
+                    cur.value -= cs.profitAt(x);
+                    cur.weight -= cs.weightAt(x);
+                }
             }
-            sol[j].svec[x]--;
-            sol[j].value -= p[order[x]];
-            sol[j].weight -= w[order[x]];
+            emit(j, cur);
+            if (j + W <= t) load(j + W);
         }
+        table.set(solutionTableBytes(ring, 0, W - 1));
     }
+    kernel.clear();
+}
+
+/**
+ * Copies the values of the (sorted) frontier capacities into `window`, which starts at capacity frontier[0];
+ * every other entry of the window is `empty`. Returns frontier[0].
+ */
+template <typename T>
+static int buildWindow(const vector<int>& frontier, const vector<T>& v, vector<T>& window, T empty) {
+    int lo = frontier.front(), hi = frontier.back();
+    window.assign(hi - lo + 1, empty);
+    for (int c : frontier) window[c - lo] = v[c];
+    return lo;
 }
 
 // Algorithm 2: Kernel Computation
@@ -53,6 +136,14 @@ void kernelComputation_knapsack(
     int t,                          // (unused) global target bound
     vector<solution>& sol              // output: sol[c] for c∈[0..k·u]
 ) {
+    CoinSet cs(n, u, w, p, order);
+    kernelComputation_knapsack(cs, t, sol);
+}
+
+void kernelComputation_knapsack(const CoinSet& cs, int t, vector<solution>& sol) {
+    FK_SCOPED_TIMER("kernel.knapsack");
+    FK_TRACE("kernel.knapsack", "kernel", "n", cs.n, "u", cs.u);
+    int u  = cs.u;
     int k  = static_cast<int>(floor(2.0 * log2(u) + 1.0));
     int KU = k * u + 1;
 
@@ -60,60 +151,56 @@ void kernelComputation_knapsack(
     sol.assign(max(KU, t + 1), solution());
 
     // v[c] = best profit for capacity c so far
+    // f[x] = best profit of a coin of weight x, fWit[x] = smallest order index among such coins
     vector<ll> v(KU, NEG_INF), f(u+1, NEG_INF);
+    vector<int> fWit(u+1, -1);
     v[0] = 0;
-    for (int i = 1; i <= n; i++) {
-        f[w[order[i]]] = p[order[i]];
-    }
-
-    //For min-witness tracking
-    vector<ll> f_w(u+1, NEG_INF);
-    for (int i = 1; i <= n; i++) {
-        // store (n+1)*f[w] - i so that in the convolution
-        // max_plus(v_w, f_w)[c] ≡ (n+1)*v'[c] - i
-        f_w[w[order[i]]] = (n + 1) * f[w[order[i]]] - i;
-    }
-    //compute the inverse of order so that we can use the order to find the minimum witness
-    vector<int> inverseOrder(n+1);
-    for (int i = 1; i <= n; i++) {
-        inverseOrder[order[i]] = i;
-    }
-
-    vector<ll> vPrime, v_w(KU, NEG_INF), minW;
-
-    for (int iter = 1; iter <= k; iter++) { //compute iter-kernel
-        // 1) (max,+) convolve to get new profits
-        vPrime = maxPlusCnv(v, f); //has size = KU + u - 1
-
-        // 2) build scaled v for witness tracking
-        fill(v_w.begin(), v_w.end(), NEG_INF);
-        for (int c = 0; c < KU; c++) {
-            if (v[c] > NEG_INF) 
-                v_w[c] = (n + 1) * v[c];
+    for (int x = 1; x <= u; x++) {
+        for (int e = cs.weightStart[x]; e < cs.weightStart[x + 1]; e++) {
+            int i = cs.byWeight[e];
+            if (cs.profitAt(i) > f[x]) { // i increases, so ties keep the smaller order index
+                f[x] = cs.profitAt(i);
+                fWit[x] = i;
+            }
         }
+    }
 
-        // 3) convolve to get encoded witnesses
-        minW = maxPlusCnv(v_w, f_w);
-
-        // 4) reconstruct each kernel solution
-        for (int c = 1; c < KU; c++) {
-            if (vPrime[c] > NEG_INF) {
-                // accept new profit
-                v[c] = vPrime[c];
-
-                // recover the “-i” index from minW[c], then flip it to +i
-                int negI      = minW[c] % (n+1);
-                int witnessI  = ((n+1) - negI) % (n+1);
-                if (witnessI == 0) continue;           // no valid coin
-
-                int coinIdx = inverseOrder[witnessI];
-                int prev    = c - w[coinIdx];
-                if (prev >= 0) {
-                    sol[prev].copy(sol[c]);
-                }
-                sol[c].addCoin(coinIdx, w[coinIdx], p[coinIdx]);
-            }
+    // curWit[c] = order index of the coin sol[c] was last built with
+    // frontier = capacities whose solution changed in the previous iteration; any other capacity
+    // would only produce the candidates it already produced before, so it can be left out of the convolution
+    vector<int> curWit(KU, INT_MAX);
+    vector<int> frontier(1, 0);
+    vector<ll> window, vPrime;
+    vector<int> minW;
+    vector<int> next;
+
+    for (int iter = 1; iter <= k && !frontier.empty(); iter++) { //compute iter-kernel
+        FK_TRACE("kernel.iteration", "kernel", "iter", iter, "frontier", frontier.size());
+        // 1) single (max,+) pass over the frontier window: new profits together with their minimum witnesses
+        int lo = buildWindow(frontier, v, window, (ll)NEG_INF);
+        FK_HISTOGRAM("kernel.window", window.size());
+        vPrime = maxPlusCnv_minWitness(window, f, fWit, minW); //entry j is capacity lo + j
+
+        // 2) rebuild each kernel solution whose (profit, -witness) candidate is at least as good as the current one
+        next.clear();
+        for (int j = 0; j < (int)vPrime.size() && lo + j < KU; j++) {
+            int c = lo + j;
+            if (c == 0 || vPrime[j] == NEG_INF) continue;
+            if (vPrime[j] < v[c] || (vPrime[j] == v[c] && minW[j] > curWit[c])) continue;
+
+            int witnessI = minW[j];
+            int prev     = c - cs.weightAt(witnessI);
+            solution rebuilt;
+            sol[prev].copy(rebuilt);
+            rebuilt.addCoin(witnessI, cs.weightAt(witnessI), cs.profitAt(witnessI));
+            if (witnessI == curWit[c] && rebuilt.value == sol[c].value && rebuilt.svec == sol[c].svec) continue;
+
+            swap(sol[c], rebuilt);
+            v[c] = sol[c].value;
+            curWit[c] = witnessI;
+            next.push_back(c);
         }
+        frontier.swap(next);
     }
 }
 
@@ -126,6 +213,14 @@ void kernelComputation_coinchange_simple(
     int t,                          // (unused) global target bound
     vector<solution>& sol              // output: sol[c] for c∈[0..k·u]
 ) {
+    CoinSet cs(n, u, w, p, order);
+    kernelComputation_coinchange_simple(cs, t, sol);
+}
+
+void kernelComputation_coinchange_simple(const CoinSet& cs, int t, vector<solution>& sol) {
+    FK_SCOPED_TIMER("kernel.coinchange_simple");
+    FK_TRACE("kernel.coinchange_simple", "kernel", "n", cs.n, "u", cs.u);
+    int u  = cs.u;
     int k  = static_cast<int>(floor(2.0 * log2(u) + 1.0));
     // cout << "kernel size " << k << endl; 
     int KU = k * u + 1;
@@ -133,43 +228,43 @@ void kernelComputation_coinchange_simple(
     // prepare sol[0..KU-1]
     sol.assign(max(KU, t + 1), solution());
 
-    // v[c] = can reach capacity c so far
-    vector<int> v(KU), f(u+1);
+    // v[c] = can reach capacity c so far, f = indicator of the coin weights
+    vector<int> v(KU), f = cs.f;
     v[0] = 1;
-    f[0] = 1;
-    for (int i = 1; i <= n; i++) {
-        f[w[order[i]]] = 1;
-    }
-
-    vector<int> inverseOrder(n+1);
-    for (int i = 1; i <= n; i++) {
-        inverseOrder[order[i]] = i;
-    }
 
-    vector<int> vPrime;
-    for (int iter = 1; iter <= k; iter++) { //compute iter-kernel
-        // 1) boolean convolve to get new reachable capacities
-        vPrime = boolCnv(v, f);
+    // frontier = capacities first reached in the previous iteration (sorted); a capacity first reached
+    // in this iteration has all its witnesses there, so the rest of v can be left out of the convolutions
+    vector<int> frontier(1, 0);
+    vector<int> window, next, vPrime;
+    for (int iter = 1; iter <= k && !frontier.empty(); iter++) { //compute iter-kernel
+        FK_TRACE("kernel.iteration", "kernel", "iter", iter, "frontier", frontier.size());
+        // 1) boolean convolve to get new reachable capacities (entry j is capacity lo + j)
+        int lo = buildWindow(frontier, v, window, 0);
+        FK_HISTOGRAM("kernel.window", window.size());
+        vPrime.resize(window.size() + f.size() - 1);
+        boolCnv(window, f, vPrime);
 
         // 2) Find minimum witness for each reachable capacity
-        vector<int> minW = minimum_witness_boolCnv_ordered(f, v, w, order);
+        vector<int> minW = minimum_witness_boolCnv_ordered(f, window, cs);
         // 3) reconstruct each kernel solution
-        for (int c = 1; c < KU; c++) {
-            if (vPrime[c] == 1 && v[c] == 0) {
-                // cerr << "first time reaching capacity " << c << " at " << iter << endl;
+        next.clear();
+        for (int j = 0; j < (int)vPrime.size() && lo + j < KU; j++) {
+            int c = lo + j;
+            if (vPrime[j] == 1 && v[c] == 0) {
                 // accept new reachable capacity
-                v[c] = vPrime[c];
+                v[c] = 1;
+                next.push_back(c);
 
                 // find the minimum witness 
-                int witnessI = minW[c];
-                int coinIdx = inverseOrder[witnessI];
-                int prev    = c - w[coinIdx];
+                int witnessI = minW[j];
+                int prev    = c - cs.weightAt(witnessI);
                 if (prev >= 0) {
                     sol[prev].copy(sol[c]);
                 }
-                sol[c].addCoin(witnessI, w[coinIdx], -1); //note in coinchange, the profit array is just -1
+                sol[c].addCoin(witnessI, cs.weightAt(witnessI), -1); //note in coinchange, the profit array is just -1
             }
         }
+        frontier.swap(next);
     }
 }
 
@@ -182,6 +277,15 @@ void kernelComputation_coinchange_randomized(
     int t,                          // (unused) global target bound
     vector<solution>& sol              // output: sol[c] for c∈[0..k·u]
 ) {
+    CoinSet cs(n, u, w, p, order);
+    kernelComputation_coinchange_randomized(cs, t, sol);
+    order = cs.order;
+}
+
+void kernelComputation_coinchange_randomized(CoinSet& cs, int t, vector<solution>& sol) {
+    FK_SCOPED_TIMER("kernel.coinchange_randomized");
+    FK_TRACE("kernel.coinchange_randomized", "kernel", "n", cs.n, "u", cs.u);
+    int u  = cs.u;
     int k  = static_cast<int>(floor(2.0 * log2(u) + 1.0));
     // cout << "kernel size " << k << endl; 
     int KU = k * u + 1;
@@ -189,110 +293,317 @@ void kernelComputation_coinchange_randomized(
     // prepare sol[0..KU-1]
     sol.assign(max(KU, t + 1), solution());
 
-    // v[c] = can reach capacity c so far
-    vector<int> v(KU), f(u+1);
+    // v[c] = can reach capacity c so far, f = indicator of the coin weights
+    vector<int> v(KU), f = cs.f;
     v[0] = 1;
-    f[0] = 1;
-    for (int i = 1; i <= n; i++) {
-        f[w[order[i]]] = 1;
-    }
 
-    vector<int> inverseOrder(n+1);
-    for (int i = 1; i <= n; i++) {
-        inverseOrder[order[i]] = i;
-    }
-
-    vector<int> vPrime;
+    //randomize order
+    vector<int> order = cs.order;
     random_shuffle(order.begin() + 1, order.end());
-    for (int iter = 1; iter <= k; iter++) { //compute iter-kernel
-        // 1) boolean convolve to get new reachable capacities
-        vPrime = boolCnv(v, f);
+    cs.setOrder(order);
+
+    // frontier = capacities first reached in the previous iteration, see kernelComputation_coinchange_simple()
+    vector<int> frontier(1, 0);
+    vector<int> window, next, vPrime;
+    for (int iter = 1; iter <= k && !frontier.empty(); iter++) { //compute iter-kernel
+        FK_TRACE("kernel.iteration", "kernel", "iter", iter, "frontier", frontier.size());
+        // 1) boolean convolve to get new reachable capacities (entry j is capacity lo + j)
+        int lo = buildWindow(frontier, v, window, 0);
+        FK_HISTOGRAM("kernel.window", window.size());
+        vPrime.resize(window.size() + f.size() - 1);
+        boolCnv(window, f, vPrime);
 
         // 2) Find minimum witness for each reachable capacity
-        //randomize order
-        vector<int> minW = minimum_witness_random(f, v, w, order);
+        vector<int> minW = minimum_witness_random(f, window, cs);
         // 3) reconstruct each kernel solution
-        for (int c = 1; c < KU; c++) {
-            if (vPrime[c] == 1 && v[c] == 0) {
-                // cerr << "first time reaching capacity " << c << " at " << iter << endl;
+        next.clear();
+        for (int j = 0; j < (int)vPrime.size() && lo + j < KU; j++) {
+            int c = lo + j;
+            if (vPrime[j] == 1 && v[c] == 0) {
                 // accept new reachable capacity
-                v[c] = vPrime[c];
+                v[c] = 1;
+                next.push_back(c);
 
                 // find the minimum witness 
-                int witnessI = minW[c];
-                int coinIdx = inverseOrder[witnessI];
-                int prev    = c - w[coinIdx];
+                int witnessI = minW[j];
+                int prev    = c - cs.weightAt(witnessI);
                 if (prev >= 0) {
                     sol[prev].copy(sol[c]);
                 }
-                sol[c].addCoin(witnessI, w[coinIdx], -1); //note in coinchange, the profit array is just -1
+                sol[c].addCoin(witnessI, cs.weightAt(witnessI), -1); //note in coinchange, the profit array is just -1
             }
         }
+        frontier.swap(next);
     }
 }
 
+/**
+ * Near-linear CoinChange kernel: the k boolean convolutions c_iter = boolCnv(f, v_{iter-1}) are stacked as the rows
+ * of Algorithm 4, which adapts `order` so that one fixed witness per newly reached capacity is its minimum witness.
+ * The solutions are reconstructed afterwards, row by row, with respect to the adapted order.
+ */
 void kernelComputation_coinchange(
     int n,                              // number of coins
     int u,                              // maximum coin weight
     const vector<int>& w,               // weights of the coins (1-indexed)
     const vector<int>& p,               // profits of the coins  (1-indexed)
-    vector<int>& order,           // lexicographical order σ[1..n]
+    vector<int>& order,           // lexicographical order σ[1..n], overwritten by the adapted order
     int t,                          // (unused) global target bound
     vector<solution>& sol              // output: sol[c] for c∈[0..k·u]
 ) {
+    CoinSet cs(n, u, w, p, order);
+    kernelComputation_coinchange(cs, t, sol);
+    order = cs.order;
+}
+
+void kernelComputation_coinchange(CoinSet& cs, int t, vector<solution>& sol) {
+    FK_SCOPED_TIMER("kernel.coinchange_adaptive");
+    FK_TRACE("kernel.coinchange_adaptive", "kernel", "n", cs.n, "u", cs.u);
+    int u  = cs.u;
     int k  = static_cast<int>(floor(2.0 * log2(u) + 1.0));
-    // cout << "kernel size " << k << endl; 
     int KU = k * u + 1;
 
     // prepare sol[0..KU-1]
     sol.assign(max(KU, t + 1), solution());
 
-    // v[c] = best profit for capacity c so far
-    vector<int> v(KU, NEG_INF), f(u+1, NEG_INF);
-    v[0] = 0;
-    for (int i = 1; i <= n; i++) {
-        f[w[order[i]]] = p[order[i]];
+    // v[c] = can reach capacity c so far, f[x] = there is a coin of weight x
+    const vector<int>& f = cs.f;
+    vector<int> v(KU);
+    v[0] = 1;
+
+    // row iter-1 holds the convolution computing the iter-kernel, restricted to the window of the frontier
+    // (capacities first reached in the previous iteration, which hold all witnesses of the new capacities);
+    // c only keeps the capacities reached for the first time, which are the entries we need witnesses for
+    vector<vector<int>> a, b, c;
+    vector<int> offset;
+    vector<int> frontier(1, 0);
+    for (int iter = 1; iter <= k && !frontier.empty(); iter++) { //compute iter-kernel
+        FK_TRACE("kernel.iteration", "kernel", "iter", iter, "frontier", frontier.size());
+        vector<int> window;
+        int lo = buildWindow(frontier, v, window, 0);
+        FK_HISTOGRAM("kernel.window", window.size());
+        vector<int> row = convolution(f, window); //entry j is capacity lo + j
+        vector<int> next;
+        for (int j = 0; j < (int)row.size(); j++) {
+            int cap = lo + j;
+            if (cap >= KU || v[cap]) {
+                row[j] = 0;
+            } else if (row[j] > 0) {
+                v[cap] = 1;
+                next.push_back(cap);
+            }
+        }
+        a.push_back(f);
+        b.push_back(move(window));
+        c.push_back(move(row));
+        offset.push_back(lo);
+        frontier.swap(next);
     }
-    // cout << "v, f initialized" << endl;
-
-    
-    vector<int> vPrime;
-    vector<vector<int>> a(k, vector<int>(KU));
-    vector<vector<int>> b(k, vector<int>(u+1)); //Make the optimization b is always f if needed
-    vector<vector<int>> c(k, vector<int>(KU + u));
-    c[0] = v;
-    for (int iter = 1; iter <= k; iter++) { //compute iter-kernel
-        vPrime = boolCnv(v, f);
-        for (int i = 1; i <= n; i++) {
-            if (vPrime[i]) {
-                if (sol[i].value == 0) {
-                    sol[i].value = -iter;
-                } else {
-                    sol[i].value = max((int)sol[i].value, -iter);
-                }
+
+    unsigned seed = chrono::system_clock::now().time_since_epoch().count();
+    vector<vector<int>> minW = adaptiveMinWitness_randomized(a, b, c, cs, seed);
+
+    // reconstruct each kernel solution, with (1, ..., n) now being the adapted lex order
+    for (int r = 0; r < (int)c.size(); r++) {
+        for (int j = 0; j < (int)c[r].size(); j++) {
+            if (c[r][j] == 0) continue;
+            int cap      = offset[r] + j;
+            int witnessI = minW[r][j];
+            int prev     = cap - cs.weightAt(witnessI);
+            if (prev >= 0) {
+                sol[prev].copy(sol[cap]);
             }
+            sol[cap].addCoin(witnessI, cs.weightAt(witnessI), -1); //note in coinchange, the profit array is just -1
+        }
+    }
+}
+/**
+ * Kernel for the Residue Table, with the "value = sum" objective: every multiset of a fixed sum has the same value,
+ * so sol[c] is the lex-minimum multiset of sum c. The iter-kernel is a boolean convolution of the coin indicator with
+ * the frontier, and the candidate sol[c - w_x] + x of the minimum witness x replaces sol[c] whenever it is lex-smaller.
+ * Every kernel sum (each coin of the support used once) is exact after at most |supp| iterations.
+ */
+void kernelComputation_residue(const CoinSet& cs, vector<solution>& sol) {
+    FK_SCOPED_TIMER("kernel.residue");
+    FK_TRACE("kernel.residue", "kernel", "n", cs.n, "u", cs.u);
+    // only the kernel sums are needed exactly, and their supports have at most log₂(u) + 1 coins
+    int u  = cs.u;
+    int k  = static_cast<int>(floor(log2(u) + 1.0));
+    int KU = k * u + 1;
+
+    sol.assign(KU, solution());
+
+    // v[c] = capacity c reached so far, f = indicator of the coin weights
+    vector<int> v(KU), f = cs.f;
+    v[0] = 1;
+
+    // frontier = capacities whose solution changed in the previous iteration (sorted)
+    vector<int> frontier(1, 0);
+    vector<int> window, next;
+    for (int iter = 1; iter <= k && !frontier.empty(); iter++) {
+        FK_TRACE("kernel.iteration", "kernel", "iter", iter, "frontier", frontier.size());
+        int lo = buildWindow(frontier, v, window, 0);
+        vector<int> minW = minimum_witness_boolCnv_ordered(f, window, cs); //entry j is capacity lo + j
+
+        next.clear();
+        for (int j = 0; j < (int)minW.size() && lo + j < KU; j++) {
+            int c = lo + j;
+            if (c == 0 || minW[j] == -1) continue;
+            int x  = minW[j];
+            int wt = cs.weightAt(x);
+            solution cand;
+            sol[c - wt].copy(cand);
+            cand.addCoin(x, wt, wt); // value = sum
+            if (v[c] && !cand.lexCmp(sol[c])) continue;
+
+            swap(sol[c], cand);
+            v[c] = 1;
+            next.push_back(c);
         }
-        a[iter] = v;
-        b[iter] = f;
-        c[iter] = vPrime;
-        for (int i = 0; i < v.size(); i++) {
-            v[i] = vPrime[i];
+        frontier.swap(next);
+    }
+}
+
+/**
+ * Residue Table: for every residue r modulo the smallest weight w_min, the smallest reachable sum congruent to r,
+ * together with its lex-minimum multiset (res[r].weight = res[r].value = the sum, svec keyed by order index).
+ * res[r].size == 0 for r != 0 means that no sum is congruent to r.
+ *
+ * An optimal multiset never needs w_min coins besides itself, and removing a coin x of multiplicity ≥ 2 leaves the
+ * optimal multiset of residue r - w_x, which still contains x. So the kernel sums seed a Dijkstra over the residues
+ * that only pushes along the support of the popped solution: O(w_min log u log w_min) on top of the kernel,
+ * instead of O(w_min · n log w_min) for a Dijkstra along all coins.
+ */
+void residueTable(const CoinSet& cs, vector<solution>& res) {
+    int m = INT_MAX;
+    for (int x = 1; x <= cs.n; x++) {
+        m = min(m, cs.weightAt(x));
+    }
+
+    vector<solution> sol;
+    kernelComputation_residue(cs, sol);
+
+    // true if a is a better solution than b for the same residue
+    auto better = [](solution& a, solution& b) {
+        return a.weight < b.weight || (a.weight == b.weight && a.lexCmp(b));
+    };
+
+    res.assign(m, solution());
+    vector<char> seen(m, 0), done(m, 0);
+    seen[0] = 1;
+    for (int c = 1; c < (int)sol.size(); c++) {
+        if (sol[c].size == 0) continue;
+        int r = c % m;
+        if (!seen[r] || better(sol[c], res[r])) {
+            sol[c].copy(res[r]);
+            seen[r] = 1;
         }
     }
-    //adaptiveMinWitness(a, b, c, order);
-    //reorder arrays so that with respect to adaptive lex order so that (1, ..., n) is the lex order
-    for (int iter = 1; iter <= k; iter++) {
-        for (int i = 1; i <= KU; i++) {
-            if (c[iter][i] && !c[iter-1][i]) {
-                int minWit = i; // minimum witness placeholder
-                if (i-w[minWit] >= 0) {
-                    sol[i-w[minWit]].copy(sol[i]);
-                } 
-                sol[i].addCoin(minWit, w[minWit], p[minWit]); //make sure this is also reordered so that (1,...,n) is the lex order
+
+    priority_queue<pair<ll,int>, vector<pair<ll,int>>, greater<pair<ll,int>>> pq;
+    for (int r = 0; r < m; r++) {
+        if (seen[r]) pq.push({res[r].weight, r});
+    }
+    while (!pq.empty()) {
+        auto [d, r] = pq.top();
+        pq.pop();
+        if (done[r] || d != res[r].weight) continue;
+        done[r] = 1;
+        for (auto const& C : res[r].svec) {
+            int x  = C.first;
+            int wt = cs.weightAt(x);
+            int nr = (int)((r + (ll)wt) % m);
+            if (done[nr]) continue;
+            solution cand;
+            res[r].copy(cand);
+            cand.addCoin(x, wt, wt);
+            if (!seen[nr] || better(cand, res[nr])) {
+                swap(res[nr], cand);
+                seen[nr] = 1;
+                pq.push({res[nr].weight, nr});
             }
         }
     }
 }
+
+void residueTable(
+    int n, int u,
+    const vector<int>& w,
+    const vector<int>& order,
+    vector<solution>& res
+) {
+    CoinSet cs(n, u, w, {}, order);
+    residueTable(cs, res);
+}
+
+// All-Target Counting
+/**
+ * The power series exp costs about this many DP additions per N·log2 N, N = t + 1 rounded up to a power of two.
+ * Measured 280-560 at t = 2^16..2^20 with weights up to 4096 (break-even near n ≈ 4000-8000 coins), and about
+ * 190 when all weights are tiny and every pass of the DP is one dependency chain.
+ */
+const double COUNT_EXP_PER_NLOGN = 320;
+
+// dp[c] += dp[c - w] once per coin, O(n·t) additions
+vector<ll> countCoinChangeDP(const CoinSet& cs, int t) {
+    FK_SCOPED_TIMER("count.dp");
+    vector<int> dp(t + 1, 0);
+    dp[0] = 1;
+    for (int x = 1; x <= min(cs.u, t); x++) {
+        for (int copy = cs.weightStart[x]; copy < cs.weightStart[x + 1]; copy++) {
+            for (int c = x; c <= t; c++) {
+                dp[c] += dp[c - x];
+                if (dp[c] >= NTT_MOD) dp[c] -= NTT_MOD;
+            }
+        }
+    }
+    return vector<ll>(dp.begin(), dp.end());
+}
+
+/**
+ * Number of coin multisets of every sum c ∈ [0..t] modulo NTT_MOD, i.e. the coefficients of ∏ 1/(1 - x^{w_i}).
+ * Coins of equal weight count as different coins.
+ * ln ∏ 1/(1 - x^{w_i}) = Σ_i Σ_{j≥1} x^{j·w_i} / j, so the log has L[m] = (1/m) Σ_{w | m} cnt[w]·w, which takes
+ * O(t log t) over the multiples of each weight; one power series exp then gives the product in O(t log t).
+ */
+vector<ll> countCoinChangeExp(const CoinSet& cs, int t) {
+    FK_SCOPED_TIMER("count.exp");
+    vector<ll> L(t + 1, 0);
+    for (int x = 1; x <= min(cs.u, t); x++) {
+        ll cnt = cs.weightStart[x + 1] - cs.weightStart[x];
+        if (cnt == 0) continue;
+        for (int m = x; m <= t; m += x) {
+            L[m] = (L[m] + cnt * x) % NTT_MOD;
+        }
+    }
+    // inv[m] = 1/m mod NTT_MOD, in linear time
+    vector<ll> inv(t + 1, 1);
+    for (int m = 2; m <= t; m++) {
+        inv[m] = (NTT_MOD - NTT_MOD / m) * inv[NTT_MOD % m] % NTT_MOD;
+    }
+    for (int m = 1; m <= t; m++) {
+        L[m] = L[m] * inv[m] % NTT_MOD;
+    }
+    return polyExp(L, t + 1);
+}
+
+// the exp has a large constant, so up to several thousand coins the DP is faster
+vector<ll> countCoinChange(const CoinSet& cs, int t) {
+    double dpCost = 0;
+    for (int x = 1; x <= min(cs.u, t); x++) {
+        dpCost += (double)(cs.weightStart[x + 1] - cs.weightStart[x]) * (t + 1 - x);
+    }
+    double N = (double)bit_ceil((unsigned)t + 1);
+    return dpCost <= COUNT_EXP_PER_NLOGN * N * log2(N) ? countCoinChangeDP(cs, t) : countCoinChangeExp(cs, t);
+}
+
+vector<ll> countCoinChange(int n, const vector<int>& w, int t) {
+    vector<int> order(n + 1);
+    for (int i = 1; i <= n; i++) order[i] = i;
+    CoinSet cs(n, 0, w, {}, order);
+    return countCoinChange(cs, t);
+}
+
 // Algorithm 4: Adaptive Minimum Witness
 /**
  * Computes the minimum witness of a solution
@@ -328,112 +639,167 @@ void adaptiveMinWitness(
     //if witnesses[i][j].size() > 1, manually compute its minimum witness using sigma
 }
 
+/**
+ * Randomized Algorithm 4.
+ * a[i] is the indicator of the coin weights, b[i] a boolean array, and c[i][j] > 0 marks the entries of
+ * boolCnv(a[i], b[i]) whose minimum witness is wanted (c[i] must have size |a[i]| + |b[i]| - 1).
+ * `order` is the lex order σ[1..n] of the coins; it is overwritten by the adapted order.
+ * Returns res[i][j] = order index of the minimum witness of entry j of row i under the adapted order, or -1.
+ *
+ * Every round finds up to k witnesses of each pending entry among the current candidate coins S.
+ * Entries with fewer than k witnesses are complete and resolved; the others are hit by a hitting set H with
+ * |H| <= |S|/2, which becomes the next S. The adapted order lists the last S first, then the dropped layers
+ * in reverse, so every pending entry has its minimum witness in the layer where it was resolved.
+ */
 vector<vector<int>> adaptiveMinWitness_randomized(
     vector<vector<int>>& a,
     vector<vector<int>>& b,
     vector<vector<int>>& c,
-    vector<int>& w,
+    const vector<int>& w,
     vector<int>& order
 ) {
+    unsigned seed = chrono::system_clock::now().time_since_epoch().count();
+    return adaptiveMinWitness_randomized(a, b, c, w, order, seed);
+}
+
+// total size of the witness lists from which the hitting set is sampled in parallel instead of computed greedily
+const int PARALLEL_HITTING_SET_MIN = 1 << 20;
+
+vector<vector<int>> adaptiveMinWitness_randomized(
+    vector<vector<int>>& a,
+    vector<vector<int>>& b,
+    vector<vector<int>>& c,
+    const vector<int>& w,
+    vector<int>& order,
+    unsigned seed
+) {
+    CoinSet cs((int)order.size() - 1, 0, w, {}, order);
+    vector<vector<int>> res = adaptiveMinWitness_randomized(a, b, c, cs, seed);
+    order = cs.order;
+    return res;
+}
+
+vector<vector<int>> adaptiveMinWitness_randomized(
+    vector<vector<int>>& a,
+    vector<vector<int>>& b,
+    vector<vector<int>>& c,
+    CoinSet& cs,
+    unsigned seed
+) {
+    FK_SCOPED_TIMER("adaptive.min_witness");
+    FK_TRACE("adaptive.min_witness", "witness", "rows", a.size(), "n", cs.n);
     int p = a.size();
     if (p == 0) return {};
-    int n = order.size();
-    int r = (int)c[0].size();      // = 2*n - 1
+    int n = cs.n;
+    int r = 1;
+    for (int i = 0; i < p; ++i) r = max(r, (int)c[i].size());
 
     // fixed k = 2·⌈log₂(p) + log₂(r)⌉
-    int k = 2 * static_cast<int>(ceil(log2(p) + log2(r)));
+    int k = max(2, 2 * static_cast<int>(ceil(log2(p) + log2(r))));
 
     // output array, initialized to -1
-    vector<vector<int>> res(p, vector<int>(r, -1));
+    vector<vector<int>> res(p);
+    for (int i = 0; i < p; ++i) res[i].assign(c[i].size(), -1);
 
-    vector<int> newOrder;
-    int size = n;
-
-    // temp to tie-break by final order
-    vector<int> posMap(n);
-
-    // scratch for storing <k witnesses
-    vector<vector<vector<int>>> witnesses(p, vector<vector<int>>(r));
-
-    while (size > 1) {
-      // 1) collect witnesses for each row i
-      vector<vector<int>> bigSets;
-      bigSets.reserve(p * r);
+    // complete witness sets (order indices w.r.t. the input order) of the resolved entries
+    vector<vector<vector<int>>> witnesses(p);
+    vector<vector<int>> pending(p);
+    for (int i = 0; i < p; ++i) {
+        witnesses[i].resize(c[i].size());
+        for (int j = 0; j < (int)c[i].size(); ++j)
+            if (c[i][j] > 0) pending[i].push_back(j);
+    }
 
+    vector<int> S(n); // current candidate coins, as order indices
+    for (int x = 1; x <= n; ++x) S[x-1] = x;
+    vector<vector<int>> layers; // S \ H of every round
+    vector<bool> inH(n + 1, false);
+    unsigned round = 0;
+
+    while (true) {
+      FK_HISTOGRAM("adaptive.candidates", S.size());
+      FK_TRACE("adaptive.round", "witness", "round", round, "candidates", S.size());
+      // 1) up to k witnesses among S for each pending entry; rows run in parallel,
+      //    each on the RNG stream of (round, row) so the result does not depend on the thread count
+      vector<vector<vector<int>>> rec(p);
+      sharedThreadPool().parallelFor(0, p, [&](int i) {
+        if (pending[i].empty()) return;
+        ArenaScope scratch(MemSubsystem::Witness); // per-thread scratch
+        pmr::vector<int> aS(a[i].size(), 0, scratch.resource());
+        for (int x : S) {
+          int wt = cs.weightAt(x);
+          if (a[i][wt]) aS[wt] = 1;
+        }
+        pmr::vector<int> wanted(c[i].size(), 0, scratch.resource());
+        for (int j : pending[i]) wanted[j] = 1;
+        rec[i] = randomized_k_witness(aS, b[i], k, cs, wanted, streamSeed(seed, round, i));
+      });
+      round++;
+
+      // 2) entries with < k witnesses are complete, the others need to be hit
+      vector<const vector<int>*> bigSets;
+      vector<pair<int,int>> bigEntries;
       for (int i = 0; i < p; ++i) {
-        auto rec = randomized_k_witness(a[i], b[i], k, w, order);
-        for (int j = 0; j < r; ++j) {
-          if (rec[j].size() < (size_t)k) {
-            witnesses[i][j] = move(rec[j]);
+        vector<int> stillPending;
+        for (int j : pending[i]) {
+          if (rec[i][j].size() < (size_t)k) {
+            witnesses[i][j] = move(rec[i][j]);
           } else {
-            bigSets.push_back(move(rec[j]));
+            bigSets.push_back(&rec[i][j]);
+            bigEntries.push_back({i, j});
+            stillPending.push_back(j);
           }
         }
+        pending[i].swap(stillPending);
       }
-
-      // 2) if no “big” sets remain, we can finalize everything now
-      if (bigSets.empty()) {
-        // build position map for final tie-break
-        for (int idx = 0; idx < size; ++idx)
-          posMap[ order[idx] ] = idx;
-
-        // tie-break each multi-candidate entry
-        for (int i = 0; i < p; ++i) {
-          for (int j = 0; j < r; ++j) {
-            if (c[i][j] > 0 && witnesses[i][j].size() > 1) {
-              int best = witnesses[i][j][0];
-              for (int x : witnesses[i][j])
-                if (posMap[x] < posMap[best])
-                  best = x;
-              res[i][j] = best;
-            }
-            // also fill singleton cases:
-            else if (c[i][j] > 0 && witnesses[i][j].size() == 1) {
-              res[i][j] = witnesses[i][j][0];
-            }
+      if (bigSets.empty()) break;
+
+      // 3) compute hitting set H of all bigSets, read straight from the witness lists;
+      //    large systems are sampled in parallel (exact greedy as fallback if the sample exceeds |S|/2),
+      //    small ones go to the greedy, whose hitting sets are smaller and shrink S faster
+      SetSystem big(bigSets);
+      auto H = (int)big.elems.size() >= PARALLEL_HITTING_SET_MIN
+          ? computeHittingSet_randomized(big, k, n, (int)S.size() / 2, streamSeed(seed, round, p))
+          : computeHittingSet(big, k, n);
+      if (H.size() >= S.size()) {
+        // no progress (tiny S): collect the complete witness sets among S directly
+        for (auto [i, j] : bigEntries) {
+          for (int x : S) {
+            int wt = cs.weightAt(x);
+            if (a[i][wt] && j - wt >= 0 && j - wt < (int)b[i].size() && b[i][j - wt])
+              witnesses[i][j].push_back(x);
           }
+          pending[i].clear();
         }
-        return res;
+        break;
       }
 
-      // 3) compute hitting set H of all bigSets
-      auto H = computeHittingSet(bigSets, (int)bigSets.size(), k, size);
-
-      // 4) rebuild `order` so that H is the new prefix
-      vector<bool> inH(n,false);
+      // 4) H is the new candidate set, the rest of S goes after it in the final order
       for (int x : H) inH[x] = true;
-      newOrder.clear();
-      newOrder.reserve(H.size());
-      for (int x : order)
-        if (inH[x])
-          newOrder.push_back(x);
-      size = (int)newOrder.size();    // now ≤ old size/2
-      order.swap(newOrder);
-
-      // 5) restrict a,b to the new prefix of length `size` and recompute c
-      r = 2*size - 1;
-      for (int i = 0; i < p; ++i) {
-        vector<int> ai(size), bi(size);
-        for (int t = 0; t < size; ++t) {
-          ai[t] = a[i][ order[t] ];
-          bi[t] = b[i][ order[t] ];
-        }
-        auto ci = convolution(ai, bi);
-        c[i].swap(ci);
-      }
-      // resize our witness‐scratch to match new r
-      witnesses.assign(p, vector<vector<int>>(r));
+      vector<int> nextS, dropped;
+      for (int x : S) (inH[x] ? nextS : dropped).push_back(x);
+      for (int x : H) inH[x] = false;
+      layers.push_back(move(dropped));
+      S.swap(nextS);
     }
 
-    // If we exit because size<=1, then each remaining c[i][j]>0 has at most one coin
-    // in scope, so that singleton (or -1) is the answer:
+    // 5) adapted order: final S, then the dropped layers from the last round to the first
+    vector<int> newPos(n + 1);
+    vector<int> newOrder(1, cs.order[0]);
+    for (int x : S) { newPos[x] = (int)newOrder.size(); newOrder.push_back(cs.order[x]); }
+    for (int l = (int)layers.size() - 1; l >= 0; --l)
+      for (int x : layers[l]) { newPos[x] = (int)newOrder.size(); newOrder.push_back(cs.order[x]); }
+
+    // 6) minimum witness of every resolved entry under the adapted order
     for (int i = 0; i < p; ++i) {
-      for (int j = 0; j < r; ++j) {
-        if (c[i][j] > 0 && witnesses[i][j].size() == 1) {
-          res[i][j] = witnesses[i][j][0];
-        }
+      for (int j = 0; j < (int)c[i].size(); ++j) {
+        if (c[i][j] <= 0 || witnesses[i][j].empty()) continue;
+        int best = newPos[witnesses[i][j][0]];
+        for (int x : witnesses[i][j])
+          best = min(best, newPos[x]);
+        res[i][j] = best;
       }
     }
+    cs.setOrder(newOrder);
     return res;
 }
-
@@ -0,0 +1,146 @@
+#include "arena.h"
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <new>
+
+const size_t MIN_BLOCK = 64 << 10;
+const size_t BLOCK_ALIGN = 64;
+const size_t CHARGE_REFILL = 64 << 10;
+
+namespace {
+
+struct ArenaRegistry {
+    mutex lock;
+    vector<ScratchArena*> live;
+    ArenaStats retired;  ///< folded in from the arenas of threads that have exited
+};
+
+ArenaRegistry& arenaRegistry() {
+    static ArenaRegistry* reg = new ArenaRegistry(); // never destroyed, threads may exit after static destruction
+    return *reg;
+}
+
+/// Owns the arena of one thread and folds its statistics into the registry when the thread exits.
+struct ArenaHolder {
+    ScratchArena* arena;
+
+    ArenaHolder() : arena(new ScratchArena()) {
+        ArenaRegistry& reg = arenaRegistry();
+        lock_guard<mutex> g(reg.lock);
+        reg.live.push_back(arena);
+    }
+    ~ArenaHolder() {
+        ArenaRegistry& reg = arenaRegistry();
+        {
+            lock_guard<mutex> g(reg.lock);
+            erase(reg.live, arena);
+            reg.retired.threads++;
+            reg.retired.peakBytes = max(reg.retired.peakBytes, arena->peakBytes());
+            reg.retired.totalPeak += arena->peakBytes();
+            reg.retired.blockAllocations += arena->blockAllocations();
+            reg.retired.allocations += arena->allocations();
+        }
+        delete arena;
+    }
+};
+
+}
+
+ScratchArena::ScratchArena()
+  : current(0), offset(0), used(0), depth(0), subsystem(-1), charged(0), credit(0), peak(0), capacity(0), mallocs(0), requests(0)
+{}
+
+ScratchArena::~ScratchArena() {
+    for (Block& b : blocks) ::operator delete(b.data, align_val_t(BLOCK_ALIGN));
+}
+
+/// Adds to a counter only its owning thread writes: a plain load and store, no read-modify-write on the bus.
+template <typename T>
+static void bump(atomic<T>& counter, T amount) {
+    counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    bump(requests, 1LL);
+    bytes = max<size_t>(bytes, 1);
+    if (subsystem >= 0) {
+        // charge the budget a refill at a time, so most allocations touch no shared counter
+        if (bytes > credit) {
+            size_t refill = max(bytes - credit, CHARGE_REFILL);
+            memCharge((MemSubsystem)subsystem, refill);
+            charged += refill;
+            credit += refill;
+        }
+        credit -= bytes;
+    }
+    while (true) {
+        if (current < blocks.size()) {
+            Block& b = blocks[current];
+            uintptr_t at = (uintptr_t)(b.data + offset);
+            size_t pad = (alignment - at % alignment) % alignment;
+            if (offset + pad + bytes <= b.size) {
+                used += pad + bytes;
+                offset += pad + bytes;
+                if (used > peak.load(memory_order_relaxed)) peak.store(used, memory_order_relaxed);
+                return (char*)at + pad;
+            }
+            used += b.size - offset; // the tail stays unused until the mark below it is released
+            if (current + 1 < blocks.size()) {
+                current++;
+                offset = 0;
+                continue;
+            }
+        }
+        // grow geometrically, so a thread needs O(log peak) blocks before its first consolidation
+        size_t size = max({MIN_BLOCK, bytes + alignment, capacity.load(memory_order_relaxed)});
+        blocks.push_back({(char*)::operator new(size, align_val_t(BLOCK_ALIGN)), size});
+        bump(capacity, size);
+        bump(mallocs, 1LL);
+        current = blocks.size() - 1;
+        offset = 0;
+    }
+}
+
+void ScratchArena::release(const Mark& m) {
+    current = m.block;
+    offset = m.offset;
+    used = m.used;
+    if (depth > 0 || blocks.size() <= 1) return;
+    // the outermost scope ended after the arena grew: one block that holds the peak replaces them all
+    for (Block& b : blocks) ::operator delete(b.data, align_val_t(BLOCK_ALIGN));
+    blocks.clear();
+    size_t size = (peak.load(memory_order_relaxed) + MIN_BLOCK - 1) / MIN_BLOCK * MIN_BLOCK;
+    blocks.push_back({(char*)::operator new(size, align_val_t(BLOCK_ALIGN)), size});
+    capacity.store(size, memory_order_relaxed);
+    bump(mallocs, 1LL);
+    current = offset = used = 0;
+}
+
+ScratchArena& threadArena() {
+    thread_local ArenaHolder holder;
+    return *holder.arena;
+}
+
+ArenaStats arenaStats() {
+    ArenaRegistry& reg = arenaRegistry();
+    lock_guard<mutex> g(reg.lock);
+    ArenaStats st = reg.retired;
+    for (ScratchArena* a : reg.live) {
+        st.threads++;
+        st.peakBytes = max(st.peakBytes, a->peakBytes());
+        st.totalPeak += a->peakBytes();
+        st.blockAllocations += a->blockAllocations();
+        st.allocations += a->allocations();
+    }
+    return st;
+}
+
+void arenaReport(ostream& out) {
+    ArenaStats st = arenaStats();
+    out << "Scratch arenas: " << st.threads << " thread(s), peak " << fixed << setprecision(1)
+        << st.peakBytes / 1048576.0 << " MiB (sum " << st.totalPeak / 1048576.0 << " MiB), "
+        << st.allocations << " allocations served by " << st.blockAllocations << " mallocs\n";
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
@@ -0,0 +1,96 @@
+#include "batch.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static bool solvable(const Instance& inst) {
+    if (inst.t < 0 || inst.t > INT_MAX - 1) return false;
+    for (int i = 1; i <= inst.n; i++) {
+        if (inst.w[i] < 1) return false;
+    }
+    return true;
+}
+
+/// Consecutive instances [begin, end) whose estimates add up to about `budget` seconds.
+static vector<pair<int,int>> cutUnits(Problem problem, const vector<Instance>& batch, double budget,
+                                      const CostProfile& profile) {
+    vector<pair<int,int>> units;
+    double acc = 0;
+    int begin = 0;
+    for (int i = 0; i < (int)batch.size(); i++) {
+        const Instance& inst = batch[i];
+        if (solvable(inst)) {
+            InstanceStats st{inst.n, max(1, inst.u), (int)inst.t};
+            acc += profile.estimate(chooseStrategy(problem, st, profile), st);
+        }
+        if (acc >= budget) {
+            units.push_back({begin, i + 1});
+            begin = i + 1;
+            acc = 0;
+        }
+    }
+    if (begin < (int)batch.size()) units.push_back({begin, (int)batch.size()});
+    return units;
+}
+
+BatchStats solveBatch(
+    const function<bool(Instance&)>& next,
+    const function<void(ll, const SolveResult&)>& emit,
+    const BatchOptions& options
+) {
+    const CostProfile& profile = options.profile ? *options.profile : defaultCostProfile();
+    size_t window = (size_t)max(1, options.window);
+    auto readWindow = [&](vector<Instance>& into) {
+        into.clear();
+        Instance inst;
+        while (into.size() < window && next(inst)) into.push_back(move(inst));
+    };
+
+    BatchStats stats;
+    vector<Instance> current, upcoming;
+    readWindow(current);
+    while (!current.empty()) {
+        vector<pair<int,int>> units = cutUnits(options.problem, current, options.unitSeconds, profile);
+        stats.units += (ll)units.size();
+
+        vector<SolveResult> results(current.size());
+        vector<char> ready(current.size(), 0);
+        mutex lock;
+        condition_variable done;
+        thread solver([&] {
+            sharedThreadPool().parallelFor(0, (int)units.size(), [&](int x) {
+                auto [begin, end] = units[x];
+                FK_TRACE("batch unit", "batch", "instances", end - begin);
+                for (int i = begin; i < end; i++) {
+                    const Instance& inst = current[i];
+                    if (solvable(inst)) {
+                        results[i] = solve(options.problem, inst.n, inst.w, inst.p, (int)inst.t, profile);
+                    } else {
+                        results[i] = SolveResult{Strategy::Classical, {}};
+                    }
+                }
+                {
+                    lock_guard<mutex> g(lock);
+                    fill(ready.begin() + begin, ready.begin() + end, 1);
+                }
+                done.notify_all();
+            });
+        });
+
+        readWindow(upcoming); // overlaps with the solving
+        for (size_t i = 0; i < current.size(); i++) {
+            {
+                unique_lock<mutex> g(lock);
+                done.wait(g, [&] { return ready[i] != 0; });
+            }
+            emit(stats.instances + (ll)i, results[i]);
+            vector<ll>().swap(results[i].value); // emitted results do not wait for the rest of the window
+        }
+        solver.join();
+        stats.instances += (ll)current.size();
+        swap(current, upcoming);
+    }
+    return stats;
+}
@@ -0,0 +1,135 @@
+#include "bounded.h"
+#include "algorithms.h"
+#include "dispatch.h"
+#include <bit>
+
+BoundedKnapsack::BoundedKnapsack()
+  : n(0), t(0), value(), keptDecisions(false), charge(MemSubsystem::Solutions)
+{}
+
+bool BoundedKnapsack::decisionsKept() const {
+    return capped.empty() || keptDecisions;
+}
+
+vector<ll> BoundedKnapsack::counts(int c) const {
+    if (c < 0 || c > t || value[c] == NEG_INF) return {};
+    if (!decisionsKept()) return {};
+    vector<ll> cnt(n + 1, 0);
+    for (int i = (int)capped.size() - 1; i >= 0; i--) {
+        const Capped& C = capped[i];
+        size_t bit = (size_t)c * C.bits;
+        ll k = decisions[C.offset + bit / 64] >> (bit % 64) & ((1ULL << C.bits) - 1); // bits ≤ 32
+        cnt[C.item] += k;
+        c -= (int)(k * C.w);
+    }
+    for (auto const& C : base[c].svec) {
+        cnt[unboundedItem[C.first]] += C.second;
+    }
+    return cnt;
+}
+
+void solveBoundedKnapsack(
+    int n,
+    const vector<int>& w,
+    const vector<int>& p,
+    const vector<int>& cap,
+    int t,
+    bool keepDecisions,
+    BoundedKnapsack& bk
+) {
+    bk.n = n;
+    bk.t = t;
+    bk.capped.clear();
+    bk.decisions.clear();
+    bk.keptDecisions = false;
+
+    // 1) split the items: unbounded ones go to the kernel, the others are folded in one by one
+    vector<int> unbounded;
+    vector<pair<int, int>> folded; // (item, copies that can matter)
+    int maxUnboundedWeight = 1;
+    for (int i = 1; i <= n; i++) {
+        if (w[i] > t || cap[i] == 0) continue;
+        if (cap[i] < 0 || (ll)cap[i] * w[i] >= t) {
+            unbounded.push_back(i);
+            maxUnboundedWeight = max(maxUnboundedWeight, w[i]);
+        } else {
+            folded.push_back({i, cap[i]});
+        }
+    }
+    // few or light unbounded items are cheaper to fold in too, as items of t / w_i copies (like dispatch.cpp)
+    InstanceStats st{(int)unbounded.size(), maxUnboundedWeight, t};
+    const CostProfile& profile = defaultCostProfile();
+    if (!unbounded.empty() && profile.estimate(Strategy::Kernel, st) >= profile.estimate(Strategy::Classical, st)) {
+        for (int i : unbounded) folded.push_back({i, t / w[i]});
+        unbounded.clear();
+    }
+    vector<int> uw(1, 0), up(1, 0);
+    bk.unboundedItem.assign(1, 0);
+    for (int i : unbounded) {
+        uw.push_back(w[i]);
+        up.push_back(p[i]);
+        bk.unboundedItem.push_back(i);
+    }
+    size_t words = 0;
+    for (auto [i, copies] : folded) {
+        int bits = (int)bit_ceil((unsigned)bit_width((unsigned)copies));
+        bk.capped.push_back({i, w[i], copies, bits, words});
+        words += ((size_t)t + 1) * bits / 64 + 1;
+    }
+
+    // 2) unbounded items: Algorithm 2 + Algorithm 1 over [0, t]
+    int un = (int)uw.size() - 1;
+    bk.value.assign(t + 1, NEG_INF);
+    bk.value[0] = 0;
+    if (un > 0) {
+        vector<int> order(un + 1);
+        for (int x = 1; x <= un; x++) order[x] = x;
+        CoinSet cs(un, 0, uw, up, order);
+        kernelComputation_knapsack(cs, t, bk.base);
+        propagation(cs, t, bk.base);
+        for (int c = 1; c <= t; c++) {
+            if (bk.base[c].size > 0) bk.value[c] = bk.base[c].value;
+        }
+    } else {
+        bk.base.assign(t + 1, solution());
+    }
+    size_t tables = solutionTableBytes(bk.base, 0, t) + bk.value.size() * sizeof(ll);
+    bk.charge.set(tables);
+
+    // the decisions are only kept if they fit what is left of the budget
+    size_t decisionBytes = words * sizeof(unsigned long long);
+    bk.keptDecisions = keepDecisions && !bk.capped.empty() && decisionBytes <= memoryAvailable();
+    if (bk.keptDecisions) {
+        bk.decisions.assign(words, 0);
+        bk.charge.set(tables + decisionBytes);
+    }
+
+    // 3) one pass per capped item: along every residue class r + j·w, the best of v[r + j'·w] + (j - j')·p over
+    //    j' ∈ [j - cap, j] is the front of a queue of j' decreasing in v[r + j'·w] - j'·p; the queue holds the
+    //    values from before the item, so the class is updated in place
+    vector<ll>& v = bk.value;
+    vector<int> qj(t + 1);
+    vector<ll> qv(t + 1);
+    for (auto& C : bk.capped) {
+        int wi = C.w, ci = C.cap;
+        ll pi = p[C.item];
+        for (int r = 0; r < wi && r <= t; r++) {
+            int head = 0, tail = 0;
+            for (int j = 0, c = r; c <= t; j++, c += wi) {
+                if (v[c] != NEG_INF) {
+                    ll key = v[c] - j * pi;
+                    while (tail > head && qv[tail - 1] <= key) tail--; // ties keep the fewer copies
+                    qj[tail] = j;
+                    qv[tail++] = key;
+                }
+                while (head < tail && qj[head] < j - ci) head++;
+                if (head == tail) continue;
+                v[c] = qv[head] + j * pi;
+                if (bk.keptDecisions) {
+                    size_t bit = (size_t)c * C.bits;
+                    bk.decisions[C.offset + bit / 64] |= (unsigned long long)(j - qj[head]) << (bit % 64);
+                }
+            }
+        }
+    }
+}
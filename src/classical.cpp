@@ -0,0 +1,29 @@
+#include "classical.h"
+
+vector<ll> classicalKnapsack(int n, const vector<int>& w, const vector<int>& p, int t) {
+    vector<ll> dp(t + 1, NEG_INF);
+    dp[0] = 0;
+    for (int i = 1; i <= n; i++) {
+        for (int c = w[i]; c <= t; ++c) {
+            if (dp[c - w[i]] > NEG_INF)
+                dp[c] = max(dp[c], dp[c - w[i]] + p[i]);
+        }
+    }
+    return dp;
+}
+
+vector<ll> classicalCoinChange(int n, const vector<int>& w, int t) {
+    const ll INF = LLONG_MAX;
+    vector<ll> dp(t + 1, INF);
+    dp[0] = 0;
+    for (int i = 1; i <= n; i++) {
+        for (int c = w[i]; c <= t; c++) {
+            if (dp[c - w[i]] != INF)
+                dp[c] = min(dp[c], dp[c - w[i]] + 1);
+        }
+    }
+    for (ll& x : dp) {
+        if (x == INF) x = -1;
+    }
+    return dp;
+}
@@ -0,0 +1,48 @@
+#include "coin_set.h"
+
+CoinSet::CoinSet()
+  : n(0), u(0)
+{}
+
+CoinSet::CoinSet(int n, int u, const vector<int>& w, const vector<int>& p, const vector<int>& order)
+  : n(n), u(u), w(w), p(p)
+{
+    for (int x = 1; x <= n; x++) {
+        this->u = max(this->u, w[order[x]]);
+    }
+    this->p.resize(w.size());
+    f.assign(this->u + 1, 0);
+    for (int x = 1; x <= n; x++) {
+        f[w[order[x]]] = 1;
+    }
+    setOrder(order);
+}
+
+void CoinSet::setOrder(const vector<int>& order) {
+    this->order = order;
+    inverseOrder.assign(w.size(), 0);
+    for (int x = 1; x <= n; x++) {
+        inverseOrder[order[x]] = x;
+    }
+
+    // counting sort of the order indices by weight
+    weightStart.assign(u + 2, 0);
+    for (int x = 1; x <= n; x++) {
+        weightStart[weightAt(x) + 1]++;
+    }
+    for (int i = 1; i <= u + 1; i++) {
+        weightStart[i] += weightStart[i - 1];
+    }
+    byWeight.resize(n);
+    vector<int> fill(weightStart.begin(), weightStart.end() - 1);
+    for (int x = 1; x <= n; x++) {
+        byWeight[fill[weightAt(x)]++] = x;
+    }
+
+    indexOfWeight.assign(u + 1, -1);
+    for (int i = 0; i <= u; i++) {
+        if (weightStart[i] < weightStart[i + 1]) {
+            indexOfWeight[i] = byWeight[weightStart[i]];
+        }
+    }
+}
@@ -1,15 +1,36 @@
 #include "convolution.h"
+#include "thread_pool.h"
+#include "instrument.h"
+#include "trace.h"
+#include "arena.h"
+#include <memory>
+#include <mutex>
 
-void fft(vector<C>& a) {
-	int n = sz(a), L = 31 - __builtin_clz(n);
+// Roots of unity shared by all threads; grown under a lock and published as an immutable snapshot
+static shared_ptr<const vector<C>> fftRoots(int n) {
+	static mutex lock;
 	static vector<complex<long double>> R(2, 1);
-	static vector<C> rt(2, 1);  // (^ 10% faster if double)
-	for (static int k = 2; k < n; k *= 2) {
+	static shared_ptr<const vector<C>> snapshot = make_shared<const vector<C>>(2, 1);
+	lock_guard<mutex> g(lock);
+	if (sz(*snapshot) < n) {
+		vector<C> rt(*snapshot);  // (^ 10% faster if double)
+		int k = sz(rt);
 		R.resize(n); rt.resize(n);
-		auto x = polar(1.0L, acos(-1.0L) / k);
-		rep(i,k,2*k) rt[i] = R[i] = i&1 ? R[i/2] * x : R[i/2];
+		for (; k < n; k *= 2) {
+			auto x = polar(1.0L, acos(-1.0L) / k);
+			rep(i,k,2*k) rt[i] = R[i] = i&1 ? R[i/2] * x : R[i/2];
+		}
+		snapshot = make_shared<const vector<C>>(move(rt));
 	}
-	vi rev(n);
+	return snapshot;
+}
+
+static void fftInPlace(C* a, int n) {
+	int L = 31 - __builtin_clz(n);
+	auto roots = fftRoots(n);
+	const vector<C>& rt = *roots;
+	ArenaScope scratch(MemSubsystem::Convolution);
+	pmr::vector<int> rev(n, scratch.resource());
 	rep(i,0,n) rev[i] = (rev[i / 2] | (i & 1) << L) / 2;
 	rep(i,0,n) if (i < rev[i]) swap(a[i], a[rev[i]]);
 	for (int k = 1; k < n; k *= 2)
@@ -22,41 +43,122 @@ void fft(vector<C>& a) {
 		}
 }
 
-vd conv(const vd& a, const vd& b) {
-	if (a.empty() || b.empty()) return {};
-	vd res(sz(a) + sz(b) - 1);
+void fft(vector<C>& a) {
+	fftInPlace(a.data(), sz(a));
+}
+
+// res = a * b with |res| = |a| + |b| - 1; the transform buffers live in the thread's scratch arena
+static void convInto(span<const double> a, span<const double> b, span<double> res) {
 	int L = 32 - __builtin_clz(sz(res)), n = 1 << L;
-	vector<C> in(n), out(n);
+	FK_HISTOGRAM("conv.fft", n);
+	FK_TRACE("fft", "conv", "n", n);
+	ArenaScope scratch(MemSubsystem::Convolution);
+	pmr::vector<C> in(n, scratch.resource()), out(n, scratch.resource());
 	copy(all(a), begin(in));
 	rep(i,0,sz(b)) in[i].imag(b[i]);
-	fft(in);
+	fftInPlace(in.data(), n);
 	for (C& x : in) x *= x;
 	rep(i,0,n) out[i] = in[-i & (n - 1)] - conj(in[i]);
-	fft(out);
+	fftInPlace(out.data(), n);
 	rep(i,0,sz(res)) res[i] = imag(out[i]) / (4 * n);
+}
+
+vd conv(const vd& a, const vd& b) {
+	if (a.empty() || b.empty()) return {};
+	vd res(sz(a) + sz(b) - 1);
+	convInto(a, b, res);
 	return res;
 }
 
-vector<int> convolution(const vector<int>& a, const vector<int>& b) {
-	vd a_D(a.size());
-    for (int i = 0; i < a.size(); i++) {
-        a_D[i] = (double)a[i];
-    }
-    vd b_D(b.size());
-    for (int i = 0; i < b.size(); i++) {
-        b_D[i] = (double)b[i];
-    }
-    vd c_D = conv(a_D, b_D);
-    vi c(c_D.size());
-    for (int i = 0; i < c_D.size(); i++) {
-        c[i] = (int)(c_D[i] + 0.5);
-    }
-    return c;
+/// Scratch bytes of convInto() on operands of `len` and `other` entries, with the double copies of intConv().
+static size_t convBytes(size_t len, size_t other) {
+	size_t res = len + other - 1, n = size_t(1) << (32 - __builtin_clz((unsigned)res));
+	return n * (2 * sizeof(C) + sizeof(int)) + (len + other + res) * sizeof(double);
+}
+
+/// Entries of the longer operand convolved per FFT: all of them, unless that does not fit the memory budget;
+/// then the largest power of two that fits, but not below the length of the shorter operand.
+static size_t convChunk(size_t len, size_t other) {
+	size_t avail = memoryAvailable();
+	if (convBytes(len, other) <= avail) return len;
+	size_t chunk = size_t(1) << (63 - __builtin_clzll(len));
+	while (chunk > other && convBytes(chunk, other) > avail) chunk /= 2;
+	FK_COUNT("memory.conv.chunked", (len + chunk - 1) / chunk);
+	return max(chunk, min(len, other));
+}
+
+/**
+ * Product of two int sequences through the double FFT; `acc(out[i], x)` folds the real product entry x into
+ * the zeroed output. Under a tight memory budget the longer operand is cut into chunks (overlap-add), every
+ * chunk rounded on its own, so the result does not depend on the chunking.
+ */
+template <typename Acc>
+static void intConv(span<const int> a, span<const int> b, span<int> out, Acc acc) {
+	if (a.empty() || b.empty()) return;
+	if (a.size() < b.size()) swap(a, b);
+	size_t chunk = convChunk(a.size(), b.size());
+	ArenaScope scratch(MemSubsystem::Convolution);
+	pmr::vector<double> aD(chunk, scratch.resource());
+	pmr::vector<double> bD(b.begin(), b.end(), scratch.resource());
+	pmr::vector<double> cD(chunk + b.size() - 1, scratch.resource());
+	fill(out.begin(), out.end(), 0);
+	for (size_t lo = 0; lo < a.size(); lo += chunk) {
+		size_t len = min(chunk, a.size() - lo), res = len + b.size() - 1;
+		copy_n(a.begin() + lo, len, aD.begin());
+		convInto(span<const double>(aD.data(), len), bD, span<double>(cD.data(), res));
+		rep(i,0,(int)res) acc(out[lo + i], cD[i]);
+	}
+}
+
+static void addInt(int& to, double x) { to += (int)(x + 0.5); }
+static void orBool(int& to, double x) { to |= x + 0.5 >= 1 ? 1 : 0; }
+
+static size_t convSize(span<const int> a, span<const int> b) {
+	return a.empty() || b.empty() ? 0 : a.size() + b.size() - 1;
+}
+
+vector<int> convolution(span<const int> a, span<const int> b) {
+	FK_HISTOGRAM("conv.int", a.size() + b.size());
+	vi c(convSize(a, b));
+	intConv(a, b, c, addInt);
+	return c;
+}
+
+void convolution(span<const int> a, span<const int> b, span<int> out) {
+	FK_HISTOGRAM("conv.int", a.size() + b.size());
+	intConv(a, b, out, addInt);
+}
+
+FixedOperandConv::FixedOperandConv(span<const int> b, int maxA, pmr::memory_resource* mem)
+  : n(1 << (32 - __builtin_clz(max(1, maxA + sz(b) - 1)))), bLen(sz(b)), bHat(n, mem)
+{
+	rep(i,0,bLen) bHat[i] = b[i];
+	fftInPlace(bHat.data(), n);
+}
+
+void FixedOperandConv::pair(span<const int> a1, span<const int> a2, span<int> out1, span<int> out2) const {
+	FK_HISTOGRAM("conv.fixed_pair", n);
+	ArenaScope scratch(MemSubsystem::Convolution);
+	pmr::vector<C> x(n, scratch.resource());
+	rep(i,0,sz(a1)) x[i] = C(a1[i], a2[i]);
+	fftInPlace(x.data(), n);
+	rep(i,0,n) x[i] *= bHat[i];
+	// the inverse through the forward transform: entry k of the inverse is entry -k of the forward, over n
+	fftInPlace(x.data(), n);
+	int res = sz(a1) + bLen - 1;
+	rep(k,0,res) {
+		C y = x[-k & (n - 1)] / (double)n;
+		out1[k] = (int)llround(real(y));
+		out2[k] = (int)llround(imag(y));
+	}
 }
 
 // (max, +) convolution
 vector<ll> maxPlusCnv(const vector<ll>& a, const vector<ll>& b) {
     int n = (int)a.size(), m = (int)b.size(), N = n + m - 1;
+    FK_HISTOGRAM("conv.maxplus", N);
+    FK_COUNT("conv.maxplus.pairs", (ll)n * m);
+    FK_TRACE("maxplus", "conv", "n", n, "m", m);
     vector<ll> c(N, NEG_INF);
     for (int i = 0; i < n; i++) {
         for (int j = 0; j < m; j++) {
@@ -69,22 +171,211 @@ vector<ll> maxPlusCnv(const vector<ll>& a, const vector<ll>& b) {
     return c;
 }
 
-// Boolean OR‐convolution
-vector<int> boolCnv(const vector<int>& a, const vector<int>& b) {
-    vd a_D(a.size());
-    for (int i = 0; i < a.size(); i++) {
-        a_D[i] = (double)a[i];
-    }
-    vd b_D(b.size());
-    for (int i = 0; i < b.size(); i++) {
-        b_D[i] = (double)b[i];
-    }
-    vd c_D = conv(a_D, b_D);
-    vi c(c_D.size());
-    for (int i = 0; i < c_D.size(); i++) {
-        if (c_D[i] + 0.5 >= 1) {
-            c[i] = 1;
+// (max, +) convolution with min-witness tie-breaking
+vector<ll> maxPlusCnv_minWitness(const vector<ll>& a, const vector<ll>& b, const vector<int>& bWit, vector<int>& witness) {
+    int n = (int)a.size(), m = (int)b.size(), N = n + m - 1;
+    FK_HISTOGRAM("conv.maxplus", N);
+    FK_COUNT("conv.maxplus.pairs", (ll)n * m);
+    FK_TRACE("maxplus_min_witness", "conv", "n", n, "m", m);
+    vector<ll> c(N, NEG_INF);
+    witness.assign(N, -1);
+    for (int i = 0; i < n; i++) {
+        if (a[i] == NEG_INF) continue;
+        for (int j = 0; j < m; j++) {
+            if (b[j] == NEG_INF) continue;
+            ll val = a[i] + b[j];
+            if (val > c[i + j] || (val == c[i + j] && bWit[j] < witness[i + j])) {
+                c[i + j] = val;
+                witness[i + j] = bWit[j];
+            }
         }
     }
     return c;
 }
+
+// Boolean OR‐convolution
+vector<int> boolCnv(span<const int> a, span<const int> b) {
+	FK_HISTOGRAM("conv.bool", a.size() + b.size());
+	vi c(convSize(a, b));
+	intConv(a, b, c, orBool);
+	return c;
+}
+
+void boolCnv(span<const int> a, span<const int> b, span<int> out) {
+	FK_HISTOGRAM("conv.bool", a.size() + b.size());
+	intConv(a, b, out, orBool);
+}
+
+static ll modpow(ll b, ll e) {
+	ll ans = 1;
+	for (b %= NTT_MOD; e; b = b * b % NTT_MOD, e /= 2)
+		if (e & 1) ans = ans * b % NTT_MOD;
+	return ans;
+}
+
+// NTT roots, shared by all threads like fftRoots()
+static shared_ptr<const vector<ll>> nttRoots(int n) {
+	static mutex lock;
+	static shared_ptr<const vector<ll>> snapshot = make_shared<const vector<ll>>(2, 1);
+	lock_guard<mutex> g(lock);
+	if (sz(*snapshot) < n) {
+		vector<ll> rt(*snapshot);
+		int k = sz(rt), s = __builtin_ctz(k) + 1;
+		rt.resize(n);
+		for (; k < n; k *= 2, s++) {
+			ll z[] = {1, modpow(NTT_ROOT, NTT_MOD >> s)};
+			rep(i,k,2*k) rt[i] = rt[i / 2] * z[i & 1] % NTT_MOD;
+		}
+		snapshot = make_shared<const vector<ll>>(move(rt));
+	}
+	return snapshot;
+}
+
+// transforms of at least this size split every level of butterflies over the shared thread pool
+const int NTT_PARALLEL_MIN = 1 << 16;
+
+void ntt(vector<ll>& a) {
+	int n = sz(a), L = 31 - __builtin_clz(n);
+	auto roots = nttRoots(n);
+	const vector<ll>& rt = *roots;
+	vi rev(n);
+	rep(i,0,n) rev[i] = (rev[i / 2] | (i & 1) << L) / 2;
+	rep(i,0,n) if (i < rev[i]) swap(a[i], a[rev[i]]);
+	ThreadPool& pool = sharedThreadPool();
+	int chunks = n >= NTT_PARALLEL_MIN && pool.size() > 1 ? 4 * pool.size() : 1;
+	ll* A = a.data();
+	const ll* RT = rt.data();
+	for (int k = 1; k < n; k *= 2) {
+		// butterfly b pairs a[i + j] and a[i + j + k] with i = (b / k) * 2k, j = b % k
+		auto level = [&](int c) {
+			int lo = (int)((ll)(n / 2) * c / chunks), hi = (int)((ll)(n / 2) * (c + 1) / chunks);
+			for (int b = lo; b < hi; ) {
+				int j0 = b & (k - 1), i = (b - j0) * 2, j1 = min(k, j0 + hi - b);
+				rep(j,j0,j1) {
+					// unsigned products reduce faster than signed ones
+					ll z = (ll)((unsigned long long)RT[j + k] * (unsigned long long)A[i + j + k] % NTT_MOD), &ai = A[i + j];
+					A[i + j + k] = ai - z + (z > ai ? NTT_MOD : 0);
+					ai += (ai + z >= NTT_MOD ? z - NTT_MOD : z);
+				}
+				b += j1 - j0;
+			}
+		};
+		if (chunks == 1) level(0);
+		else pool.parallelFor(0, chunks, level);
+	}
+}
+
+vector<ll> nttConv(const vector<ll>& a, const vector<ll>& b) {
+	if (a.empty() || b.empty()) return {};
+	int s = sz(a) + sz(b) - 1, B = 32 - __builtin_clz(s), n = 1 << B;
+	FK_HISTOGRAM("conv.ntt", n);
+	FK_TRACE("ntt", "conv", "n", n);
+	ll inv = modpow(n, NTT_MOD - 2);
+	vector<ll> L(a), R(b), out(n);
+	L.resize(n), R.resize(n);
+	ntt(L), ntt(R);
+	rep(i,0,n) out[-i & (n - 1)] = L[i] * R[i] % NTT_MOD * inv % NTT_MOD;
+	ntt(out);
+	return {out.begin(), out.begin() + s};
+}
+
+// Newton iteration b <- b (2 - a b)
+vector<ll> polyInverse(const vector<ll>& a, int n) {
+	vector<ll> b(1, modpow(a[0], NTT_MOD - 2));
+	for (int m = 1; m < n; m *= 2) {
+		vector<ll> head(a.begin(), a.begin() + min(sz(a), 2 * m));
+		vector<ll> ab = nttConv(head, b);
+		ab.resize(2 * m);
+		for (ll& x : ab) x = (NTT_MOD - x) % NTT_MOD;
+		ab[0] = (ab[0] + 2) % NTT_MOD;
+		b = nttConv(b, ab);
+		b.resize(2 * m);
+	}
+	b.resize(n);
+	return b;
+}
+
+// ln a = ∫ a' / a
+vector<ll> polyLog(const vector<ll>& a, int n) {
+	vector<ll> da(max(1, min(sz(a), n + 1) - 1));
+	rep(i,1,min(sz(a), n + 1)) da[i - 1] = a[i] * i % NTT_MOD;
+	vector<ll> q = nttConv(da, polyInverse(a, n));
+	vector<ll> res(n, 0);
+	rep(i,1,n) res[i] = q[i - 1] * modpow(i, NTT_MOD - 2) % NTT_MOD;
+	return res;
+}
+
+// inverse transform of ntt()
+static void intt(vector<ll>& a) {
+	int n = sz(a);
+	ntt(a);
+	reverse(a.begin() + 1, a.end());
+	ll inv = modpow(n, NTT_MOD - 2);
+	for (ll& x : a) x = x * inv % NTT_MOD;
+}
+
+static void pointwise(vector<ll>& a, const vector<ll>& b) {
+	rep(i,0,sz(a)) a[i] = a[i] * b[i] % NTT_MOD;
+}
+
+/**
+ * Newton iteration b <- b (1 - ln b + a), which doubles the precision m of b = exp a every round.
+ * h = 1/b is carried along (one Newton step per round), and since ln b ≡ a mod x^m only the coefficients
+ * [m, 2m) of ln b are computed: (ln b)' = r + h (b' - b r) mod x^{2m-1}, where r = a' mod x^{m-1} and
+ * b' - b r = O(x^{m-1}). All products are cyclic transforms whose wrapped coefficients are never read.
+ */
+vector<ll> polyExp(const vector<ll>& a, int n) {
+	auto coef = [&](int i) { return i < sz(a) ? a[i] : 0LL; };
+	int N = 1;
+	while (N < n) N *= 2;
+	vector<ll> inv(N + 1, 1);
+	rep(i,2,N+1) inv[i] = (NTT_MOD - NTT_MOD / i) * inv[NTT_MOD % i] % NTT_MOD;
+
+	vector<ll> b(1, 1), h(1, 1); // b = exp a mod x^m, h = 1/b mod x^{m/2} (mod x at m = 1)
+	for (int m = 1; m < n; m *= 2) {
+		// 1) h <- h (2 - b h) mod x^m; coefficients [m/2, m) of both products are exact
+		if (m > 1) {
+			vector<ll> B(b), H(h), e(m);
+			H.resize(m);
+			ntt(B), ntt(H);
+			rep(i,0,m) e[i] = B[i] * H[i] % NTT_MOD;
+			intt(e);
+			fill(e.begin(), e.begin() + m / 2, 0);
+			ntt(e);
+			pointwise(e, H);
+			intt(e);
+			h.resize(m);
+			rep(i,m/2,m) h[i] = (NTT_MOD - e[i]) % NTT_MOD;
+		}
+
+		// 2) T = h (b' - b r) / x^{m-1}, so that (ln b)'[d] = T[d - m + 1] for d ∈ [m-1, 2m-1)
+		vector<ll> B(b), R(2 * m, 0), T(2 * m, 0), H(h);
+		B.resize(2 * m), H.resize(2 * m);
+		rep(i,0,m-1) R[i] = coef(i + 1) * (i + 1) % NTT_MOD;
+		ntt(B), ntt(R);
+		pointwise(R, B);
+		intt(R);
+		rep(i,0,m) {
+			int d = m - 1 + i;
+			ll db = d + 1 < m ? b[d + 1] * (d + 1) % NTT_MOD : 0;
+			T[i] = (db - R[d] + NTT_MOD) % NTT_MOD;
+		}
+		ntt(T), ntt(H);
+		pointwise(T, H);
+		intt(T);
+
+		// 3) b <- b + b·D mod x^{2m}, where D = a - ln b vanishes below x^m
+		vector<ll> D(2 * m, 0);
+		rep(i,0,m) {
+			ll lnb = T[i] * inv[m + i] % NTT_MOD; // (ln b)[m + i] = (ln b)'[m + i - 1] / (m + i)
+			D[i] = (coef(m + i) - lnb + NTT_MOD) % NTT_MOD;
+		}
+		ntt(D);
+		pointwise(D, B);
+		intt(D);
+		b.resize(2 * m);
+		rep(i,0,m) b[m + i] = D[i];
+	}
+	b.resize(n);
+	return b;
+}
@@ -0,0 +1,335 @@
+#include "dispatch.h"
+#include "algorithms.h"
+#include "classical.h"
+#include "small_u.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+const char* strategyName(Strategy s) {
+    switch (s) {
+        case Strategy::Classical: return "classical";
+        case Strategy::Kernel: return "kernel";
+        case Strategy::CoinChangeSimple: return "simple";
+        case Strategy::CoinChangeRandomized: return "randomized";
+        case Strategy::CoinChangeAdaptive: return "adaptive";
+        case Strategy::CoinChangeSmallU: return "smallu";
+    }
+    return "?";
+}
+
+InstanceStats instanceStats(const ReducedInstance& ri, int t) {
+    return InstanceStats{ri.n, ri.u, static_cast<int>(t / ri.g)};
+}
+
+CostProfile::CostProfile()
+  : classical(1.15e-9), propagation(7.15e-8), kernel(2.94e-10),
+    simple(8.95e-10), randomized(5.30e-8), adaptive(8.25e-9), smallU(1.98e-8)
+{}
+
+static const pair<const char*, double CostProfile::*> PROFILE_TERMS[] = {
+    {"classical", &CostProfile::classical},
+    {"propagation", &CostProfile::propagation},
+    {"kernel", &CostProfile::kernel},
+    {"simple", &CostProfile::simple},
+    {"randomized", &CostProfile::randomized},
+    {"adaptive", &CostProfile::adaptive},
+    {"smallu", &CostProfile::smallU},
+};
+
+bool CostProfile::load(const string& path) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    while (getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        istringstream ls(line);
+        string key;
+        double v;
+        if (!(ls >> key >> v)) continue;
+        for (auto& [name, field] : PROFILE_TERMS) {
+            if (key == name) this->*field = v;
+        }
+    }
+    return true;
+}
+
+bool CostProfile::save(const string& path) const {
+    ofstream out(path);
+    if (!out) return false;
+    out << "# seconds per unit of every cost model term, see dispatch.h\n";
+    out.precision(6);
+    for (auto& [name, field] : PROFILE_TERMS) {
+        out << name << " " << this->*field << "\n";
+    }
+    return (bool)out;
+}
+
+double CostProfile::estimate(Strategy s, const InstanceStats& st) const {
+    double n = st.n, t = st.t;
+    double L = log2(max(2, st.u));
+    double k = floor(2 * L + 1);
+    double K = k * st.u + 1;
+    double lgK = log2(K);
+    double prop = propagation * t * (L + 1);
+    switch (s) {
+        case Strategy::Classical:
+            return classical * (n + 1) * t;
+        case Strategy::Kernel:
+            return kernel * k * K * st.u + prop;
+        case Strategy::CoinChangeSimple:
+            return simple * k * K * sqrt(n) * lgK + prop;
+        case Strategy::CoinChangeRandomized:
+            return randomized * k * K * lgK * lgK + prop;
+        case Strategy::CoinChangeAdaptive:
+            return adaptive * k * K * lgK * lgK * L + prop;
+        case Strategy::CoinChangeSmallU:
+            return smallU * t * (L + 1 + ceil(n / 64));
+    }
+    return 0;
+}
+
+const CostProfile& defaultCostProfile() {
+    static CostProfile profile = [] {
+        CostProfile cp;
+        const char* env = getenv("FASTKNAPSACK_PROFILE");
+        if (env && *env && !cp.load(env)) {
+            cerr << "FASTKNAPSACK_PROFILE: cannot read " << env << ", using the built-in cost profile\n";
+        }
+        return cp;
+    }();
+    return profile;
+}
+
+Strategy chooseStrategy(Problem problem, const InstanceStats& st, const CostProfile& profile) {
+    vector<Strategy> candidates = {Strategy::Classical};
+    if (problem == Problem::Knapsack) {
+        candidates.push_back(Strategy::Kernel);
+    } else {
+        candidates.push_back(Strategy::CoinChangeSimple);
+        candidates.push_back(Strategy::CoinChangeRandomized);
+        // not CoinChangeAdaptive: the dilution rounds of randomized_k_witness() keep it far behind the √n
+        // kernel, and a mis-calibrated profile must not route real instances to it
+        if (st.u <= SMALL_U_MAX) candidates.push_back(Strategy::CoinChangeSmallU);
+    }
+    Strategy best = candidates[0];
+    for (Strategy s : candidates) {
+        if (profile.estimate(s, st) < profile.estimate(best, st)) best = s;
+    }
+    return best;
+}
+
+static bool kernelPath(Strategy s) {
+    return s == Strategy::Kernel || s == Strategy::CoinChangeSimple || s == Strategy::CoinChangeRandomized
+        || s == Strategy::CoinChangeAdaptive;
+}
+
+MemoryEstimate estimateMemory(Strategy s, const InstanceStats& st, bool streamed) {
+    double n = st.n, u = max(1, st.u), t = st.t;
+    double L = log2(max(2, st.u));
+    double k = floor(2 * L + 1);
+    double K = k * u + 1;
+    double R = K + u;                  // widest convolution result (frontier window + coin indicator)
+    double supp = min(n, (floor(L) + 1) / 2); // supports average about half of the log₂ u + 1 bound
+    double perSolution = sizeof(solution) + supp * SVEC_NODE_BYTES;
+    double values = 2 * (t + 1) * sizeof(ll); // reduced values and the values of the original targets
+    double fft = exp2(ceil(log2(R + 1))) * (2 * sizeof(complex<double>) + sizeof(int)) + 3 * R * sizeof(double);
+
+    MemoryEstimate est;
+    double rows = max(K, t + 1);
+    if (streamed && kernelPath(s)) rows = K + u + 1;
+    switch (s) {
+        case Strategy::Classical:
+            est[MemSubsystem::Solutions] = (size_t)(values + (t + 1) * sizeof(ll));
+            break;
+        case Strategy::Kernel:
+            est[MemSubsystem::Solutions] = (size_t)(rows * perSolution + values);
+            est[MemSubsystem::Convolution] = (size_t)(4 * R * sizeof(ll));
+            break;
+        case Strategy::CoinChangeSimple:
+            est[MemSubsystem::Solutions] = (size_t)(rows * perSolution + values);
+            est[MemSubsystem::Convolution] = (size_t)fft;
+            est[MemSubsystem::Witness] = (size_t)(R * (3 * sizeof(int) + 1) + (n + u) * sizeof(int));
+            break;
+        case Strategy::CoinChangeRandomized:
+            // one witness set per result entry, each up to supp witnesses
+            est[MemSubsystem::Solutions] = (size_t)(rows * perSolution + values);
+            est[MemSubsystem::Convolution] = (size_t)fft;
+            est[MemSubsystem::Witness] = (size_t)(R * (56 + 16 + supp * 32 + 4 * sizeof(int)));
+            break;
+        case Strategy::CoinChangeAdaptive: {
+            // the k rows of Algorithm 4 and up to kw witnesses per entry of every row
+            double kw = 2 * ceil(log2(k) + log2(R));
+            est[MemSubsystem::Solutions] = (size_t)(rows * perSolution + values);
+            est[MemSubsystem::Convolution] = (size_t)fft;
+            est[MemSubsystem::Witness] = (size_t)(k * R * (3 * sizeof(int) + sizeof(vector<int>) + kw * sizeof(int)));
+            break;
+        }
+        case Strategy::CoinChangeSmallU:
+            est[MemSubsystem::Solutions] = (size_t)(K * perSolution + values + u * sizeof(ll));
+            break;
+    }
+    return est;
+}
+
+bool streamsTargets(Strategy s, const InstanceStats& st) {
+    return memoryBudget() > 0 && kernelPath(s) && estimateMemory(s, st).total() > memoryAvailable();
+}
+
+/// Runs `strategy` on the reduced instance and maps the values back to the targets [0..t].
+/// The small-u engine falls back to the simplified kernel (and says so in `strategy`) if u is too large;
+/// a kernel path over the memory budget streams the targets through propagationStreamed() (`streamed`).
+static vector<ll> runReduced(Strategy& strategy, Problem problem, const ReducedInstance& ri, int t, bool& streamed) {
+    int rt = static_cast<int>(t / ri.g);
+    if (strategy == Strategy::CoinChangeSmallU && ri.u > SMALL_U_MAX) strategy = Strategy::CoinChangeSimple;
+    streamed = streamsTargets(strategy, instanceStats(ri, t));
+    ll empty = problem == Problem::Knapsack ? (ll)NEG_INF : -1;
+    MemoryCharge tables(MemSubsystem::Solutions);
+    vector<ll> reduced;
+    if (streamed) {
+        // the kernel alone (t = 0), then Algorithm 1 through a window of u + 1 solutions
+        CoinSet cs = ri.coins();
+        vector<solution> kernel;
+        switch (strategy) {
+            case Strategy::Kernel: kernelComputation_knapsack(cs, 0, kernel); break;
+            case Strategy::CoinChangeSimple: kernelComputation_coinchange_simple(cs, 0, kernel); break;
+            case Strategy::CoinChangeRandomized: kernelComputation_coinchange_randomized(cs, 0, kernel); break;
+            case Strategy::CoinChangeAdaptive: kernelComputation_coinchange(cs, 0, kernel); break;
+            case Strategy::Classical:
+            case Strategy::CoinChangeSmallU: break;
+        }
+        reduced.assign(rt + 1, empty);
+        propagationStreamed(cs, rt, kernel, [&](int c, const solution& s) {
+            if (c != 0 && s.size == 0) return;
+            reduced[c] = problem == Problem::Knapsack ? s.value : -s.value;
+        });
+    } else if (strategy == Strategy::Classical) {
+        reduced = problem == Problem::Knapsack ? classicalKnapsack(ri.n, ri.w, ri.p, rt) : classicalCoinChange(ri.n, ri.w, rt);
+    } else if (strategy == Strategy::CoinChangeSmallU) {
+        reduced = coinChangeSmallU(ri.coins(), rt);
+    } else {
+        CoinSet cs = ri.coins();
+        vector<solution> sol;
+        switch (strategy) {
+            case Strategy::Kernel: kernelComputation_knapsack(cs, rt, sol); break;
+            case Strategy::CoinChangeSimple: kernelComputation_coinchange_simple(cs, rt, sol); break;
+            case Strategy::CoinChangeRandomized: kernelComputation_coinchange_randomized(cs, rt, sol); break;
+            case Strategy::CoinChangeAdaptive: kernelComputation_coinchange(cs, rt, sol); break;
+            case Strategy::Classical:
+            case Strategy::CoinChangeSmallU: break;
+        }
+        propagation(cs, rt, sol);
+        tables.set(solutionTableBytes(sol, 0, (int)sol.size() - 1));
+        reduced.assign(rt + 1, empty);
+        for (int c = 0; c <= rt; c++) {
+            if (c != 0 && sol[c].size == 0) continue;
+            reduced[c] = problem == Problem::Knapsack ? sol[c].value : -sol[c].value;
+        }
+    }
+
+    vector<ll> res(t + 1, empty);
+    tables.set(tables.held() + (reduced.size() + res.size()) * sizeof(ll));
+    for (int c = 0; c <= t; c++) {
+        ll rc = ri.target(c);
+        if (rc >= 0) res[c] = reduced[rc];
+    }
+    return res;
+}
+
+/// Drops dominated coins and divides by the gcd (preprocess.h); coin change is knapsack with profit -1 per coin.
+static void reduceFor(Problem problem, int n, const vector<int>& w, const vector<int>& p, ReducedInstance& ri) {
+    vector<int> order(n + 1), unit(n + 1, -1);
+    for (int i = 1; i <= n; i++) order[i] = i;
+    int u = 1;
+    for (int i = 1; i <= n; i++) u = max(u, w[i]);
+    reduceInstance(n, u, w, problem == Problem::Knapsack ? p : unit, order, ri);
+}
+
+SolveResult solveWith(
+    Strategy strategy,
+    Problem problem,
+    int n,
+    const vector<int>& w,
+    const vector<int>& p,
+    int t
+) {
+    ReducedInstance ri;
+    reduceFor(problem, n, w, p, ri);
+    bool streamed;
+    vector<ll> value = runReduced(strategy, problem, ri, t, streamed);
+    return SolveResult{strategy, value, streamed};
+}
+
+SolveResult solve(
+    Problem problem,
+    int n,
+    const vector<int>& w,
+    const vector<int>& p,
+    int t,
+    const CostProfile& profile
+) {
+    ReducedInstance ri;
+    reduceFor(problem, n, w, p, ri);
+    Strategy s = chooseStrategy(problem, instanceStats(ri, t), profile);
+    bool streamed;
+    vector<ll> value = runReduced(s, problem, ri, t, streamed);
+    return SolveResult{s, value, streamed};
+}
+
+/// Seconds of one run of `strategy` on a random instance, divided by the model term it calibrates.
+static double timePerUnit(Strategy strategy, Problem problem, int n, int u, int t, mt19937& rng) {
+    vector<int> w(n + 1), p(n + 1);
+    uniform_int_distribution<int> dw(u / 2 + 1, u), dp(1, 1000);
+    for (int i = 1; i <= n; i++) {
+        w[i] = dw(rng); // no weight is a multiple of another, so only duplicates get reduced away
+        p[i] = dp(rng);
+    }
+    w[1] = u;
+    ReducedInstance ri;
+    reduceFor(problem, n, w, p, ri);
+    auto t0 = chrono::high_resolution_clock::now();
+    bool streamed;
+    runReduced(strategy, problem, ri, t, streamed);
+    auto t1 = chrono::high_resolution_clock::now();
+    double secs = chrono::duration<double>(t1 - t0).count();
+
+    CostProfile unit; // constants 1 (and no propagation) turn estimate() into the raw term
+    unit.classical = unit.kernel = unit.simple = unit.randomized = unit.adaptive = unit.smallU = 1;
+    unit.propagation = 0;
+    return secs / unit.estimate(strategy, instanceStats(ri, t));
+}
+
+CostProfile calibrateCostProfile() {
+    CostProfile cp;
+    mt19937 rng(12345);
+    auto median3 = [](double a, double b, double c) { return max(min(a, b), min(max(a, b), c)); };
+    auto measure = [&](Strategy s, Problem pr, int n, int u, int t) {
+        return median3(timePerUnit(s, pr, n, u, t, rng), timePerUnit(s, pr, n, u, t, rng), timePerUnit(s, pr, n, u, t, rng));
+    };
+
+    cp.classical = measure(Strategy::Classical, Problem::Knapsack, 200, 1000, 1000000);
+
+    // propagation alone: three coins have a small kernel, so Algorithm 1 dominates the run
+    {
+        auto once = [&] {
+            int t = 400000, u = 64;
+            ReducedInstance ri;
+            reduceFor(Problem::Knapsack, 3, {0, u / 2 + 1, u, u - 1}, {0, 3, 7, 5}, ri);
+            Strategy s = Strategy::Kernel;
+            auto t0 = chrono::high_resolution_clock::now();
+            bool streamed;
+            runReduced(s, Problem::Knapsack, ri, t, streamed);
+            auto t1 = chrono::high_resolution_clock::now();
+            return chrono::duration<double>(t1 - t0).count() / (t * (log2(u) + 1));
+        };
+        cp.propagation = median3(once(), once(), once());
+    }
+
+    // kernel terms: t = 0 leaves only the kernel computation
+    cp.kernel = measure(Strategy::Kernel, Problem::Knapsack, 300, 1000, 0);
+    cp.simple = measure(Strategy::CoinChangeSimple, Problem::CoinChange, 300, 512, 0);
+    cp.randomized = measure(Strategy::CoinChangeRandomized, Problem::CoinChange, 300, 512, 0);
+    cp.adaptive = measure(Strategy::CoinChangeAdaptive, Problem::CoinChange, 300, 256, 0);
+    cp.smallU = measure(Strategy::CoinChangeSmallU, Problem::CoinChange, 100, 500, 2000000);
+    return cp;
+}
@@ -1,4 +1,5 @@
 #include "dp_structs.h"
+#include "instrument.h"
 
 // default constructor
 solution::solution()
@@ -47,6 +48,7 @@ bool solution::lexCmp(const solution &s2) {
 
 //copy s1 over to s2
 void solution::copy(solution &s2) {
+    FK_COUNT("solution.copy", svec.size());
     s2.size = size;
     s2.value = value;
     s2.weight = weight;
@@ -55,3 +57,11 @@ void solution::copy(solution &s2) {
         s2.svec[c.first] = c.second;
     }
 }
+
+size_t solutionTableBytes(const vector<solution>& sol, int from, int to) {
+    size_t bytes = 0;
+    for (int c = max(from, 0); c <= to && c < (int)sol.size(); c++) {
+        bytes += sizeof(solution) + sol[c].svec.size() * SVEC_NODE_BYTES;
+    }
+    return bytes;
+}
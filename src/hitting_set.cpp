@@ -1,78 +1,224 @@
 #include "hitting_set.h"
+#include "thread_pool.h"
+#include "instrument.h"
+#include "trace.h"
 #include <vector>
-#include <list>
 #include <algorithm>
 
 using namespace std;
 
+SetSystem::SetSystem()
+  : start(1, 0), elems()
+{}
+
+SetSystem::SetSystem(const vector<const vector<int>*>& lists)
+  : start(lists.size() + 1, 0), elems()
+{
+    for (size_t s = 0; s < lists.size(); ++s) {
+        start[s + 1] = start[s] + (int)lists[s]->size();
+    }
+    elems.resize(start.back());
+    for (size_t s = 0; s < lists.size(); ++s) {
+        copy(lists[s]->begin(), lists[s]->end(), elems.begin() + start[s]);
+    }
+}
+
+int SetSystem::size() const {
+    return (int)start.size() - 1;
+}
+
+void SetSystem::addSet(const vector<int>& set) {
+    elems.insert(elems.end(), set.begin(), set.end());
+    start.push_back((int)elems.size());
+}
+
+namespace {
+// Per-thread buffers of the greedy, reused across calls so the steady state does not allocate
+struct GreedyScratch {
+    vector<int> setStart, setOf;     // element -> sets containing it (CSR)
+    vector<int> coverCount;
+    vector<int> head, next, prev;    // intrusive doubly linked buckets indexed by cover count
+    vector<char> covered;
+};
+}
+
 /**
  * Fast greedy hitting-set via bucket queue for O(total input size) time.
  */
 vector<int> computeHittingSet(
-    const vector<vector<int>>& sets,
-    int u, // number of sets
+    const SetSystem& sets,
     int R,
     int n  // universe size
 ) {
-    // Inverse index: element -> list of sets containing it
-    vector<vector<int>> elementToSets(n + 1);
+    thread_local GreedyScratch sc;
+    int u = sets.size();
+    FK_TRACE("hitting_set.greedy", "witness", "sets", u, "n", n);
+
+    // Inverse index: element -> sets containing it
+    sc.setStart.assign(n + 2, 0);
+    for (int e : sets.elems) {
+        if (e >= 1 && e <= n) sc.setStart[e + 1]++;
+    }
+    for (int e = 1; e <= n + 1; ++e) sc.setStart[e] += sc.setStart[e - 1];
+    sc.setOf.resize(sc.setStart[n + 1]);
+    sc.coverCount.assign(n + 1, 0);
     for (int s = 0; s < u; ++s) {
-        for (int e : sets[s]) {
+        for (int i = sets.start[s]; i < sets.start[s + 1]; ++i) {
+            int e = sets.elems[i];
             if (e >= 1 && e <= n) {
-                elementToSets[e].push_back(s);
+                sc.setOf[sc.setStart[e] + sc.coverCount[e]++] = s;
             }
         }
     }
 
-    vector<bool> covered(u, false);
-    int uncoveredCount = u;
-    vector<int> hittingSet;
-
-    // Compute initial cover counts and bucket structure
-    vector<int> coverCount(n + 1, 0);
-    for (int e = 1; e <= n; ++e) {
-        coverCount[e] = static_cast<int>(elementToSets[e].size());
-    }
-    // Buckets indexed by coverCount, range [0..u]
-    vector<list<int>> buckets(u + 1);
-    vector<list<int>::iterator> pos(n + 1);
+    // Buckets indexed by cover count, range [0..u]
+    sc.head.assign(u + 1, -1);
+    sc.next.assign(n + 1, -1);
+    sc.prev.assign(n + 1, -1);
+    auto link = [&](int e, int c) {
+        sc.prev[e] = -1;
+        sc.next[e] = sc.head[c];
+        if (sc.head[c] != -1) sc.prev[sc.head[c]] = e;
+        sc.head[c] = e;
+    };
+    auto unlink = [&](int e, int c) {
+        if (sc.prev[e] != -1) sc.next[sc.prev[e]] = sc.next[e];
+        else sc.head[c] = sc.next[e];
+        if (sc.next[e] != -1) sc.prev[sc.next[e]] = sc.prev[e];
+    };
     int maxCount = 0;
     for (int e = 1; e <= n; ++e) {
-        int c = coverCount[e];
-        buckets[c].push_front(e);
-        pos[e] = buckets[c].begin();
-        maxCount = max(maxCount, c);
+        link(e, sc.coverCount[e]);
+        maxCount = max(maxCount, sc.coverCount[e]);
     }
 
+    sc.covered.assign(u, 0);
+    int uncoveredCount = u;
+    vector<int> hittingSet;
+
     // Greedy selection loop
     while (uncoveredCount > 0 && maxCount > 0) {
         // Pick element with current highest coverage
-        int elem = buckets[maxCount].front();
-        buckets[maxCount].pop_front();
-        coverCount[elem] = 0; // mark as selected
+        int elem = sc.head[maxCount];
+        unlink(elem, maxCount);
+        sc.coverCount[elem] = 0; // mark as selected
         hittingSet.push_back(elem);
 
         // Cover all sets hit by this element and update cover counts
-        for (int s : elementToSets[elem]) {
-            if (!covered[s]) {
-                covered[s] = true;
-                --uncoveredCount;
-                // Decrement cover count for each element in this set
-                for (int e2 : sets[s]) {
-                    int c2 = coverCount[e2];
-                    if (c2 > 0) {
-                        buckets[c2].erase(pos[e2]);
-                        buckets[c2 - 1].push_front(e2);
-                        pos[e2] = buckets[c2 - 1].begin();
-                        --coverCount[e2];
-                    }
+        for (int i = sc.setStart[elem]; i < sc.setStart[elem + 1]; ++i) {
+            int s = sc.setOf[i];
+            if (sc.covered[s]) continue;
+            sc.covered[s] = 1;
+            --uncoveredCount;
+            // Decrement cover count for each element in this set
+            for (int j = sets.start[s]; j < sets.start[s + 1]; ++j) {
+                int e2 = sets.elems[j];
+                if (e2 < 1 || e2 > n) continue;
+                int c2 = sc.coverCount[e2];
+                if (c2 > 0) {
+                    unlink(e2, c2);
+                    link(e2, c2 - 1);
+                    --sc.coverCount[e2];
                 }
             }
         }
         // Move maxCount down to next non-empty bucket
-        while (maxCount > 0 && buckets[maxCount].empty()) {
+        while (maxCount > 0 && sc.head[maxCount] == -1) {
             --maxCount;
         }
     }
+    FK_HISTOGRAM("hitting_set.sets", u);
+    FK_HISTOGRAM("hitting_set.size", hittingSet.size());
+    return hittingSet;
+}
+
+/**
+ * Sampling hits every set of size ≥ R with probability ≥ 1 - 1/#sets, so only a few sets need repairing.
+ * Only the elements that occur in some set are sampled: the sets of a witness round draw from the current
+ * candidates, which are often far fewer than n, and sampling all of [1..n] would overshoot `limit`.
+ */
+vector<int> computeHittingSet_randomized(
+    const SetSystem& sets,
+    int R,
+    int n,  // universe size
+    int limit,
+    unsigned seed
+) {
+    const int CHUNK = 1 << 14;
+    int u = sets.size();
+    if (u == 0) return {};
+    FK_TRACE("hitting_set.sampled", "witness", "sets", u, "n", n);
+    double q = min(1.0, log((double)max(u, 2)) / max(R, 1));
+
+    // 0) the population: distinct elements of the sets, ascending
+    vector<char> inH(n + 1, 0);
+    for (int e : sets.elems) {
+        if (e >= 1 && e <= n) inH[e] = 1;
+    }
+    vector<int> population;
+    for (int e = 1; e <= n; ++e) {
+        if (inH[e]) population.push_back(e);
+        inH[e] = 0;
+    }
+    int m = population.size();
+    if (q * m > limit) {
+        // the expected sample alone is over the limit
+        FK_COUNT("hitting_set.sample_skipped", 1);
+        return computeHittingSet(sets, R, n);
+    }
+
+    // 1) sample, one RNG stream per chunk of the population
+    sharedThreadPool().parallelFor(0, (m + CHUNK - 1) / CHUNK, [&](int ch) {
+        mt19937 rng(streamSeed(seed, ch, 0));
+        bernoulli_distribution keep(q);
+        int hi = min(m, (ch + 1) * CHUNK);
+        for (int i = ch * CHUNK; i < hi; ++i) inH[population[i]] = keep(rng);
+    });
+
+    // 2) check all sets in parallel
+    vector<char> missed(u, 0);
+    sharedThreadPool().parallelFor(0, (u + CHUNK - 1) / CHUNK, [&](int ch) {
+        int hi = min(u, (ch + 1) * CHUNK);
+        for (int s = ch * CHUNK; s < hi; ++s) {
+            bool hit = false;
+            for (int i = sets.start[s]; i < sets.start[s + 1] && !hit; ++i) {
+                int e = sets.elems[i];
+                hit = e >= 1 && e <= n && inH[e];
+            }
+            missed[s] = !hit;
+        }
+    });
+
+    // 3) greedy repair of the missed sets only
+    SetSystem rest;
+    vector<int> tmp;
+    for (int s = 0; s < u; ++s) {
+        if (!missed[s]) continue;
+        tmp.assign(sets.elems.begin() + sets.start[s], sets.elems.begin() + sets.start[s + 1]);
+        rest.addSet(tmp);
+    }
+    if (rest.size() > 0) {
+        for (int e : computeHittingSet(rest, R, n)) inH[e] = 1;
+    }
+
+    vector<int> hittingSet;
+    for (int e : population)
+        if (inH[e]) hittingSet.push_back(e);
+    if ((int)hittingSet.size() > limit) {
+        FK_COUNT("hitting_set.sample_rejected", 1);
+        return computeHittingSet(sets, R, n);
+    }
+    FK_HISTOGRAM("hitting_set.sampled_size", hittingSet.size());
     return hittingSet;
 }
+
+vector<int> computeHittingSet(
+    const vector<vector<int>>& sets,
+    int u, // number of sets
+    int R,
+    int n  // universe size
+) {
+    vector<const vector<int>*> lists(u);
+    for (int s = 0; s < u; ++s) lists[s] = &sets[s];
+    return computeHittingSet(SetSystem(lists), R, n);
+}
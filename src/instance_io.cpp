@@ -0,0 +1,295 @@
+#include "instance_io.h"
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+const size_t INSTANCE_HEADER = 24;
+const size_t RESULTS_HEADER = 16;
+
+bool writeFully(int fd, vector<iovec> iov) {
+    size_t first = 0;
+    while (first < iov.size()) {
+        ssize_t done = writev(fd, iov.data() + first, (int)min<size_t>(iov.size() - first, IOV_MAX));
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        while (first < iov.size() && (size_t)done >= iov[first].iov_len) {
+            done -= iov[first].iov_len;
+            first++;
+        }
+        if (first < iov.size()) {
+            iov[first].iov_base = (char*)iov[first].iov_base + done;
+            iov[first].iov_len -= done;
+        }
+    }
+    return true;
+}
+
+static bool writeFile(const string& path, const vector<iovec>& iov) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = writeFully(fd, iov);
+    return ::close(fd) == 0 && ok;
+}
+
+MappedFile::MappedFile()
+  : ptr(nullptr), len(0)
+{}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    len = (size_t)st.st_size;
+    if (len > 0) {
+        void* m = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            ::close(fd);
+            len = 0;
+            return false;
+        }
+        madvise(m, len, MADV_SEQUENTIAL);
+        ptr = (const char*)m;
+    }
+    ::close(fd); // the mapping keeps the file alive
+    return true;
+}
+
+void MappedFile::close() {
+    if (ptr) munmap((void*)ptr, len);
+    ptr = nullptr;
+    len = 0;
+}
+
+int InstanceView::weight(int i) const {
+    return loadLE<int32_t>(weights + 4 * (size_t)(i - 1));
+}
+
+int InstanceView::profit(int i) const {
+    return loadLE<int32_t>(profits + 4 * (size_t)(i - 1));
+}
+
+bool parseBinaryInstance(const char* data, size_t size, InstanceView& view) {
+    if (size < INSTANCE_HEADER || memcmp(data, INSTANCE_MAGIC, 4) != 0) return false;
+    if (loadLE<uint32_t>(data + 4) != INSTANCE_IO_VERSION) return false;
+    view.n = loadLE<int32_t>(data + 8);
+    view.u = loadLE<int32_t>(data + 12);
+    view.t = loadLE<int64_t>(data + 16);
+    if (view.n < 0 || size != INSTANCE_HEADER + 8 * (size_t)view.n) return false;
+    view.weights = data + INSTANCE_HEADER;
+    view.profits = view.weights + 4 * (size_t)view.n;
+    return true;
+}
+
+/// Skips whitespace and parses one integer; false at the end of the data or on garbage.
+template <typename T>
+static bool nextInt(const char*& p, const char* end, T& x) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    auto [q, ec] = from_chars(p, end, x);
+    if (ec != errc()) return false;
+    p = q;
+    return true;
+}
+
+/// Parses one text instance starting at `p` and leaves `p` behind it.
+static bool parseTextAt(const char*& p, const char* end, Instance& inst) {
+    if (!nextInt(p, end, inst.n) || !nextInt(p, end, inst.u) || !nextInt(p, end, inst.t) || inst.n < 0) {
+        return false;
+    }
+    inst.w.assign(inst.n + 1, 0);
+    inst.p.assign(inst.n + 1, 0);
+    for (int i = 1; i <= inst.n; i++) {
+        if (!nextInt(p, end, inst.w[i]) || !nextInt(p, end, inst.p[i])) return false;
+    }
+    return true;
+}
+
+bool parseTextInstance(const char* data, size_t size, Instance& inst) {
+    const char* p = data;
+    return parseTextAt(p, data + size, inst);
+}
+
+bool readTextInstance(istream& in, Instance& inst) {
+    if (!(in >> inst.n >> inst.u >> inst.t) || inst.n < 0) return false;
+    inst.w.assign(inst.n + 1, 0);
+    inst.p.assign(inst.n + 1, 0);
+    for (int i = 1; i <= inst.n; i++) {
+        if (!(in >> inst.w[i] >> inst.p[i])) return false;
+    }
+    return true;
+}
+
+void instanceFromView(const InstanceView& view, Instance& inst) {
+    inst.n = view.n;
+    inst.u = view.u;
+    inst.t = view.t;
+    inst.w.resize(inst.n + 1);
+    inst.p.resize(inst.n + 1);
+    inst.w[0] = inst.p[0] = 0;
+    if constexpr (endian::native == endian::little) {
+        memcpy(inst.w.data() + 1, view.weights, 4 * (size_t)inst.n);
+        memcpy(inst.p.data() + 1, view.profits, 4 * (size_t)inst.n);
+    } else {
+        for (int i = 1; i <= inst.n; i++) {
+            inst.w[i] = view.weight(i);
+            inst.p[i] = view.profit(i);
+        }
+    }
+}
+
+bool readInstance(const string& path, Instance& inst) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    if (file.size() < 4 || memcmp(file.data(), INSTANCE_MAGIC, 4) != 0) {
+        return parseTextInstance(file.data(), file.size(), inst);
+    }
+    InstanceView view;
+    if (!parseBinaryInstance(file.data(), file.size(), view)) return false;
+    instanceFromView(view, inst);
+    return true;
+}
+
+bool loadInstance(const string& path, Instance& inst) {
+    return path.empty() ? readTextInstance(cin, inst) : readInstance(path, inst);
+}
+
+string encodeBinaryInstance(const Instance& inst) {
+    string buf(INSTANCE_HEADER + 8 * (size_t)inst.n, '\0');
+    memcpy(buf.data(), INSTANCE_MAGIC, 4);
+    storeLE<uint32_t>(buf.data() + 4, INSTANCE_IO_VERSION);
+    storeLE<int32_t>(buf.data() + 8, inst.n);
+    storeLE<int32_t>(buf.data() + 12, inst.u);
+    storeLE<int64_t>(buf.data() + 16, inst.t);
+    char* wp = buf.data() + INSTANCE_HEADER;
+    char* pp = wp + 4 * (size_t)inst.n;
+    for (int i = 1; i <= inst.n; i++) {
+        storeLE<int32_t>(wp + 4 * (size_t)(i - 1), inst.w[i]);
+        storeLE<int32_t>(pp + 4 * (size_t)(i - 1), inst.p[i]);
+    }
+    return buf;
+}
+
+bool writeBinaryInstance(const string& path, const Instance& inst) {
+    string buf = encodeBinaryInstance(inst);
+    return writeFile(path, {{buf.data(), buf.size()}});
+}
+
+bool writeBinaryResults(const string& path, const vector<ll>& values) {
+    char header[RESULTS_HEADER];
+    memcpy(header, RESULTS_MAGIC, 4);
+    storeLE<uint32_t>(header + 4, INSTANCE_IO_VERSION);
+    storeLE<int64_t>(header + 8, (ll)values.size());
+    if constexpr (endian::native == endian::little) {
+        return writeFile(path, {{header, RESULTS_HEADER}, {(void*)values.data(), 8 * values.size()}});
+    } else {
+        vector<char> body(8 * values.size());
+        for (size_t i = 0; i < values.size(); i++) storeLE<int64_t>(body.data() + 8 * i, values[i]);
+        return writeFile(path, {{header, RESULTS_HEADER}, {body.data(), body.size()}});
+    }
+}
+
+bool writeTextResults(ostream& out, const vector<ll>& values) {
+    const size_t CHUNK = 1 << 20;
+    vector<char> buf(CHUNK + 24); // room for one more value past CHUNK
+    size_t used = 0;
+    for (ll v : values) {
+        char* at = buf.data() + used;
+        at = to_chars(at, at + 20, v).ptr; // 20 characters hold every ll
+        *at++ = '\n';
+        used = at - buf.data();
+        if (used >= CHUNK) {
+            out.write(buf.data(), used);
+            used = 0;
+        }
+    }
+    out.write(buf.data(), used);
+    out.flush();
+    return (bool)out;
+}
+
+bool appendBinaryResults(ostream& out, const vector<ll>& values) {
+    char header[RESULTS_HEADER];
+    memcpy(header, RESULTS_MAGIC, 4);
+    storeLE<uint32_t>(header + 4, INSTANCE_IO_VERSION);
+    storeLE<int64_t>(header + 8, (ll)values.size());
+    out.write(header, RESULTS_HEADER);
+    if constexpr (endian::native == endian::little) {
+        out.write((const char*)values.data(), 8 * values.size());
+    } else {
+        vector<char> body(8 * values.size());
+        for (size_t i = 0; i < values.size(); i++) storeLE<int64_t>(body.data() + 8 * i, values[i]);
+        out.write(body.data(), body.size());
+    }
+    return (bool)out;
+}
+
+bool storeResults(const string& path, const vector<ll>& values) {
+    return path.empty() ? writeTextResults(cout, values) : writeBinaryResults(path, values);
+}
+
+bool readBinaryResults(const string& path, vector<ll>& values) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    const char* d = file.data();
+    if (file.size() < RESULTS_HEADER || memcmp(d, RESULTS_MAGIC, 4) != 0) return false;
+    if (loadLE<uint32_t>(d + 4) != INSTANCE_IO_VERSION) return false;
+    ll count = loadLE<int64_t>(d + 8);
+    if (count < 0 || file.size() != RESULTS_HEADER + 8 * (size_t)count) return false;
+    values.resize(count);
+    for (ll i = 0; i < count; i++) values[i] = loadLE<int64_t>(d + RESULTS_HEADER + 8 * i);
+    return true;
+}
+
+bool InstanceStream::open(const string& path) {
+    offset = 0;
+    bad = false;
+    fromStdin = path.empty();
+    if (fromStdin) return true;
+    if (!file.open(path)) return false;
+    binary = file.size() >= 4 && memcmp(file.data(), INSTANCE_MAGIC, 4) == 0;
+    return true;
+}
+
+bool InstanceStream::next(Instance& inst) {
+    if (bad) return false;
+    if (fromStdin) {
+        if (!(cin >> ws) || cin.eof()) return false;
+        bad = !readTextInstance(cin, inst);
+        return !bad;
+    }
+    const char* data = file.data() + offset;
+    size_t rest = file.size() - offset;
+    if (binary) {
+        if (rest == 0) return false;
+        InstanceView view;
+        size_t len = rest < INSTANCE_HEADER ? rest : INSTANCE_HEADER + 8 * (size_t)max(0, loadLE<int32_t>(data + 8));
+        bad = len > rest || !parseBinaryInstance(data, len, view);
+        if (bad) return false;
+        instanceFromView(view, inst);
+        offset += len;
+        return true;
+    }
+    const char* p = data;
+    const char* end = data + rest;
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    if (p == end) return false;
+    bad = !parseTextAt(p, end, inst);
+    offset = p - file.data();
+    return !bad;
+}
@@ -0,0 +1,162 @@
+#include "instrument.h"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+namespace {
+
+struct Registry {
+    mutex lock;
+    vector<InstrumentCounter*> counters;
+    vector<InstrumentHistogram*> histograms;
+    vector<InstrumentTimer*> timers;
+};
+
+void writeExitReport();
+
+// never destroyed, so probes hit by other static destructors are still safe to read at exit
+Registry& registry() {
+    static Registry* reg = [] {
+        atexit(writeExitReport);
+        return new Registry();
+    }();
+    return *reg;
+}
+
+void writeExitReport() {
+    const char* path = getenv("FASTKNAPSACK_INSTRUMENT_REPORT");
+    if (path && string(path) == "none") return;
+    if (path && *path) {
+        ofstream out(path);
+        instrumentReport(out);
+    } else {
+        instrumentReport(cerr);
+    }
+}
+
+template <typename T>
+void registerProbe(vector<T*>& probes, T* probe) {
+    Registry& reg = registry();
+    lock_guard<mutex> g(reg.lock);
+    probes.push_back(probe);
+}
+
+}
+
+InstrumentCounter::InstrumentCounter(const char* name)
+  : name(name), hits(0), total(0)
+{
+    registerProbe(registry().counters, this);
+}
+
+InstrumentHistogram::InstrumentHistogram(const char* name)
+  : name(name), total(0)
+{
+    for (auto& b : buckets) b.store(0);
+    registerProbe(registry().histograms, this);
+}
+
+InstrumentTimer::InstrumentTimer(const char* name)
+  : name(name), calls(0), nanos(0)
+{
+    registerProbe(registry().timers, this);
+}
+
+bool instrumentEnabled() {
+#ifdef FASTKNAPSACK_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+}
+
+void instrumentReport(ostream& out) {
+    if (!instrumentEnabled()) {
+        out << "instrumentation disabled (build with -DFASTKNAPSACK_INSTRUMENT)" << endl;
+        return;
+    }
+    Registry& reg = registry();
+    lock_guard<mutex> g(reg.lock);
+
+    map<string, pair<unsigned long long, unsigned long long>> counters; // name -> (hits, total)
+    for (auto* c : reg.counters) {
+        auto& e = counters[c->name];
+        e.first += c->hits.load();
+        e.second += c->total.load();
+    }
+    map<string, pair<vector<unsigned long long>, unsigned long long>> histograms; // name -> (buckets, total)
+    for (auto* h : reg.histograms) {
+        auto& e = histograms[h->name];
+        e.first.resize(InstrumentHistogram::BUCKETS);
+        for (int b = 0; b < InstrumentHistogram::BUCKETS; b++) e.first[b] += h->buckets[b].load();
+        e.second += h->total.load();
+    }
+    map<string, pair<unsigned long long, unsigned long long>> timers; // name -> (calls, nanos)
+    for (auto* t : reg.timers) {
+        auto& e = timers[t->name];
+        e.first += t->calls.load();
+        e.second += t->nanos.load();
+    }
+
+    out << "== instrumentation report ==" << endl;
+    if (!timers.empty()) {
+        out << left << setw(40) << "timer" << right << setw(12) << "calls" << setw(14) << "total ms"
+            << setw(14) << "mean us" << endl;
+        for (auto& [name, e] : timers) {
+            double ms = e.second / 1e6;
+            double mean = e.first ? e.second / 1e3 / e.first : 0.0;
+            out << left << setw(40) << name << right << setw(12) << e.first << fixed << setprecision(3)
+                << setw(14) << ms << setw(14) << mean << defaultfloat << endl;
+        }
+    }
+    if (!counters.empty()) {
+        out << left << setw(40) << "counter" << right << setw(12) << "hits" << setw(14) << "total" << endl;
+        for (auto& [name, e] : counters) {
+            out << left << setw(40) << name << right << setw(12) << e.first << setw(14) << e.second << endl;
+        }
+    }
+    for (auto& [name, e] : histograms) {
+        unsigned long long hits = 0;
+        for (auto x : e.first) hits += x;
+        out << "histogram " << name << ": " << hits << " hits, total size " << e.second << endl;
+        for (int b = 0; b < InstrumentHistogram::BUCKETS; b++) {
+            if (e.first[b] == 0) continue;
+            out << "  [2^" << setw(2) << b << ", 2^" << setw(2) << b + 1 << ")" << setw(12) << e.first[b] << endl;
+        }
+    }
+}
+
+void instrumentReset() {
+    Registry& reg = registry();
+    lock_guard<mutex> g(reg.lock);
+    for (auto* c : reg.counters) c->hits = 0, c->total = 0;
+    for (auto* h : reg.histograms) {
+        for (auto& b : h->buckets) b = 0;
+        h->total = 0;
+    }
+    for (auto* t : reg.timers) t->calls = 0, t->nanos = 0;
+}
+
+unsigned long long instrumentTotal(const string& name) {
+    Registry& reg = registry();
+    lock_guard<mutex> g(reg.lock);
+    unsigned long long total = 0;
+    for (auto* c : reg.counters) if (name == c->name) total += c->total.load();
+    for (auto* h : reg.histograms) if (name == h->name) total += h->total.load();
+    for (auto* t : reg.timers) if (name == t->name) total += t->nanos.load();
+    return total;
+}
+
+unsigned long long instrumentHits(const string& name) {
+    Registry& reg = registry();
+    lock_guard<mutex> g(reg.lock);
+    unsigned long long hits = 0;
+    for (auto* c : reg.counters) if (name == c->name) hits += c->hits.load();
+    for (auto* h : reg.histograms) {
+        if (name != h->name) continue;
+        for (auto& b : h->buckets) hits += b.load();
+    }
+    for (auto* t : reg.timers) if (name == t->name) hits += t->calls.load();
+    return hits;
+}
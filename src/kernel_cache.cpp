@@ -0,0 +1,236 @@
+#include "kernel_cache.h"
+#include "algorithms.h"
+#include "instance_io.h"
+#include "small_u.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+const char KERNEL_MAGIC[4] = {'F', 'K', 'K', 'C'};
+const uint32_t KERNEL_CACHE_VERSION = 1;
+const uint32_t ENDIAN_MARK = 0x01020304;
+
+/// Fixed part of a cache file; the arrays follow in the order of the fields they are sized by.
+struct KernelFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t fingerprint;
+    uint32_t endian;      ///< ENDIAN_MARK as written by the host
+    int32_t kind;
+    int32_t n;
+    int32_t u;
+    int32_t pLen;         ///< size of cs.p (0 when the profits are not used)
+    int32_t count;        ///< stored solutions sol[0..count)
+    int64_t entries;      ///< total size of their svec maps
+};
+static_assert(sizeof(KernelFileHeader) == 48, "the header keeps the 64-bit arrays aligned");
+
+// file layout after the header:
+//   int64 size[count], value[count], weight[count], start[count + 1], copies[entries]
+//   int32 w[n + 1], p[pLen], inputOrder[n + 1], order[n + 1], coin[entries]
+
+const char* kernelKindName(KernelKind kind) {
+    switch (kind) {
+        case KernelKind::Knapsack: return "knapsack";
+        case KernelKind::CoinChangeSimple: return "simple";
+        case KernelKind::CoinChangeRandomized: return "randomized";
+        case KernelKind::CoinChangeAdaptive: return "adaptive";
+        case KernelKind::CoinChangeSmallU: return "smallu";
+    }
+    return "unknown";
+}
+
+static void fnv(uint64_t& h, const void* data, size_t len) {
+    const unsigned char* b = (const unsigned char*)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= b[i];
+        h *= 0x100000001b3ULL;
+    }
+}
+
+static uint64_t fingerprint(KernelKind kind, const CoinSet& cs, const vector<int>& order) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    int32_t head[5] = {(int32_t)KERNEL_CACHE_VERSION, (int32_t)kind, cs.n, cs.u, (int32_t)cs.p.size()};
+    fnv(h, head, sizeof(head));
+    fnv(h, cs.w.data(), cs.w.size() * sizeof(int));
+    fnv(h, cs.p.data(), cs.p.size() * sizeof(int));
+    fnv(h, order.data(), order.size() * sizeof(int));
+    return h;
+}
+
+unsigned long long kernelFingerprint(KernelKind kind, const CoinSet& cs) {
+    return fingerprint(kind, cs, cs.order);
+}
+
+/// Number of solutions Algorithm 2 produces, k·u + 1.
+static int kernelSize(int u) {
+    int k = static_cast<int>(floor(2.0 * log2(u) + 1.0));
+    return k * u + 1;
+}
+
+static string fileName(KernelKind kind, uint64_t h) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h);
+    return string(hex) + "-" + kernelKindName(kind) + ".kernel";
+}
+
+KernelCache::KernelCache(const string& dir)
+  : dir(dir.empty() ? "." : dir)
+{
+    mkdir(this->dir.c_str(), 0755); // fails harmlessly if it exists
+}
+
+string KernelCache::path(KernelKind kind, const CoinSet& cs) const {
+    return dir + "/" + fileName(kind, kernelFingerprint(kind, cs));
+}
+
+bool KernelCache::load(KernelKind kind, CoinSet& cs, int t, vector<solution>& sol) const {
+    uint64_t h = kernelFingerprint(kind, cs);
+    MappedFile file;
+    if (!file.open(dir + "/" + fileName(kind, h))) return false;
+    const char* d = file.data();
+    KernelFileHeader hd;
+    if (file.size() < sizeof(hd)) return false;
+    memcpy(&hd, d, sizeof(hd));
+    if (memcmp(hd.magic, KERNEL_MAGIC, 4) != 0 || hd.version != KERNEL_CACHE_VERSION || hd.endian != ENDIAN_MARK
+        || hd.fingerprint != h || hd.kind != (int32_t)kind || hd.n != cs.n || hd.u != cs.u
+        || hd.pLen != (int32_t)cs.p.size() || hd.count < 0 || hd.entries < 0) {
+        return false;
+    }
+    size_t n1 = (size_t)cs.n + 1, cnt = (size_t)hd.count, ent = (size_t)hd.entries;
+    if (cs.w.size() != n1 || cs.order.size() != n1) return false;
+    size_t expected = sizeof(hd) + 8 * (4 * cnt + 1 + ent) + 4 * (3 * n1 + hd.pLen + ent);
+    if (file.size() != expected) return false;
+
+    const int64_t* size = (const int64_t*)(d + sizeof(hd));
+    const int64_t* value = size + cnt;
+    const int64_t* weight = value + cnt;
+    const int64_t* start = weight + cnt;
+    const int64_t* copies = start + cnt + 1;
+    const int32_t* w = (const int32_t*)(copies + ent);
+    const int32_t* p = w + n1;
+    const int32_t* inputOrder = p + hd.pLen;
+    const int32_t* order = inputOrder + n1;
+    const int32_t* coin = order + n1;
+
+    // the coins must be exactly ours, not just hash alike
+    if (memcmp(w, cs.w.data(), 4 * n1) != 0 || memcmp(p, cs.p.data(), 4 * (size_t)hd.pLen) != 0
+        || memcmp(inputOrder, cs.order.data(), 4 * n1) != 0) {
+        return false;
+    }
+    // a truncated or corrupted file must be a miss, not an out-of-range read: every solution's entries lie
+    // within [0, ent) in increasing coin order, every coin is in [1, n] and the adapted order is a permutation
+    if (start[0] != 0 || start[cnt] != (int64_t)ent) return false;
+    for (size_t c = 0; c < cnt; c++) {
+        if (start[c + 1] < start[c] || start[c + 1] > (int64_t)ent) return false;
+        for (int64_t e = start[c]; e < start[c + 1]; e++) {
+            if (coin[e] < 1 || coin[e] > cs.n || (e > start[c] && coin[e] <= coin[e - 1])) return false;
+        }
+    }
+    if (order[0] != inputOrder[0]) return false;
+    vector<char> seen(n1, 0);
+    for (size_t i = 1; i < n1; i++) {
+        if (order[i] < 1 || order[i] > cs.n || seen[order[i]]) return false;
+        seen[order[i]] = 1;
+    }
+
+    sol.assign(max<size_t>(cnt, (size_t)t + 1), solution());
+    for (size_t c = 0; c < cnt; c++) {
+        solution& s = sol[c];
+        s.size = size[c];
+        s.value = value[c];
+        s.weight = weight[c];
+        for (int64_t e = start[c]; e < start[c + 1]; e++) s.svec.emplace_hint(s.svec.end(), coin[e], copies[e]);
+    }
+    if (memcmp(order, inputOrder, 4 * n1) != 0) {
+        cs.setOrder(vector<int>(order, order + n1));
+    }
+    return true;
+}
+
+template <typename T>
+static void append(string& buf, const T* data, size_t count) {
+    buf.append((const char*)data, count * sizeof(T));
+}
+
+bool KernelCache::store(KernelKind kind, const vector<int>& inputOrder, const CoinSet& cs,
+                        const vector<solution>& sol) const {
+    size_t n1 = (size_t)cs.n + 1;
+    if (cs.w.size() != n1 || cs.order.size() != n1 || inputOrder.size() != n1) return false;
+    if (sol.size() < (size_t)kernelSize(cs.u)) return false; // a partial kernel would load as a hit
+    size_t cnt = kernelSize(cs.u);
+    KernelFileHeader hd;
+    memcpy(hd.magic, KERNEL_MAGIC, 4);
+    hd.version = KERNEL_CACHE_VERSION;
+    hd.fingerprint = fingerprint(kind, cs, inputOrder);
+    hd.endian = ENDIAN_MARK;
+    hd.kind = (int32_t)kind;
+    hd.n = cs.n;
+    hd.u = cs.u;
+    hd.pLen = (int32_t)cs.p.size();
+    hd.count = (int32_t)cnt;
+
+    vector<int64_t> size(cnt), value(cnt), weight(cnt), start(cnt + 1, 0), copies;
+    vector<int32_t> coin;
+    for (size_t c = 0; c < cnt; c++) {
+        size[c] = sol[c].size;
+        value[c] = sol[c].value;
+        weight[c] = sol[c].weight;
+        for (auto& [x, k] : sol[c].svec) {
+            coin.push_back(x);
+            copies.push_back(k);
+        }
+        start[c + 1] = (int64_t)coin.size();
+    }
+    hd.entries = (int64_t)coin.size();
+
+    string buf;
+    append(buf, &hd, 1);
+    append(buf, size.data(), cnt);
+    append(buf, value.data(), cnt);
+    append(buf, weight.data(), cnt);
+    append(buf, start.data(), cnt + 1);
+    append(buf, copies.data(), copies.size());
+    append(buf, cs.w.data(), cs.w.size());
+    append(buf, cs.p.data(), cs.p.size());
+    append(buf, inputOrder.data(), inputOrder.size());
+    append(buf, cs.order.data(), cs.order.size());
+    append(buf, coin.data(), coin.size());
+
+    // write under a private name, then rename: readers see either no file or the whole file
+    string target = dir + "/" + fileName(kind, hd.fingerprint);
+    string tmp = target + ".tmp." + to_string(getpid()) + "." + to_string(hash<thread::id>()(this_thread::get_id()));
+    ofstream out(tmp, ios::binary);
+    out.write(buf.data(), buf.size());
+    out.close();
+    if (!out) {
+        remove(tmp.c_str());
+        return false;
+    }
+    if (rename(tmp.c_str(), target.c_str()) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool computeKernel(KernelKind kind, CoinSet& cs, int t, vector<solution>& sol, const KernelCache* cache) {
+    if (cache && cache->load(kind, cs, t, sol)) return true;
+    vector<int> inputOrder = cs.order;
+    string where = cache ? cache->path(kind, cs) : "";
+    switch (kind) {
+        case KernelKind::Knapsack: kernelComputation_knapsack(cs, t, sol); break;
+        case KernelKind::CoinChangeSimple: kernelComputation_coinchange_simple(cs, t, sol); break;
+        case KernelKind::CoinChangeRandomized: kernelComputation_coinchange_randomized(cs, t, sol); break;
+        case KernelKind::CoinChangeAdaptive: kernelComputation_coinchange(cs, t, sol); break;
+        case KernelKind::CoinChangeSmallU: kernelComputation_coinchange_smallU(cs, t, sol); break;
+    }
+    if (cache && !cache->store(kind, inputOrder, cs, sol)) {
+        cerr << "kernel cache: cannot store " << where << "\n";
+    }
+    return false;
+}
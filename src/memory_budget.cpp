@@ -0,0 +1,146 @@
+#include "memory_budget.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+struct MemoryCounters {
+    atomic<size_t> live[MEM_SUBSYSTEMS] = {};
+    atomic<size_t> peak[MEM_SUBSYSTEMS] = {};
+    atomic<size_t> liveTotal{0};
+    atomic<size_t> peakTotal{0};
+};
+
+MemoryCounters counters;
+
+size_t budgetFromEnv() {
+    const char* env = getenv("FASTKNAPSACK_MEMORY");
+    size_t bytes = 0;
+    if (env && *env && !parseByteSize(env, bytes)) {
+        cerr << "FASTKNAPSACK_MEMORY: cannot parse " << env << ", running without a memory budget\n";
+        bytes = 0;
+    }
+    return bytes;
+}
+
+atomic<size_t>& budget() {
+    static atomic<size_t> b{budgetFromEnv()};
+    return b;
+}
+
+void raisePeak(atomic<size_t>& peak, size_t now) {
+    size_t cur = peak.load(memory_order_relaxed);
+    while (now > cur && !peak.compare_exchange_weak(cur, now, memory_order_relaxed)) {}
+}
+
+}
+
+const char* memSubsystemName(MemSubsystem s) {
+    switch (s) {
+        case MemSubsystem::Convolution: return "convolution";
+        case MemSubsystem::Witness: return "witness";
+        case MemSubsystem::Peeling: return "peeling";
+        case MemSubsystem::Solutions: return "solutions";
+    }
+    return "?";
+}
+
+void memCharge(MemSubsystem s, size_t bytes) {
+    if (bytes == 0) return;
+    int i = (int)s;
+    raisePeak(counters.peak[i], counters.live[i].fetch_add(bytes, memory_order_relaxed) + bytes);
+    raisePeak(counters.peakTotal, counters.liveTotal.fetch_add(bytes, memory_order_relaxed) + bytes);
+}
+
+void memRelease(MemSubsystem s, size_t bytes) {
+    if (bytes == 0) return;
+    counters.live[(int)s].fetch_sub(bytes, memory_order_relaxed);
+    counters.liveTotal.fetch_sub(bytes, memory_order_relaxed);
+}
+
+MemoryUsage memoryUsage() {
+    MemoryUsage u;
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++) {
+        u.live[i] = counters.live[i].load(memory_order_relaxed);
+        u.peak[i] = counters.peak[i].load(memory_order_relaxed);
+    }
+    u.liveTotal = counters.liveTotal.load(memory_order_relaxed);
+    u.peakTotal = counters.peakTotal.load(memory_order_relaxed);
+    return u;
+}
+
+void memoryReport(ostream& out) {
+    MemoryUsage u = memoryUsage();
+    out << "Memory peak: " << formatBytes(u.peakTotal);
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++) {
+        if (u.peak[i] > 0) out << ", " << memSubsystemName((MemSubsystem)i) << " " << formatBytes(u.peak[i]);
+    }
+    size_t b = memoryBudget();
+    out << " (budget " << (b ? formatBytes(b) : string("unlimited")) << ")\n";
+}
+
+size_t memoryBudget() {
+    return budget().load(memory_order_relaxed);
+}
+
+void setMemoryBudget(size_t bytes) {
+    budget().store(bytes, memory_order_relaxed);
+}
+
+size_t memoryAvailable() {
+    size_t b = memoryBudget();
+    if (b == 0) return SIZE_MAX;
+    size_t live = counters.liveTotal.load(memory_order_relaxed);
+    return live >= b ? 0 : b - live;
+}
+
+bool parseByteSize(const string& text, size_t& bytes) {
+    size_t pos = 0;
+    unsigned long long v;
+    try {
+        v = stoull(text, &pos);
+    } catch (...) {
+        return false;
+    }
+    int shift = 0;
+    if (pos < text.size()) {
+        switch (toupper(text[pos])) {
+            case 'K': shift = 10; break;
+            case 'M': shift = 20; break;
+            case 'G': shift = 30; break;
+            case 'T': shift = 40; break;
+            default: return false;
+        }
+        pos++;
+        if (pos < text.size() && toupper(text[pos]) == 'I') pos++;
+        if (pos < text.size() && toupper(text[pos]) == 'B') pos++;
+    }
+    if (pos != text.size() || v > (SIZE_MAX >> shift)) return false;
+    bytes = (size_t)v << shift;
+    return true;
+}
+
+string formatBytes(size_t bytes) {
+    ostringstream s;
+    s << fixed << setprecision(1) << bytes / 1048576.0 << " MiB";
+    return s.str();
+}
+
+size_t MemoryEstimate::total() const {
+    size_t sum = 0;
+    for (size_t b : bytes) sum += b;
+    return sum;
+}
+
+void printEstimate(ostream& out, const MemoryEstimate& est) {
+    out << "total " << formatBytes(est.total());
+    string sep = " (";
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++) {
+        if (est.bytes[i] == 0) continue;
+        out << sep << memSubsystemName((MemSubsystem)i) << " " << formatBytes(est.bytes[i]);
+        sep = ", ";
+    }
+    if (sep == ", ") out << ")";
+}
@@ -1,5 +1,8 @@
 #include "convolution.h"
 #include "peeling.h"
+#include "instrument.h"
+#include "trace.h"
+#include "arena.h"
 
 // Randomized k-aligned-ones reconstruction
 // text: string of '0'/'1' length n
@@ -9,17 +12,25 @@
 vector<vector<int>> k_reconstruct_randomized(string &text,
                                   string &pat,
                                   int k) {
+    FK_SCOPED_TIMER("peeling.reconstruct");
     int n = text.size();
     int m = pat.size();
+    FK_TRACE("peeling.reconstruct", "witness", "n", n, "m", m);
     int L = n - m + 1;
     
+    // all scratch below lives in the thread's arena; families and tables are flat (family x m, family x chunk) arrays
+    ArenaScope scratch(MemSubsystem::Peeling);
+    pmr::memory_resource* mem = scratch.resource();
+
     // convert to int arrays
-    vector<int> a(n), p(m);
+    pmr::vector<int> a(n, mem), p(m, mem);
     for(int i = 0; i < n; ++i) a[i] = text[i] - '0';
     for(int j = 0; j < m; ++j) p[j] = pat[j] - '0';
 
     // full intersection sizes via convolution
-    vector<int> full_size = convolution(a, p);
+    int R = n + m - 1;
+    pmr::vector<int> full_size(R, mem);
+    convolution(a, p, full_size);
 
     // random engine
     mt19937_64 gen(random_device{}());
@@ -32,112 +43,137 @@ vector<vector<int>> k_reconstruct_randomized(string &text,
     double ln_nk = log(double(n) * kp);
 
     // build F1
-    vector<vector<bool>> F1;
+    pmr::vector<char> F1(mem);
+    int F1sz = 0;
     for(int j = 0; j <= logkp; ++j) {
+        F1sz += (int)ceil(((1ULL << (j+3)) * ln_nk) / logrec);
+    }
+    F1.assign((size_t)F1sz * m, 0);
+    for(int j = 0, idx = 0; j <= logkp; ++j) {
         int rj = (int)ceil(((1ULL << (j+3)) * ln_nk) / logrec);
         double prob = 1.0 / (1u << j);
         uniform_real_distribution<double> dist(0.0,1.0);
-        while(rj-- > 0) {
-            vector<bool> subset(m,false);
-            for(int idx=0; idx<m; ++idx)
-                if(p[idx] && dist(gen) < prob)
-                    subset[idx] = true;
-            F1.push_back(move(subset));
+        for(; rj-- > 0; ++idx) {
+            char* subset = &F1[(size_t)idx * m];
+            for(int x=0; x<m; ++x)
+                if(p[x] && dist(gen) < prob)
+                    subset[x] = 1;
         }
     }
-    int F1sz = F1.size();
-
-    // precompute ISIZE/ISUM for F1
-    vector<vector<int>> size1(F1sz, vector<int>(L));
-    vector<vector<int>> sum1(F1sz, vector<int>(L));
-    for(int idx=0; idx<F1sz; ++idx) {
-        vector<int> b(m), bsum(m);
-        for(int j=0; j<m; ++j)
-            if(F1[idx][j] && p[j]) { b[j]=1; bsum[j]=j; }
-        auto szv = convolution(a,b);
-        auto ssv = convolution(a,bsum);
-        for(int i=0;i<L;++i){ size1[idx][i]=szv[i]; sum1[idx][i]=ssv[i]; }
-    }
 
     // Phase II: k-separator
     int log4k = (int)ceil(log2(double(4*k)));
     int logm  = (int)ceil(log2(double(m)));
     double ln2n = log(double(2*n));
-    vector<vector<bool>> F2;
-    for(int j = log4k; j <= logm; ++j) {
+    auto rounds2 = [&](int j) {
         double term1 = (16.0/alpha) * ln2n;
         double term2 = (2.0/alpha) * (j * double(k)) / (j - 1 - log2(double(k)));
-        int rj = (int)ceil(term1 + term2);
+        return (int)ceil(term1 + term2);
+    };
+    int F2sz = 0;
+    for(int j = log4k; j <= logm; ++j) F2sz += rounds2(j);
+    pmr::vector<char> F2((size_t)F2sz * m, 0, mem);
+    for(int j = log4k, idx = 0; j <= logm; ++j) {
+        int rj = rounds2(j);
         double prob = 1.0 / (1u << j);
         uniform_real_distribution<double> dist2(0.0,1.0);
-        while(rj-- > 0) {
-            vector<bool> subset(m,false);
-            for(int idx=0; idx<m; ++idx)
-                if(p[idx] && dist2(gen) < prob)
-                    subset[idx] = true;
-            F2.push_back(move(subset));
+        for(; rj-- > 0; ++idx) {
+            char* subset = &F2[(size_t)idx * m];
+            for(int x=0; x<m; ++x)
+                if(p[x] && dist2(gen) < prob)
+                    subset[x] = 1;
         }
     }
-    int F2sz = F2.size();
-    vector<vector<int>> size2(F2sz, vector<int>(L));
-    vector<vector<int>> sum2(F2sz, vector<int>(L));
-    for(int idx=0; idx<F2sz; ++idx) {
-        vector<int> b(m), bsum(m);
-        for(int j=0; j<m; ++j)
-            if(F2[idx][j] && p[j]) { b[j]=1; bsum[j]=j; }
-        auto szv = convolution(a,b);
-        auto ssv = convolution(a,bsum);
-        for(int i=0;i<L;++i){ size2[idx][i]=szv[i]; sum2[idx][i]=ssv[i]; }
+    FK_COUNT("peeling.families", F1sz + F2sz);
+
+    // ISIZE/ISUM tables (family x alignment) of both families and the seen flags, for the alignments [i0, i1) of
+    // one chunk. Alignments are independent once the families are drawn, so a memory budget that does not hold
+    // the tables of all L alignments only cuts them into chunks; the result is the same.
+    size_t perAlignment = (size_t)(F1sz + F2sz) * 2 * sizeof(int) + m;
+    int chunk = L;
+    if ((size_t)L * perAlignment > memoryAvailable()) {
+        chunk = (int)max<size_t>(min<size_t>(L, m), min<size_t>(L, memoryAvailable() / perAlignment));
+        FK_COUNT("memory.peeling.chunked", (L + chunk - 1) / chunk);
     }
+    pmr::vector<int> b(m, mem), bsum(m, mem), szv(chunk + 2 * m, mem), ssv(chunk + 2 * m, mem);
+    pmr::vector<int> size1((size_t)F1sz * chunk, mem), sum1((size_t)F1sz * chunk, mem);
+    pmr::vector<int> size2((size_t)F2sz * chunk, mem), sum2((size_t)F2sz * chunk, mem);
+    pmr::vector<char> seen((size_t)chunk * m, mem);
+    auto tables = [&](const pmr::vector<char>& F, int Fsz, pmr::vector<int>& size, pmr::vector<int>& sum, int i0, int len) {
+        // entry i of the convolution only reads a[i-m+1..i]
+        int lo = max(0, i0 - m + 1);
+        span<const int> slice(a.data() + lo, i0 + len - lo);
+        span<int> szc(szv.data(), slice.size() + m - 1), ssc(ssv.data(), slice.size() + m - 1);
+        for(int idx=0; idx<Fsz; ++idx) {
+            for(int j=0; j<m; ++j) {
+                bool in = F[(size_t)idx * m + j] && p[j];
+                b[j] = in; bsum[j] = in ? j : 0;
+            }
+            convolution(slice, b, szc);
+            convolution(slice, bsum, ssc);
+            copy_n(szc.begin() + (i0 - lo), len, size.begin() + (size_t)idx * len);
+            copy_n(ssc.begin() + (i0 - lo), len, sum.begin() + (size_t)idx * len);
+        }
+    };
 
     // reconstruction containers
     vector<vector<int>> recovered(L);
-    vector<vector<bool>> seen(L, vector<bool>(m,false));
-
-    // Phase I peeling
-    for(int i=0;i<L;++i){
-        int need = min(k, full_size[i]);
-        bool progress = true;
-        while((int)recovered[i].size() < need && progress){
-            progress = false;
-            for(int idx=0; idx<F1sz; ++idx){
-                if(size1[idx][i]==1){
-                    int x = sum1[idx][i];
-                    if(x>=0 && x<m && !seen[i][x]){
-                        seen[i][x]=true;
-                        recovered[i].push_back(x);
-                        // update
-                        for(int j2=0;j2<F1sz;++j2)
-                            if(F1[j2][x]){
-                                --size1[j2][i];
-                                sum1[j2][i]-=x;
-                            }
-                        progress = true;
-                        break;
+    ll peeled = 0;
+    for(int i0 = 0; i0 < L; i0 += chunk) {
+        int len = min(chunk, L - i0);
+        tables(F1, F1sz, size1, sum1, i0, len);
+        tables(F2, F2sz, size2, sum2, i0, len);
+        fill(seen.begin(), seen.end(), 0);
+
+        // Phase I peeling
+        for(int i=i0;i<i0+len;++i){
+            int r = i - i0; // column of alignment i in the tables of this chunk
+            int need = min(k, full_size[i]);
+            bool progress = true;
+            while((int)recovered[i].size() < need && progress){
+                progress = false;
+                for(int idx=0; idx<F1sz; ++idx){
+                    if(size1[(size_t)idx * len + r]==1){
+                        int x = sum1[(size_t)idx * len + r];
+                        if(x>=0 && x<m && !seen[(size_t)r * m + x]){
+                            seen[(size_t)r * m + x]=1;
+                            recovered[i].push_back(x);
+                            peeled++;
+                            // update
+                            for(int j2=0;j2<F1sz;++j2)
+                                if(F1[(size_t)j2 * m + x]){
+                                    --size1[(size_t)j2 * len + r];
+                                    sum1[(size_t)j2 * len + r]-=x;
+                                }
+                            progress = true;
+                            break;
+                        }
                     }
                 }
             }
         }
-    }
-    // Phase II scanning
-    for(int i=0;i<L;++i){
-        while((int)recovered[i].size() < k){
-            bool found = false;
-            for(int idx=0; idx<F2sz; ++idx){
-                if(size2[idx][i]==1){
-                    int x = sum2[idx][i];
-                    if(x>=0 && x<m && !seen[i][x]){
-                        seen[i][x]=true;
-                        recovered[i].push_back(x);
-                        found=true;
-                        break;
+        // Phase II scanning
+        for(int i=i0;i<i0+len;++i){
+            int r = i - i0;
+            while((int)recovered[i].size() < k){
+                bool found = false;
+                for(int idx=0; idx<F2sz; ++idx){
+                    if(size2[(size_t)idx * len + r]==1){
+                        int x = sum2[(size_t)idx * len + r];
+                        if(x>=0 && x<m && !seen[(size_t)r * m + x]){
+                            seen[(size_t)r * m + x]=1;
+                            recovered[i].push_back(x);
+                            found=true;
+                            break;
+                        }
                     }
                 }
+                if(!found) break;
             }
-            if(!found) break;
+            sort(recovered[i].begin(), recovered[i].end());
         }
-        sort(recovered[i].begin(), recovered[i].end());
     }
+    FK_COUNT("peeling.iterations", peeled);
     return recovered;
 }
 
@@ -175,32 +211,26 @@ vector<vector<int>> k_find_witnesses_knapsack(
     vector<int> &order,
     vector<int> &w,
     int k
+) {
+    CoinSet cs((int)order.size() - 1, 0, w, {}, order); // order is 1-indexed
+    return k_find_witnesses_knapsack(a, b, cs, k);
+}
+
+vector<vector<int>> k_find_witnesses_knapsack(
+    vector<int> &a,
+    vector<int> &b,
+    const CoinSet &cs,
+    int k
 ) {
     int U = (int)a.size();
     int S = (int)b.size();
-    int C = (int)order.size() - 1; // order is 1-indexed
 
     // 1) Use the generic k-witness finder on the binary vectors a, b
     auto rec = k_find_witnesses_randomized(a, b, k);
     int L = (int)rec.size();  // alignment count = U - S + 1
 
-    // 2) Build mapping from weight -> list of randomized-order indices
-    vector<vector<int>> weightToOIdx(U);
-    for (int oidx = 1; oidx <= C; ++oidx) {
-        int coin = order[oidx];      // real coin index
-        int wt = w[coin];            // its weight
-        if (wt >= 0 && wt < U && a[wt]) {
-            weightToOIdx[wt].push_back(oidx);
-        }
-    }
-
-    // 3) Invert order: randomized-order index -> real coin index
-    vector<int> invOrder(C+1);
-    for (int oidx = 1; oidx <= C; ++oidx) {
-        invOrder[oidx] = order[oidx];
-    }
-
-    // 4) Collect up to k real coin indices per convolution-sum position
+    // 2) Collect up to k real coin indices per convolution-sum position,
+    //    reading the coins of each weight from the weight -> order index ranges of cs
     vector<vector<int>> witnesses(U + S - 1);
     for (int i = 0; i < L; ++i) {
         // alignment i corresponds to convolution position i+(S-1)
@@ -208,8 +238,9 @@ vector<vector<int>> k_find_witnesses_knapsack(
         auto &out = witnesses[s];
         for (int j : rec[i]) {
             int wt = i + j;  // weight position in a
-            for (int oidx : weightToOIdx[wt]) {
-                out.push_back(invOrder[oidx]);
+            if (wt > cs.u) continue;
+            for (int e = cs.weightStart[wt]; e < cs.weightStart[wt + 1]; ++e) {
+                out.push_back(cs.order[cs.byWeight[e]]);
                 if ((int)out.size() >= k) break;
             }
             if ((int)out.size() >= k) break;
@@ -218,5 +249,3 @@ vector<vector<int>> k_find_witnesses_knapsack(
 
     return witnesses;
 }
-
-
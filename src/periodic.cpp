@@ -0,0 +1,104 @@
+#include "periodic.h"
+#include "algorithms.h"
+#include <numeric>
+
+PeriodicKnapsack::PeriodicKnapsack()
+  : best(0), threshold(0), period(1), periodProfit(0), base()
+{}
+
+ll PeriodicKnapsack::reduce(ll t, ll& copies) const {
+    copies = 0;
+    ll limit = threshold + period;
+    if (t >= limit) {
+        copies = (t - threshold) / period;
+        t -= copies * period; // now t ∈ [threshold, threshold + period)
+    }
+    return t;
+}
+
+bool PeriodicKnapsack::feasible(ll t) const {
+    if (t < 0) return false;
+    ll copies;
+    ll c = reduce(t, copies);
+    return c == 0 || base[c].size > 0;
+}
+
+ll PeriodicKnapsack::value(ll t) const {
+    if (!feasible(t)) return NEG_INF;
+    ll copies;
+    ll c = reduce(t, copies);
+    return periodicValue(base[c].value, copies, periodProfit);
+}
+
+map<int,ll> PeriodicKnapsack::multiset(ll t) const {
+    if (!feasible(t)) return {};
+    ll copies;
+    ll c = reduce(t, copies);
+    map<int,ll> res = base[c].svec;
+    if (copies > 0) res[best] += copies;
+    return res;
+}
+
+/**
+ * Picks the coin with the best profit/weight ratio (ties go to the lighter coin, which gives a smaller threshold),
+ * then runs Algorithm 2 + Algorithm 1 up to threshold + period.
+ */
+bool buildPeriodicKnapsack(
+    int n, int u,
+    const vector<int>& w,
+    const vector<int>& p,
+    const vector<int>& order,
+    PeriodicKnapsack& pk
+) {
+    CoinSet cs(n, u, w, p, order);
+    return buildPeriodicKnapsack(cs, pk);
+}
+
+ll periodicValue(ll baseValue, ll copies, ll profit) {
+    __int128 v = (__int128)baseValue + (__int128)copies * profit;
+    return (ll)clamp<__int128>(v, -LLONG_MAX, LLONG_MAX);
+}
+
+int bestRatioCoin(const CoinSet& cs) {
+    int best = 1;
+    for (int i = 2; i <= cs.n; i++) {
+        ll lhs = (ll)cs.profitAt(i) * cs.weightAt(best);
+        ll rhs = (ll)cs.profitAt(best) * cs.weightAt(i);
+        if (lhs > rhs || (lhs == rhs && cs.weightAt(i) < cs.weightAt(best))) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+ll periodicThreshold(const CoinSet& cs, int best) {
+    ll wb = cs.weightAt(best);
+    ll g = wb, heaviest = 0;
+    for (int i = 1; i <= cs.n; i++) {
+        if (i == best) continue;
+        g = gcd(g, (ll)cs.weightAt(i));
+        heaviest = max(heaviest, (ll)cs.weightAt(i));
+    }
+    return (wb / g - 1) * heaviest + 1;
+}
+
+ll periodicBaseSize(const CoinSet& cs) {
+    int best = bestRatioCoin(cs);
+    return periodicThreshold(cs, best) + cs.weightAt(best);
+}
+
+bool buildPeriodicKnapsack(const CoinSet& cs, PeriodicKnapsack& pk) {
+    int best = bestRatioCoin(cs);
+    ll threshold = periodicThreshold(cs, best);
+    ll limit = threshold + cs.weightAt(best); // base covers [0, limit)
+    if (limit > PERIODIC_MAX_BASE) return false;
+
+    pk.best = best;
+    pk.period = cs.weightAt(best);
+    pk.periodProfit = cs.profitAt(best);
+    pk.threshold = threshold;
+    kernelComputation_knapsack(cs, (int)limit - 1, pk.base);
+    propagation(cs, (int)limit - 1, pk.base);
+    pk.base.resize(limit);
+    return true;
+}
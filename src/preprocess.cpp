@@ -0,0 +1,82 @@
+#include "preprocess.h"
+#include <numeric>
+
+ReducedInstance::ReducedInstance()
+  : n(0), u(0), g(1)
+{}
+
+ll ReducedInstance::target(ll t) const {
+    if (t < 0 || t % g != 0) return -1;
+    return t / g;
+}
+
+map<int,ll> ReducedInstance::originalMultiset(const map<int,ll>& svec) const {
+    map<int,ll> res;
+    for (auto const& [x, cnt] : svec) {
+        res[original[order[x]]] += cnt;
+    }
+    return res;
+}
+
+CoinSet ReducedInstance::coins() const {
+    return CoinSet(n, u, w, p, order);
+}
+
+void reduceInstance(
+    int n, int u,
+    const vector<int>& w,
+    const vector<int>& p,
+    const vector<int>& order,
+    ReducedInstance& ri
+) {
+    for (int x = 1; x <= n; x++) {
+        u = max(u, w[order[x]]);
+    }
+
+    // best[x] = order index of the most profitable coin of weight x (the earliest one on ties), 0 if none
+    vector<int> best(u + 1, 0);
+    for (int x = 1; x <= n; x++) {
+        int wt = w[order[x]];
+        if (best[wt] == 0 || p[order[x]] > p[order[best[wt]]]) {
+            best[wt] = x;
+        }
+    }
+
+    // a weight is dropped if one of its proper divisors y has m·p ≥ its best profit (m = weight / y);
+    // dominance is transitive, so checking against weights that are dropped themselves is fine
+    vector<char> dropped(u + 1, 0);
+    for (int y = 1; y <= u; y++) {
+        if (best[y] == 0) continue;
+        ll py = p[order[best[y]]];
+        for (int x = 2 * y, m = 2; x <= u; x += y, m++) {
+            if (best[x] != 0 && !dropped[x] && (ll)p[order[best[x]]] <= m * py) {
+                dropped[x] = 1;
+            }
+        }
+    }
+
+    int g = 0;
+    for (int y = 1; y <= u; y++) {
+        if (best[y] != 0 && !dropped[y]) g = gcd(g, y);
+    }
+    ri.g = max(g, 1);
+
+    // survivors in increasing order index, so the induced order is order restricted to them
+    ri.n = 0;
+    ri.u = 0;
+    ri.w.assign(1, 0);
+    ri.p.assign(1, 0);
+    ri.order.assign(1, 0);
+    ri.original.assign(1, 0);
+    for (int x = 1; x <= n; x++) {
+        int coin = order[x];
+        int wt = w[coin];
+        if (dropped[wt] || best[wt] != x) continue;
+        ri.n++;
+        ri.w.push_back(wt / ri.g);
+        ri.p.push_back(p[coin]);
+        ri.order.push_back(ri.n);
+        ri.original.push_back(coin);
+        ri.u = max(ri.u, wt / ri.g);
+    }
+}
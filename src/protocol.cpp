@@ -0,0 +1,133 @@
+#include "protocol.h"
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+const char* responseStatusName(ResponseStatus status) {
+    switch (status) {
+        case ResponseStatus::Ok: return "ok";
+        case ResponseStatus::BadRequest: return "bad request";
+        case ResponseStatus::DeadlineExceeded: return "deadline exceeded";
+        case ResponseStatus::ShuttingDown: return "shutting down";
+        case ResponseStatus::ResourceExhausted: return "resource exhausted";
+        case ResponseStatus::InternalError: return "internal error";
+    }
+    return "unknown";
+}
+
+bool readFully(int fd, char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t got = read(fd, buf, len);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        buf += got;
+        len -= (size_t)got;
+    }
+    return true;
+}
+
+static void encodeHeader(char* h, const char* magic, uint32_t code, uint32_t flags, uint64_t id, ll micros,
+                         size_t payloadLen) {
+    memcpy(h, magic, 4);
+    storeLE<uint32_t>(h + 4, PROTOCOL_VERSION);
+    storeLE<uint32_t>(h + 8, code);
+    storeLE<uint32_t>(h + 12, flags);
+    storeLE<uint64_t>(h + 16, id);
+    storeLE<int64_t>(h + 24, micros);
+    storeLE<uint64_t>(h + 32, payloadLen);
+}
+
+/// Reads a header with `magic` and its payload; false on EOF, a foreign header or a payload above `maxPayload`.
+static bool readMessage(int fd, const char* magic, char* h, string& payload, size_t maxPayload) {
+    if (!readFully(fd, h, MESSAGE_HEADER)) return false;
+    if (memcmp(h, magic, 4) != 0 || loadLE<uint32_t>(h + 4) != PROTOCOL_VERSION) return false;
+    uint64_t len = loadLE<uint64_t>(h + 32);
+    if (len > maxPayload) return false;
+    payload.resize(len);
+    return readFully(fd, payload.data(), len);
+}
+
+bool readRequest(int fd, Request& req, size_t maxPayload) {
+    char h[MESSAGE_HEADER];
+    if (!readMessage(fd, REQUEST_MAGIC, h, req.payload, maxPayload)) return false;
+    req.type = (RequestType)loadLE<uint32_t>(h + 8);
+    req.id = loadLE<uint64_t>(h + 16);
+    req.deadlineMicros = loadLE<int64_t>(h + 24);
+    return true;
+}
+
+bool writeRequest(int fd, const Request& req) {
+    char h[MESSAGE_HEADER];
+    encodeHeader(h, REQUEST_MAGIC, (uint32_t)req.type, 0, req.id, req.deadlineMicros, req.payload.size());
+    return writeFully(fd, {{h, MESSAGE_HEADER}, {(void*)req.payload.data(), req.payload.size()}});
+}
+
+bool readResponse(int fd, Response& res) {
+    char h[MESSAGE_HEADER];
+    if (!readMessage(fd, RESPONSE_MAGIC, h, res.payload, SIZE_MAX)) return false;
+    res.status = (ResponseStatus)loadLE<uint32_t>(h + 8);
+    res.flags = loadLE<uint32_t>(h + 12);
+    res.id = loadLE<uint64_t>(h + 16);
+    res.computeMicros = loadLE<int64_t>(h + 24);
+    return true;
+}
+
+bool writeResponse(int fd, const Response& res) {
+    char h[MESSAGE_HEADER];
+    encodeHeader(h, RESPONSE_MAGIC, (uint32_t)res.status, res.flags, res.id, res.computeMicros, res.payload.size());
+    return writeFully(fd, {{h, MESSAGE_HEADER}, {(void*)res.payload.data(), res.payload.size()}});
+}
+
+string encodeQuery(const vector<ll>& targets, const Instance& inst) {
+    string buf(8 * (targets.size() + 1), '\0');
+    storeLE<int64_t>(buf.data(), (ll)targets.size());
+    for (size_t i = 0; i < targets.size(); i++) storeLE<int64_t>(buf.data() + 8 * (i + 1), targets[i]);
+    return buf + encodeBinaryInstance(inst);
+}
+
+bool decodeQuery(const string& payload, vector<ll>& targets, InstanceView& view) {
+    if (payload.size() < 8) return false;
+    ll q = loadLE<int64_t>(payload.data());
+    if (q < 0 || (size_t)q > (payload.size() - 8) / 8) return false;
+    targets.resize(q);
+    for (ll i = 0; i < q; i++) targets[i] = loadLE<int64_t>(payload.data() + 8 * (i + 1));
+    size_t used = 8 * ((size_t)q + 1);
+    return parseBinaryInstance(payload.data() + used, payload.size() - used, view);
+}
+
+string encodeValues(const vector<ll>& values) {
+    string buf(8 * values.size(), '\0');
+    if constexpr (endian::native == endian::little) {
+        memcpy(buf.data(), values.data(), buf.size());
+    } else {
+        for (size_t i = 0; i < values.size(); i++) storeLE<int64_t>(buf.data() + 8 * i, values[i]);
+    }
+    return buf;
+}
+
+bool decodeValues(const string& payload, vector<ll>& values) {
+    if (payload.size() % 8 != 0) return false;
+    values.resize(payload.size() / 8);
+    for (size_t i = 0; i < values.size(); i++) values[i] = loadLE<int64_t>(payload.data() + 8 * i);
+    return true;
+}
+
+int connectSocket(const string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
@@ -0,0 +1,85 @@
+#include "query.h"
+#include "algorithms.h"
+#include "periodic.h"
+
+TargetQuery::TargetQuery(const CoinSet& cs, const KernelCache* cache)
+  : cs(cs), sol(), best(1), period(1), periodProfit(0), thresholdTarget(0), done(0), fromCache(false),
+    table(MemSubsystem::Solutions)
+{
+    best = bestRatioCoin(cs);
+    period = cs.weightAt(best);
+    periodProfit = cs.profitAt(best);
+    thresholdTarget = periodicThreshold(cs, best);
+    fromCache = computeKernel(KernelKind::Knapsack, this->cs, 0, sol, cache); // sol[0..k·u]; sol[0] is final
+    table.set(solutionTableBytes(sol, 0, (int)sol.size() - 1));
+}
+
+/// Target in [0, threshold + period) with the same answer up to `copies` extra copies of the period coin.
+static ll landing(ll t, ll threshold, ll period, ll& copies) {
+    copies = 0;
+    if (t >= threshold + period) {
+        copies = (t - threshold) / period;
+        t -= copies * period; // now t ∈ [threshold, threshold + period)
+    }
+    return t;
+}
+
+ll TargetQuery::land(ll t, ll& copies) const {
+    return landing(t, thresholdTarget, period, copies);
+}
+
+bool TargetQuery::answerable(const CoinSet& cs, const vector<ll>& targets) {
+    int best = bestRatioCoin(cs);
+    ll threshold = periodicThreshold(cs, best), copies;
+    for (ll t : targets) {
+        if (t >= 0 && landing(t, threshold, cs.weightAt(best), copies) >= PERIODIC_MAX_BASE) return false;
+    }
+    return true;
+}
+
+bool TargetQuery::answerable(ll t) const {
+    ll copies;
+    return t < 0 || land(t, copies) < PERIODIC_MAX_BASE;
+}
+
+void TargetQuery::extend(ll limit) {
+    if (limit <= done) return;
+    int c = (int)limit; // below PERIODIC_MAX_BASE, checked by the callers
+    size_t before = solutionTableBytes(sol, done + 1, c); // only (done, c] changes
+    if ((int)sol.size() <= c) sol.resize(c + 1);
+    propagation(cs, done, c, sol);
+    table.set(table.held() - before + solutionTableBytes(sol, done + 1, c));
+    done = c;
+}
+
+ll TargetQuery::value(ll t) {
+    if (t < 0 || !answerable(t)) return NEG_INF;
+    ll copies;
+    ll c = land(t, copies);
+    extend(c);
+    if (c != 0 && sol[c].size == 0) return NEG_INF;
+    return periodicValue(sol[c].value, copies, periodProfit);
+}
+
+map<int,ll> TargetQuery::multiset(ll t) {
+    if (value(t) == NEG_INF) return {};
+    ll copies;
+    ll c = land(t, copies);
+    map<int,ll> res = sol[c].svec;
+    if (copies > 0) res[best] += copies;
+    return res;
+}
+
+vector<ll> TargetQuery::values(const vector<ll>& targets) {
+    ll limit = done;
+    for (ll t : targets) {
+        if (t < 0 || !answerable(t)) continue;
+        ll copies;
+        limit = max(limit, land(t, copies));
+    }
+    extend(limit);
+    vector<ll> res;
+    res.reserve(targets.size());
+    for (ll t : targets) res.push_back(value(t));
+    return res;
+}
@@ -0,0 +1,344 @@
+#include "server.h"
+#include "dispatch.h"
+#include "periodic.h"
+#include <cerrno>
+#include <csignal>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+KnapsackServer::Connection::~Connection() {
+    close(fd);
+}
+
+KnapsackServer::KnapsackServer(const Options& options)
+  : options(options), listenFd(-1), stopping(false), draining(false),
+    requests(0), failed(0), late(0), kernelHits(0), kernelBuilds(0), diskHits(0)
+{
+    this->options.workers = max(1, this->options.workers);
+    this->options.maxKernels = max(1, this->options.maxKernels);
+    if (!options.kernelCacheDir.empty()) diskCache = make_unique<KernelCache>(options.kernelCacheDir);
+}
+
+KnapsackServer::~KnapsackServer() {
+    if (listenFd >= 0) close(listenFd);
+}
+
+bool KnapsackServer::listen() {
+    const string& path = options.socketPath;
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    // a socket file nobody accepts on is left over from a server that died; anything else is not ours to remove
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        int probe = connectSocket(path);
+        if (probe >= 0 || !S_ISSOCK(st.st_mode)) {
+            if (probe >= 0) close(probe);
+            errno = EADDRINUSE;
+            return false;
+        }
+        unlink(path.c_str());
+    }
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) return false;
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 128) != 0) {
+        int err = errno;
+        close(listenFd);
+        listenFd = -1;
+        errno = err;
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN); // a client that hangs up fails the write instead of killing the server
+    return true;
+}
+
+void KnapsackServer::shutdown() {
+    stopping = true;
+    if (listenFd >= 0) ::shutdown(listenFd, SHUT_RDWR); // wakes the accept() in run()
+}
+
+void KnapsackServer::run() {
+    vector<thread> workers;
+    for (int i = 0; i < options.workers; i++) workers.emplace_back([this] { workerLoop(); });
+
+    while (!stopping) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                this_thread::sleep_for(chrono::milliseconds(10));
+                continue;
+            }
+            break; // shut down
+        }
+        joinReaders(false);
+        auto conn = make_shared<Connection>(fd);
+        {
+            // started under the lock, so the thread is in readerThreads before it can report itself finished
+            lock_guard<mutex> g(connLock);
+            erase_if(connections, [](const weak_ptr<Connection>& c) { return c.expired(); });
+            connections.push_back(conn);
+            thread reader([this, conn] { readerLoop(conn); });
+            readerThreads.emplace(reader.get_id(), move(reader));
+        }
+    }
+
+    // stop reading, answer what was read, then let the workers go
+    {
+        lock_guard<mutex> g(connLock);
+        for (auto& weak : connections) {
+            if (auto conn = weak.lock()) ::shutdown(conn->fd, SHUT_RD);
+        }
+    }
+    joinReaders(true);
+    {
+        lock_guard<mutex> g(queueLock);
+        draining = true;
+    }
+    queueReady.notify_all();
+    for (auto& th : workers) th.join();
+    unlink(options.socketPath.c_str());
+}
+
+void KnapsackServer::readerLoop(shared_ptr<Connection> conn) {
+    Request req;
+    while (!stopping && readRequest(conn->fd, req, options.maxPayload)) {
+        {
+            lock_guard<mutex> g(queueLock);
+            queue.push_back({conn, move(req), chrono::steady_clock::now()});
+        }
+        queueReady.notify_one();
+        req = Request();
+    }
+    lock_guard<mutex> g(connLock);
+    finishedReaders.push_back(this_thread::get_id());
+}
+
+void KnapsackServer::joinReaders(bool all) {
+    vector<thread> done;
+    {
+        lock_guard<mutex> g(connLock);
+        if (all) {
+            for (auto& [id, th] : readerThreads) done.push_back(move(th));
+            readerThreads.clear();
+        } else {
+            for (thread::id id : finishedReaders) {
+                auto it = readerThreads.find(id);
+                done.push_back(move(it->second));
+                readerThreads.erase(it);
+            }
+        }
+        finishedReaders.clear();
+    }
+    for (auto& th : done) th.join(); // outside the lock: a reader takes it on the way out
+}
+
+static Response failure(ResponseStatus status, const string& message) {
+    Response res;
+    res.status = status;
+    res.payload = message;
+    return res;
+}
+
+void KnapsackServer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            unique_lock<mutex> g(queueLock);
+            queueReady.wait(g, [this] { return !queue.empty() || draining; });
+            if (queue.empty()) return;
+            job = move(queue.front());
+            queue.pop_front();
+        }
+        requests++;
+        auto start = chrono::steady_clock::now();
+        Response res;
+        try {
+            res = answer(job);
+        } catch (const bad_alloc&) {
+            res = failure(ResponseStatus::ResourceExhausted, "out of memory while answering");
+        } catch (const exception& e) {
+            res = failure(ResponseStatus::InternalError, e.what());
+        } catch (...) {
+            res = failure(ResponseStatus::InternalError, "unknown error while answering");
+        }
+        res.id = job.req.id;
+        res.computeMicros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        if (res.status == ResponseStatus::Ok && expired(job)) {
+            res.status = ResponseStatus::DeadlineExceeded;
+            res.payload = "deadline exceeded while answering";
+        }
+        if (res.status == ResponseStatus::BadRequest || res.status == ResponseStatus::ResourceExhausted
+            || res.status == ResponseStatus::InternalError) {
+            failed++;
+        }
+        if (res.status == ResponseStatus::DeadlineExceeded) late++;
+        lock_guard<mutex> g(job.conn->writeLock);
+        writeResponse(job.conn->fd, res); // a client that hung up does not get its answer
+    }
+}
+
+bool KnapsackServer::expired(const Job& job) const {
+    if (job.req.deadlineMicros <= 0) return false;
+    return chrono::steady_clock::now() - job.received > chrono::microseconds(job.req.deadlineMicros);
+}
+
+Response KnapsackServer::answer(Job& job) {
+    if (expired(job)) return failure(ResponseStatus::DeadlineExceeded, "deadline exceeded in the queue");
+    switch (job.req.type) {
+        case RequestType::Solve: {
+            InstanceView view;
+            if (!parseBinaryInstance(job.req.payload.data(), job.req.payload.size(), view)) {
+                return failure(ResponseStatus::BadRequest, "malformed instance");
+            }
+            return solve(job, view, nullptr);
+        }
+        case RequestType::Query: {
+            vector<ll> targets;
+            InstanceView view;
+            if (!decodeQuery(job.req.payload, targets, view)) {
+                return failure(ResponseStatus::BadRequest, "malformed query");
+            }
+            return solve(job, view, &targets);
+        }
+        case RequestType::Stats: {
+            Response res;
+            res.payload = stats();
+            return res;
+        }
+        case RequestType::Shutdown: {
+            shutdown();
+            Response res;
+            res.payload = "shutting down";
+            return res;
+        }
+    }
+    return failure(ResponseStatus::BadRequest, "unknown request type " + to_string((uint32_t)job.req.type));
+}
+
+Response KnapsackServer::solve(const Job& job, const InstanceView& view, const vector<ll>* targets) {
+    Instance inst;
+    instanceFromView(view, inst);
+    if (inst.n < 1 || inst.u < 1) return failure(ResponseStatus::BadRequest, "the instance needs n >= 1 and u >= 1");
+    for (int i = 1; i <= inst.n; i++) {
+        if (inst.w[i] < 1) {
+            return failure(ResponseStatus::BadRequest, "coin " + to_string(i) + " has a weight below 1");
+        }
+    }
+    if (!targets && (inst.t < 0 || inst.t > INT_MAX - 1)) {
+        return failure(ResponseStatus::BadRequest, "t = " + to_string(inst.t) + " is out of range");
+    }
+    ll count = targets ? (ll)targets->size() : (ll)inst.t + 1;
+    if (count > options.maxTargets) {
+        return failure(ResponseStatus::ResourceExhausted, to_string(count) + " targets, the server answers at most " +
+                       to_string(options.maxTargets) + " per request");
+    }
+
+    vector<int> order(inst.n + 1);
+    for (int i = 1; i <= inst.n; i++) order[i] = i; // identity lex order, like knapsack_solver
+    ReducedInstance ri;
+    reduceInstance(inst.n, inst.u, inst.w, inst.p, order, ri);
+
+    // targets that are not multiples of the gcd of this instance are unreachable; every other target has to
+    // land in the part of the table a TargetQuery can build
+    vector<ll> reduced;
+    if (targets) {
+        reduced.reserve(targets->size());
+        for (ll x : *targets) reduced.push_back(ri.target(x));
+    } else {
+        reduced.resize(inst.t + 1);
+        for (ll c = 0; c <= inst.t; c++) reduced[c] = ri.target(c);
+    }
+    if (!TargetQuery::answerable(ri.coins(), reduced)) {
+        return failure(ResponseStatus::BadRequest, "targets land beyond " + to_string(PERIODIC_MAX_BASE) +
+                       " solutions: the periodic threshold of this instance is too large");
+    }
+    // the table the query propagates (up to the highest landing point) plus the reduced targets, the values
+    // and the encoded answer
+    ll top = 0;
+    for (ll x : reduced) top = max(top, x);
+    top = min(top, periodicBaseSize(ri.coins()));
+    size_t need = estimateMemory(Strategy::Kernel, InstanceStats{ri.n, ri.u, (int)top}).total()
+                + 3 * (size_t)count * sizeof(ll);
+    if (need > memoryAvailable()) {
+        return failure(ResponseStatus::ResourceExhausted, "needs about " + formatBytes(need) + ", " +
+                       formatBytes(memoryAvailable()) + " of the memory budget is left");
+    }
+    shared_ptr<KernelEntry> entry = kernel(ri);
+
+    Response res;
+    lock_guard<mutex> g(entry->lock);
+    if (entry->query) {
+        res.flags |= RESPONSE_KERNEL_WARM;
+        kernelHits++;
+    } else {
+        entry->query = make_unique<TargetQuery>(ri.coins(), diskCache.get());
+        kernelBuilds++;
+        if (entry->query->cachedKernel()) {
+            res.flags |= RESPONSE_KERNEL_CACHED;
+            diskHits++;
+        }
+    }
+    if (expired(job)) return failure(ResponseStatus::DeadlineExceeded, "deadline exceeded after the kernel");
+
+    vector<ll> values = entry->query->values(reduced);
+    for (ll& v : values) {
+        if (v == NEG_INF) v = -1000000000;
+    }
+    res.payload = encodeValues(values);
+    return res;
+}
+
+shared_ptr<KnapsackServer::KernelEntry> KnapsackServer::kernel(const ReducedInstance& ri) {
+    unsigned long long h = kernelFingerprint(KernelKind::Knapsack, ri.coins());
+    lock_guard<mutex> g(kernelLock);
+    auto it = kernels.find(h);
+    if (it != kernels.end()) {
+        const ReducedInstance& cached = it->second.first->ri;
+        if (cached.w == ri.w && cached.p == ri.p && cached.order == ri.order) {
+            lru.splice(lru.begin(), lru, it->second.second);
+            return it->second.first;
+        }
+        lru.erase(it->second.second); // fingerprint collision: the newer instance takes the slot
+        kernels.erase(it);
+    }
+    auto entry = make_shared<KernelEntry>();
+    entry->ri = ri;
+    lru.push_front(h);
+    kernels[h] = {entry, lru.begin()};
+    while ((int)kernels.size() > options.maxKernels) {
+        kernels.erase(lru.back()); // requests still using it keep it alive until they finish
+        lru.pop_back();
+    }
+    return entry;
+}
+
+string KnapsackServer::stats() {
+    size_t inMemory, queued;
+    {
+        lock_guard<mutex> g(kernelLock);
+        inMemory = kernels.size();
+    }
+    {
+        lock_guard<mutex> g(queueLock);
+        queued = queue.size();
+    }
+    ostringstream out;
+    out << "requests " << requests << "\n"
+        << "bad_requests " << failed << "\n"
+        << "deadline_exceeded " << late << "\n"
+        << "kernel_hits " << kernelHits << "\n"
+        << "kernel_builds " << kernelBuilds << "\n"
+        << "disk_cache_hits " << diskHits << "\n"
+        << "kernels_in_memory " << inMemory << "\n"
+        << "queued " << queued << "\n"
+        << "workers " << options.workers << "\n";
+    return out.str();
+}
@@ -0,0 +1,233 @@
+#include "small_u.h"
+#include "algorithms.h"
+#include "instrument.h"
+#include "trace.h"
+#include <cstdint>
+
+typedef uint64_t word;
+
+/// W·64 bits, kept in registers by the instantiations below.
+template <int W>
+struct WordSet {
+    word bits[W];
+
+    void clear() {
+        for (int i = 0; i < W; i++) bits[i] = 0;
+    }
+    void set(int b) {
+        bits[b >> 6] |= word(1) << (b & 63);
+    }
+    void unite(const WordSet& o) {
+        for (int i = 0; i < W; i++) bits[i] |= o.bits[i];
+    }
+};
+
+/// dst |= f << c, where dst covers bit c + u within its size
+template <int W>
+static inline void orShifted(vector<word>& dst, const WordSet<W>& f, int c) {
+    int q = c >> 6, r = c & 63;
+    if (r == 0) {
+        for (int j = 0; j < W; j++) dst[q + j] |= f.bits[j];
+        return;
+    }
+    for (int j = 0; j < W; j++) {
+        dst[q + j] |= f.bits[j] << r;
+        dst[q + j + 1] |= f.bits[j] >> (64 - r);
+    }
+}
+
+/// Word i of (a << s)
+static inline word shiftedWord(const vector<word>& a, int s, int i) {
+    int q = s >> 6, r = s & 63;
+    int src = i - q;
+    if (src < 0) return 0;
+    if (r == 0) return a[src];
+    word hi = a[src] << r;
+    word lo = src > 0 ? a[src - 1] >> (64 - r) : 0;
+    return hi | lo;
+}
+
+/// (order index, weight) of the smallest order index of every distinct weight, by ascending order index
+static vector<pair<int,int>> witnessCandidates(const CoinSet& cs) {
+    vector<pair<int,int>> coins;
+    for (int x = 1; x <= cs.u; x++) {
+        if (cs.indexOfWeight[x] >= 0) coins.push_back({cs.indexOfWeight[x], x});
+    }
+    sort(coins.begin(), coins.end());
+    return coins;
+}
+
+template <int W>
+static void smallKernel(const CoinSet& cs, int t, vector<solution>& sol) {
+    int u  = cs.u;
+    int k  = static_cast<int>(floor(2.0 * log2(u) + 1.0));
+    int KU = k * u + 1;
+    sol.assign(max(KU, t + 1), solution());
+
+    WordSet<W> f;
+    f.clear();
+    for (int x = 1; x <= u; x++) {
+        if (cs.f[x]) f.set(x);
+    }
+    vector<pair<int,int>> coins = witnessCandidates(cs);
+
+    // bit c of reached / frontier = capacity c; W + 1 spare words absorb the shifts past KU
+    int words = (KU + 63) / 64 + W + 1;
+    vector<word> reached(words, 0), frontier(words, 0), next(words, 0);
+    reached[0] = frontier[0] = 1;
+    int loW = 0, hiW = 0; // words of the frontier that may be non-zero
+
+    for (int iter = 1; iter <= k; iter++) {
+        // 1) shift-OR: every frontier capacity c contributes f << c
+        int nLo = loW, nHi = min(words - 1, hiW + W + 1);
+        fill(next.begin() + nLo, next.begin() + nHi + 1, 0);
+        for (int i = loW; i <= hiW; i++) {
+            for (word b = frontier[i]; b; b &= b - 1) {
+                orShifted(next, f, i * 64 + __builtin_ctzll(b));
+            }
+        }
+
+        // 2) keep the capacities below KU that were not reached before
+        int pending = 0;
+        for (int i = nLo; i <= nHi; i++) {
+            next[i] &= ~reached[i];
+            int base = i * 64;
+            if (base + 64 > KU) next[i] &= base >= KU ? 0 : (word(1) << (KU - base)) - 1;
+            pending += __builtin_popcountll(next[i]);
+        }
+        if (pending == 0) break;
+
+        // 3) minimum witnesses: the first coin in the lex order whose shifted frontier hits a pending capacity
+        vector<word> open(next.begin() + nLo, next.begin() + nHi + 1);
+        for (auto [x, wt] : coins) {
+            for (int i = nLo; i <= nHi && pending > 0; i++) {
+                word hit = shiftedWord(frontier, wt, i) & open[i - nLo];
+                if (!hit) continue;
+                open[i - nLo] ^= hit;
+                pending -= __builtin_popcountll(hit);
+                for (; hit; hit &= hit - 1) {
+                    int c = i * 64 + __builtin_ctzll(hit);
+                    sol[c - wt].copy(sol[c]);
+                    sol[c].addCoin(x, wt, -1); //note in coinchange, the profit array is just -1
+                }
+            }
+            if (pending == 0) break;
+        }
+
+        // 4) the new capacities form the next frontier
+        for (int i = loW; i <= hiW; i++) frontier[i] = 0;
+        loW = INT_MAX;
+        hiW = -1;
+        for (int i = nLo; i <= nHi; i++) {
+            frontier[i] = next[i];
+            reached[i] |= next[i];
+            if (next[i]) {
+                loW = min(loW, i);
+                hiW = i;
+            }
+        }
+    }
+}
+
+template <int W>
+static vector<ll> smallPropagation(const CoinSet& cs, int t, const vector<solution>& sol) {
+    // slot of every distinct weight, in ascending weight (at most 64·W of them)
+    vector<int> slot(cs.u + 1, -1), weightOf;
+    for (int x = 1; x <= cs.u; x++) {
+        if (cs.f[x]) {
+            slot[x] = (int)weightOf.size();
+            weightOf.push_back(x);
+        }
+    }
+
+    vector<ll> res(t + 1, -1);
+    res[0] = 0;
+    for (int c = 1; c <= t && c < (int)sol.size(); c++) {
+        if (sol[c].size > 0) res[c] = sol[c].size;
+    }
+    auto kernelMask = [&](int c, WordSet<W>& m) {
+        m.clear();
+        if (c >= (int)sol.size()) return;
+        for (auto const& C : sol[c].svec) m.set(slot[cs.weightAt(C.first)]);
+    };
+
+    // ring of the masks of targets j .. j + u
+    int R = 1;
+    while (R < cs.u + 1) R <<= 1;
+    vector<WordSet<W>> mask(R);
+    for (int c = 0; c <= min(t, cs.u); c++) kernelMask(c, mask[c & (R - 1)]);
+
+    for (int j = 0; j <= t; j++) {
+        if (res[j] >= 0) {
+            const WordSet<W> m = mask[j & (R - 1)];
+            ll cand = res[j] + 1;
+            for (int i = 0; i < W; i++) {
+                for (word b = m.bits[i]; b; b &= b - 1) {
+                    int s = i * 64 + __builtin_ctzll(b);
+                    int nxt = j + weightOf[s];
+                    if (nxt > t) continue;
+                    WordSet<W>& dst = mask[nxt & (R - 1)];
+                    if (res[nxt] < 0 || cand < res[nxt]) {
+                        res[nxt] = cand;
+                        dst = m;
+                    } else if (cand == res[nxt]) {
+                        dst.unite(m);
+                    } else {
+                        continue;
+                    }
+                    dst.set(s);
+                }
+            }
+        }
+        // target j + u + 1 takes over the slot of a finished target
+        if (j + cs.u + 1 <= t) kernelMask(j + cs.u + 1, mask[(j + cs.u + 1) & (R - 1)]);
+    }
+    return res;
+}
+
+bool smallUSupported(const CoinSet& cs) {
+    return cs.u >= 1 && cs.u <= SMALL_U_MAX;
+}
+
+void kernelComputation_coinchange_smallU(const CoinSet& cs, int t, vector<solution>& sol) {
+    FK_SCOPED_TIMER("kernel.coinchange_smallu");
+    FK_TRACE("kernel.coinchange_smallu", "kernel", "n", cs.n, "u", cs.u);
+    switch ((cs.u + 64) / 64) { // words of the indicator f[0..u]
+        case 1: smallKernel<1>(cs, t, sol); break;
+        case 2: smallKernel<2>(cs, t, sol); break;
+        case 3: smallKernel<3>(cs, t, sol); break;
+        case 4: smallKernel<4>(cs, t, sol); break;
+        case 5: smallKernel<5>(cs, t, sol); break;
+        case 6: smallKernel<6>(cs, t, sol); break;
+        case 7: smallKernel<7>(cs, t, sol); break;
+        case 8: smallKernel<8>(cs, t, sol); break;
+        default: kernelComputation_coinchange_simple(cs, t, sol); // u > SMALL_U_MAX: same kernel, the FFT way
+    }
+}
+
+vector<ll> coinChangeSmallU(const CoinSet& cs, int t) {
+    FK_SCOPED_TIMER("coinchange.smallu");
+    FK_TRACE("coinchange.smallu", "propagation", "u", cs.u, "t", t);
+    vector<solution> sol;
+    kernelComputation_coinchange_smallU(cs, 0, sol); // the kernel only, the masks replace the solutions beyond it
+    if (!smallUSupported(cs)) {
+        vector<ll> res(t + 1, -1);
+        propagationStreamed(cs, t, sol, [&](int c, const solution& s) {
+            if (c == 0 || s.size != 0) res[c] = -s.value;
+        });
+        return res;
+    }
+    int distinct = 0;
+    for (int x = 1; x <= cs.u; x++) distinct += cs.f[x] ? 1 : 0;
+    switch ((distinct + 63) / 64) { // words of a mask over the distinct weights
+        case 1: return smallPropagation<1>(cs, t, sol);
+        case 2: return smallPropagation<2>(cs, t, sol);
+        case 3: return smallPropagation<3>(cs, t, sol);
+        case 4: return smallPropagation<4>(cs, t, sol);
+        case 5: return smallPropagation<5>(cs, t, sol);
+        case 6: return smallPropagation<6>(cs, t, sol);
+        case 7: return smallPropagation<7>(cs, t, sol);
+        case 8: return smallPropagation<8>(cs, t, sol);
+    }
+    return {};
+}
@@ -0,0 +1,133 @@
+#include "thread_pool.h"
+#include <cstdlib>
+
+ThreadPool::ThreadPool(int threads)
+  : queued(0), nextQueue(0), stopping(false)
+{
+    threads = max(1, threads);
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(make_unique<Worker>());
+    }
+    // queue 0 belongs to the callers of parallelFor(), the others to the background workers
+    for (int i = 1; i < threads; i++) {
+        this->threads.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> g(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& th : threads) th.join();
+}
+
+int ThreadPool::size() const {
+    return (int)workers.size();
+}
+
+bool ThreadPool::runOne(int id) {
+    int W = (int)workers.size();
+    function<void()> task;
+    for (int d = 0; d < W && !task; d++) {
+        Worker& wk = *workers[(id + d) % W];
+        lock_guard<mutex> g(wk.lock);
+        if (wk.tasks.empty()) continue;
+        if (d == 0) {
+            task = move(wk.tasks.front());
+            wk.tasks.pop_front();
+        } else { // steal from the other end
+            task = move(wk.tasks.back());
+            wk.tasks.pop_back();
+        }
+    }
+    if (!task) return false;
+    queued--;
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(int id) {
+    while (true) {
+        if (runOne(id)) continue;
+        unique_lock<mutex> g(sleepLock);
+        wake.wait(g, [this] { return stopping || queued.load() > 0; });
+        if (stopping) return;
+    }
+}
+
+void ThreadPool::parallelFor(int begin, int end, const function<void(int)>& fn) {
+    if (end <= begin) return;
+    if (workers.size() == 1 || end - begin == 1) {
+        for (int i = begin; i < end; i++) fn(i);
+        return;
+    }
+    // state of this call, on the caller's stack: a task must not touch it after its decrement of `remaining`
+    struct Batch {
+        atomic<int> remaining;
+        mutex errorLock;
+        exception_ptr error; ///< first exception thrown by fn
+    } batch;
+    batch.remaining = end - begin;
+    // counts a task as finished however fn returns, and wakes the waiting caller after the last one
+    struct Finish {
+        ThreadPool* pool;
+        Batch& batch;
+        ~Finish() {
+            if (--batch.remaining > 0) return;
+            { lock_guard<mutex> g(pool->sleepLock); }
+            pool->idle.notify_all();
+        }
+    };
+    int W = (int)workers.size();
+    for (int i = begin; i < end; i++) {
+        Worker& wk = *workers[nextQueue++ % W];
+        {
+            lock_guard<mutex> g(wk.lock);
+            wk.tasks.push_back([this, &fn, &batch, i] {
+                Finish finish{this, batch};
+                try {
+                    fn(i);
+                } catch (...) {
+                    lock_guard<mutex> g(batch.errorLock);
+                    if (!batch.error) batch.error = current_exception();
+                }
+            });
+        }
+        queued++;
+    }
+    {
+        lock_guard<mutex> g(sleepLock);
+    }
+    wake.notify_all();
+    idle.notify_all();
+    // help until every task of this call finished (possibly on other threads); with nothing left to steal,
+    // sleep until a task is queued (e.g. by a nested call) or the last task of this call finishes
+    while (batch.remaining.load() > 0) {
+        if (runOne(0)) continue;
+        unique_lock<mutex> g(sleepLock);
+        idle.wait(g, [&] { return batch.remaining.load() == 0 || queued.load() > 0; });
+    }
+    if (batch.error) rethrow_exception(batch.error);
+}
+
+ThreadPool& sharedThreadPool() {
+    static ThreadPool pool([] {
+        const char* env = getenv("FASTKNAPSACK_THREADS");
+        if (env && atoi(env) > 0) return atoi(env);
+        return max(1, (int)thread::hardware_concurrency());
+    }());
+    return pool;
+}
+
+static unsigned long long splitmix64(unsigned long long z) {
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+unsigned streamSeed(unsigned base, unsigned a, unsigned b) {
+    return (unsigned)splitmix64(splitmix64(splitmix64(base) ^ a) ^ b);
+}
@@ -0,0 +1,210 @@
+#include "trace.h"
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+atomic<bool> traceActive(false);
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* cat;
+    const char* key[2];
+    ll value[2];
+    ll start;           ///< ns since traceStart()
+    ll dur;             ///< ns, -1 while the scope is open
+    ll counters[3];     ///< cycles, instructions, cache misses during the scope
+};
+
+/// Event buffer and hardware counters of one thread; never freed, the pool threads live until exit anyway.
+struct ThreadTrace {
+    int tid;
+    vector<TraceEvent> events;
+    bool perfTried = false;
+    int perfLeader = -1;
+    vector<int> perfFds;
+};
+
+struct TraceState {
+    mutex lock;
+    vector<ThreadTrace*> threads;
+    chrono::steady_clock::time_point origin;
+    bool counters = true;
+    atomic<bool> anyCounters{false};
+};
+
+TraceState& state() {
+    static TraceState* st = new TraceState();
+    return *st;
+}
+
+ThreadTrace& threadTrace() {
+    thread_local ThreadTrace* tt = [] {
+        TraceState& st = state();
+        lock_guard<mutex> g(st.lock);
+        auto* t = new ThreadTrace();
+        t->tid = (int)st.threads.size();
+        st.threads.push_back(t);
+        return t;
+    }();
+    return *tt;
+}
+
+ll nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - state().origin).count();
+}
+
+#ifdef __linux__
+int perfOpen(unsigned type, unsigned long long config, int group) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0); // this thread, any cpu
+}
+#endif
+
+/// Opens the counter group of the calling thread once; false if the kernel refuses (no permission, no PMU, ...).
+bool openCounters(ThreadTrace& tt) {
+    if (tt.perfTried) return tt.perfLeader >= 0;
+    tt.perfTried = true;
+#ifdef __linux__
+    unsigned long long configs[3] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < 3; i++) {
+        int fd = perfOpen(PERF_TYPE_HARDWARE, configs[i], tt.perfLeader);
+        if (fd < 0) {
+            for (int f : tt.perfFds) close(f);
+            tt.perfFds.clear();
+            tt.perfLeader = -1;
+            return false;
+        }
+        if (i == 0) tt.perfLeader = fd;
+        tt.perfFds.push_back(fd);
+    }
+    ioctl(tt.perfLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(tt.perfLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    state().anyCounters = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// Current counter values of the thread, or -1s if there are none.
+void readCounters(ThreadTrace& tt, ll out[3]) {
+    out[0] = out[1] = out[2] = -1;
+    if (!state().counters || !openCounters(tt)) return;
+#ifdef __linux__
+    unsigned long long buf[4];
+    if (read(tt.perfLeader, buf, sizeof(buf)) != (ssize_t)sizeof(buf) || buf[0] != 3) return;
+    for (int i = 0; i < 3; i++) out[i] = (ll)buf[i + 1];
+#endif
+}
+
+void writeString(ostream& out, const char* s) {
+    out << '"';
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') out << '\\';
+        out << *s;
+    }
+    out << '"';
+}
+
+}
+
+void traceStart(bool counters) {
+    TraceState& st = state();
+    {
+        lock_guard<mutex> g(st.lock);
+        for (auto* t : st.threads) t->events.clear();
+        st.origin = chrono::steady_clock::now();
+        st.counters = counters;
+    }
+    traceActive = true;
+}
+
+bool traceStop(const string& path) {
+    traceActive = false;
+    TraceState& st = state();
+    lock_guard<mutex> g(st.lock);
+    ofstream out(path);
+    if (!out) return false;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto sep = [&] {
+        if (!first) out << ",\n";
+        first = false;
+    };
+    out << fixed << setprecision(3);
+    for (auto* t : st.threads) {
+        if (t->events.empty()) continue;
+        sep();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t->tid
+            << ",\"args\":{\"name\":\"" << (t->tid == 0 ? "main" : "thread " + to_string(t->tid)) << "\"}}";
+        for (const TraceEvent& e : t->events) {
+            if (e.dur < 0) continue; // still open when the trace stopped
+            sep();
+            out << "{\"name\":";
+            writeString(out, e.name);
+            out << ",\"cat\":";
+            writeString(out, e.cat);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << t->tid
+                << ",\"ts\":" << e.start / 1e3 << ",\"dur\":" << e.dur / 1e3 << ",\"args\":{";
+            bool firstArg = true;
+            auto arg = [&](const char* key, ll value) {
+                if (!firstArg) out << ",";
+                firstArg = false;
+                writeString(out, key);
+                out << ":" << value;
+            };
+            for (int i = 0; i < 2; i++) {
+                if (e.key[i]) arg(e.key[i], e.value[i]);
+            }
+            if (e.counters[0] >= 0) {
+                arg("cycles", e.counters[0]);
+                arg("instructions", e.counters[1]);
+                arg("cache_misses", e.counters[2]);
+            }
+            out << "}}";
+        }
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
+
+bool traceHasCounters() {
+    return state().anyCounters.load();
+}
+
+void TraceScope::begin(const char* name, const char* cat, const char* key1, ll value1, const char* key2, ll value2) {
+    ThreadTrace& tt = threadTrace();
+    event = (int)tt.events.size();
+    tt.events.push_back({name, cat, {key1, key2}, {value1, value2}, 0, -1, {-1, -1, -1}});
+    readCounters(tt, counters);
+    tt.events[event].start = nowNs(); // after the counter read, which is not part of the scope
+}
+
+void TraceScope::end() {
+    ll stop = nowNs();
+    ThreadTrace& tt = threadTrace();
+    ll now[3];
+    readCounters(tt, now);
+    if (event >= (int)tt.events.size()) return; // the trace was restarted inside the scope
+    TraceEvent& e = tt.events[event];
+    e.dur = stop - e.start;
+    if (counters[0] >= 0 && now[0] >= 0) {
+        for (int i = 0; i < 3; i++) e.counters[i] = now[i] - counters[i];
+    }
+}
@@ -1,4 +1,8 @@
 #include "witness.h"
+#include "instrument.h"
+#include "trace.h"
+#include "arena.h"
+#include <unordered_set>
 /**
  * Computes the minimum witnesses of a boolean convolution for each result element
  * The `order` vector specifies the lexicographical order of the indices. 
@@ -7,22 +11,28 @@ vector<int> minimum_witness_boolCnv_ordered(vector<int>& a, vector<int>& b, cons
     //create sqrt(n) vectors depending on what division of sqrt(n) the index is in
     int n = order.size();
     int sqrt_n = (int)ceil(sqrt(n));
-    vector<vector<int>> a_P(sqrt_n + 1, vector<int>(a.size())); //division of a into O(sqrt(n)) parts
-    vector<vector<int>> id(sqrt_n + 1, vector<int>());
+    int G = sqrt_n + 1, R = sz(a) + sz(b) - 1;
+    ArenaScope scratch(MemSubsystem::Witness);
+    pmr::memory_resource* mem = scratch.resource();
+    pmr::vector<pmr::vector<int>> id(G, mem);
     for (int i = 0; i < n; i++) {
         if (a[w[order[i]]] == 0) {
             continue;
         }
-        a_P[i / sqrt_n][w[order[i]]] = 1;
         id[i/sqrt_n].push_back(order[i]);
     }
 
-    vector<vector<int>> groups(a_P.size()); //group[i] contains the result elements that have their minimum witness in group i
+    pmr::vector<pmr::vector<int>> groups(G, mem); //group[i] contains the result elements that have their minimum witness in group i
 
-    vector<int> visited(n + b.size() - 1, 0);
-    for (int g = 0; g < a_P.size(); g++) {
-        vector<int> c_g = boolCnv(a_P[g], b);
-        for (int i = 0; i < c_g.size(); i++) {
+    // one part of the division of a at a time, so only one full-length row is ever held
+    pmr::vector<int> part(a.size(), 0, mem), c_g(R, mem);
+    pmr::vector<char> visited(R, 0, mem);
+    for (int g = 0; g < G; g++) {
+        if (id[g].empty()) continue;
+        for (int i : id[g]) part[w[i]] = 1;
+        boolCnv(part, b, c_g);
+        for (int i : id[g]) part[w[i]] = 0;
+        for (int i = 0; i < R; i++) {
             if (c_g[i] == 1 && visited[i] == 0) {
                 groups[g].push_back(i);
                 visited[i] = 1;
@@ -30,15 +40,15 @@ vector<int> minimum_witness_boolCnv_ordered(vector<int>& a, vector<int>& b, cons
         }
     }
 
-    vector<int> min_witness(n + b.size() - 1, -1);
-    vector<int> inverseOrder(order.size());
+    vector<int> min_witness(R, -1);
+    pmr::vector<int> inverseOrder(order.size(), mem);
     for (int i = 0; i < order.size(); i++) {
         inverseOrder[order[i]] = i;
     }
-    for (int g = 0; g < a_P.size(); g++) {
+    for (int g = 0; g < G; g++) {
         for (int i : id[g]) {
             for (int result : groups[g]) {
-                if (a_P[g][w[i]] == 1 && result - w[i] >= 0 && result - w[i] < b.size() && b[result - w[i]] == 1) {
+                if (result - w[i] >= 0 && result - w[i] < b.size() && b[result - w[i]] == 1) {
                     int idx = inverseOrder[i];
                     if (min_witness[result] == -1 || idx < min_witness[result]) {
                         min_witness[result] = idx;
@@ -50,30 +60,93 @@ vector<int> minimum_witness_boolCnv_ordered(vector<int>& a, vector<int>& b, cons
     return min_witness;
 }
 
+/**
+ * Computes the minimum witnesses of a boolean convolution for each result element
+ * The witnesses are the order indices of `cs`; a[x] = 1 is read as "the coins of weight x are available".
+ */
+vector<int> minimum_witness_boolCnv_ordered(vector<int>& a, vector<int>& b, const CoinSet& cs) {
+    FK_SCOPED_TIMER("witness.ordered");
+    FK_TRACE("witness.ordered", "witness", "n", cs.n, "b", b.size());
+    //create sqrt(n) vectors depending on what division of sqrt(n) the index is in
+    int n = cs.n;
+    int sqrt_n = max(1, (int)ceil(sqrt(n)));
+    int G = n / sqrt_n + 1, R = sz(a) + sz(b) - 1;
+    ArenaScope scratch(MemSubsystem::Witness);
+    pmr::memory_resource* mem = scratch.resource();
+    pmr::vector<pmr::vector<int>> id(G, mem);
+    for (int x = 1; x <= n; x++) {
+        int wt = cs.weightAt(x);
+        if (wt >= sz(a) || a[wt] == 0) {
+            continue;
+        }
+        id[(x - 1) / sqrt_n].push_back(x);
+    }
+
+    pmr::vector<pmr::vector<int>> groups(G, mem); //group[i] contains the result elements that have their minimum witness in group i
+
+    // part = the weights of group g, a division of a into O(sqrt(n)) parts built one at a time
+    pmr::vector<int> part(a.size(), 0, mem), c_g(R, mem);
+    pmr::vector<char> visited(R, 0, mem);
+    for (int g = 0; g < G; g++) {
+        if (id[g].empty()) continue;
+        FK_COUNT("witness.ordered.groups", id[g].size());
+        for (int x : id[g]) part[cs.weightAt(x)] = 1;
+        boolCnv(part, b, c_g);
+        for (int x : id[g]) part[cs.weightAt(x)] = 0;
+        for (int i = 0; i < R; i++) {
+            if (c_g[i] == 1 && visited[i] == 0) {
+                groups[g].push_back(i);
+                visited[i] = 1;
+            }
+        }
+    }
+
+    // id[g] is sorted by order index, so the first witness found is the minimum one
+    vector<int> min_witness(R, -1);
+    ll probes = 0;
+    for (int g = 0; g < G; g++) {
+        for (int result : groups[g]) {
+            for (int x : id[g]) {
+                probes++;
+                int j = result - cs.weightAt(x);
+                if (j >= 0 && j < sz(b) && b[j] == 1) {
+                    min_witness[result] = x;
+                    break;
+                }
+            }
+        }
+    }
+    FK_COUNT("witness.ordered.probes", probes);
+    return min_witness;
+}
+
 /**
  * Uniformly samples a witness for each result element, in expected O(n log^2 n) time
  */
-vector<int> randomized_witness_sampling(vector<int>& a, vector<int>& b) {
+vector<int> randomized_witness_sampling(span<const int> a, span<const int> b) {
     // cerr << "Randomized witness sampling started" << endl;
     unsigned seed = chrono::system_clock::now().time_since_epoch().count();
     mt19937 rng(seed);
     bernoulli_distribution coin(0.5);
-    
-    vector<int> c = convolution(a, b);
 
-    vector<int> aVal(a.size(), 0);
+    int R = sz(a) + sz(b) - 1;
+    ArenaScope scratch(MemSubsystem::Witness);
+    pmr::memory_resource* mem = scratch.resource();
+    pmr::vector<int> c(R, mem), cVal(R, mem);
+    convolution(a, b, c);
+
+    pmr::vector<int> aVal(a.size(), 0, mem);
     for (int i = 0; i < a.size(); ++i) {
         if (a[i] > 0) {
             aVal[i] = i;
         }
     }
-    vector<int> cVal;
-    cVal = convolution(aVal, b);
-    vector<int> witness(c.size(), -1);
+    convolution(aVal, b, cVal);
+    vector<int> witness(R, -1);
     int need = 0;
     int cnt = 0;
 
-    for (int i = 0; i < sz(c); ++i) {
+    for (int i = 0; i < R; ++i) {
         if (c[i] > 0) {
             need++;
             if (c[i] == 1) {
@@ -89,12 +162,13 @@ vector<int> randomized_witness_sampling(vector<int>& a, vector<int>& b) {
     // cerr << endl;
     // cerr << "Need: " << need << ", cnt: " << cnt << endl;
     
+    pmr::vector<int> aDiluted(a.size(), mem);
+    FixedOperandConv bConv(b, sz(a), mem); // b is the same in every dilution
     while (cnt < need) {
         int K = (int)ceil(log2(sz(a)));
-        vector<int> aDiluted(a.size(), 0);
-        rep(i, 0, sz(a)) {
-            aDiluted[i] = a[i];
-        }
+        copy(a.begin(), a.end(), aDiluted.begin());
+        FK_COUNT("witness.sampling.rounds", K);
+        FK_TRACE("witness.sampling.round", "witness", "dilutions", K, "missing", need - cnt);
         for (int k = 0; k < K; ++k) {
             rep(i, 0, sz(aDiluted)) {
                 int bit = coin(rng) ? 1 : 0;
@@ -107,9 +181,8 @@ vector<int> randomized_witness_sampling(vector<int>& a, vector<int>& b) {
                     aVal[i] = 0;
                 }
             }
-            c = convolution(aDiluted, b);
-            cVal = convolution(aVal, b);
-            rep(i, 0, sz(c)) {
+            bConv.pair(aDiluted, aVal, c, cVal);
+            rep(i, 0, R) {
                 if (c[i] == 1 && witness[i] == -1) {
                     witness[i] = cVal[i];
                     cnt++;
@@ -130,39 +203,42 @@ vector<int> randomized_witness_sampling(vector<int>& a, vector<int>& b) {
  * Finds the minimum witness with respect to a random order in expected O~(n) time.
 */
 vector<int> minimum_witness_random(vector<int>& a, vector<int>& b, const vector<int>& w, vector<int>& order) {
-    unordered_map<int, int> ind; //converts weight to order index
-    for (int i = 1; i < sz(order); ++i) {
-        ind[w[order[i]]] = i;
-    }
+    CoinSet cs((int)order.size() - 1, 0, w, {}, order);
+    return minimum_witness_random(a, b, cs);
+}
 
-    // for (auto mp : ind) {
-    //     cerr << mp.first << " -> " << mp.second << endl;
-    // }
+vector<int> minimum_witness_random(vector<int>& a, vector<int>& b, const CoinSet& cs) {
+    const vector<int>& ind = cs.indexOfWeight; //converts weight to order index
 
-    vector<unordered_set<int>> witSets(sz(a) + sz(b) - 1);
-    vector<int> min_witness(sz(a) + sz(b) - 1, -1);
-    vector<int> found(sz(a) + sz(b) - 1, 0);
+    int R = sz(a) + sz(b) - 1;
+    ArenaScope scratch(MemSubsystem::Witness);
+    pmr::memory_resource* mem = scratch.resource();
+    pmr::vector<pmr::unordered_set<int>> witSets(R, mem);
+    vector<int> min_witness(R, -1);
+    pmr::vector<char> found(R, 0, mem);
     int l = 1;
-    vector<int> aPref(sz(a), 0);
-    while (l <= sz(order)-1) {
+    pmr::vector<int> aPref(sz(a), 0, mem), c(R, mem);
+    while (l <= cs.n) {
         // cerr << "Current l: " << l << endl;
+        FK_COUNT("witness.random.prefixes", l);
+        FK_TRACE("witness.random.round", "witness", "prefix", l);
 
         for (int i = 1; i <= l; ++i) {
-            aPref[w[order[i]]] = 1;
+            aPref[cs.weightAt(i)] = 1;
         }
         // cerr << "aPref: " << endl;
         // for (int i = 0; i < sz(aPref); ++i) {
         //     cerr << aPref[i] << " ";
         // }
         // cerr << endl;
-        vector<int> c = convolution(aPref, b);
+        convolution(aPref, b, c);
         // cerr << "c: " << endl;
         // for (int i = 0; i < sz(c); ++i) {
         //     cerr << c[i] << " ";
         // }
         // cerr << endl;
         int need = 0;
-        for (int i = 0; i < sz(c); ++i) {
+        for (int i = 0; i < R; ++i) {
             if (c[i] > 0 && found[i] == 0) {
                 need++;
             }
@@ -184,10 +260,10 @@ vector<int> minimum_witness_random(vector<int>& a, vector<int>& b, const vector<
                 }
             }
         }
-        if (l == sz(order) - 1) {
+        if (l == cs.n) {
             break;
         }
-        l = min(sz(order) - 1, l * 2);
+        l = min(cs.n, l * 2);
     }
     return min_witness;
 }
@@ -196,44 +272,75 @@ vector<int> minimum_witness_random(vector<int>& a, vector<int>& b, const vector<
  * A randomized algorithm to find k-wtinesses of a boolean convolution
  */
 vector<vector<int>> randomized_k_witness(vector<int>& a, vector<int>& b, int k, const vector<int>& w, vector<int>& order) {
+    vector<int> wanted(a.size() + b.size() - 1, 1);
     unsigned seed = chrono::system_clock::now().time_since_epoch().count();
+    return randomized_k_witness(a, b, k, w, order, wanted, seed);
+}
+
+/**
+ * Same as above, but only the result elements with wanted[i] != 0 get their witnesses,
+ * and the dilution is driven by `seed` so that the result is reproducible
+ */
+vector<vector<int>> randomized_k_witness(vector<int>& a, vector<int>& b, int k, const vector<int>& w, vector<int>& order, const vector<int>& wanted, unsigned seed) {
+    CoinSet cs((int)order.size() - 1, 0, w, {}, order);
+    return randomized_k_witness(a, b, k, cs, wanted, seed);
+}
+
+vector<vector<int>> randomized_k_witness(span<const int> a, span<const int> b, int k, const CoinSet& cs, span<const int> wanted, unsigned seed) {
+    FK_SCOPED_TIMER("witness.k");
     mt19937 rng(seed);
     bernoulli_distribution coin(0.5);
 
-    vector<vi> witnesses(a.size() + b.size() - 1, vector<int>());
-    unordered_map<int, int> ind; //converts weight to order index
-    for (int i = 1; i < sz(order); ++i) {
-        ind[w[order[i]]] = i;
-    }
-    vector<int> maxWit = convolution(a, b);
+    int R = sz(a) + sz(b) - 1;
+    ArenaScope scratch(MemSubsystem::Witness);
+    pmr::memory_resource* mem = scratch.resource();
+    vector<vi> witnesses(R, vector<int>());
+    const vector<int>& ind = cs.indexOfWeight; //converts weight to order index
+    pmr::vector<int> total(R, mem); // number of witnesses of every entry
+    convolution(a, b, total);
+    pmr::vector<int> maxWit(total.begin(), total.end(), mem);
     int need = 0;
-    for (int i = 0; i < sz(maxWit); ++i) {
-        if (maxWit[i] == 0) {
+    for (int i = 0; i < R; ++i) {
+        if (maxWit[i] == 0 || wanted[i] == 0) {
+            maxWit[i] = 0;
             continue;
         }
         need++;
         maxWit[i] = min(maxWit[i], k);
     }
-    vector<int> c;
-    vector<int> cVal;
+    pmr::vector<int> c(R, mem), cVal(R, mem);
+    pmr::vector<int> aDiluted(a.size(), mem), aInd(a.size(), mem);
+    FixedOperandConv bConv(b, sz(a), mem); // b is the same in every dilution
+    pmr::vector<int> pending(mem); // entries still short of witnesses, compacted after every round
+    pending.reserve(need);
+    for (int i = 0; i < R; ++i) {
+        if (maxWit[i] > 0) pending.push_back(i);
+    }
+    // Dilution level l keeps every entry of a with probability 2^-(l+1), which isolates one of
+    // the m unknown witnesses of an entry best when 2^(l+1) is close to m. Since m is known
+    // exactly, only levels some pending entry is close to are convolved; the rest only dilute.
+    int K = max(1, (int)ceil(log2(sz(a))));
+    pmr::vector<char> useLevel(K, 0, mem);
     int cnt = 0;
     while (cnt < need) {
-        int K = (int)ceil(log2(sz(a)));
-        vector<int> aDiluted(a.size(), 0);
-        rep(i, 0, sz(a)) {
-            aDiluted[i] = a[i];
+        fill(useLevel.begin(), useLevel.end(), 0);
+        for (int i : pending) {
+            int m = total[i] - sz(witnesses[i]);
+            useLevel[clamp((int)lround(log2(m)) - 1, 0, K - 1)] = 1;
         }
-        vector<int> aInd(a.size(), 0);
+        int depth = (int)(find(useLevel.rbegin(), useLevel.rend(), 1).base() - useLevel.begin());
+        copy(a.begin(), a.end(), aDiluted.begin());
         for (int i = 0; i < sz(a); ++i) {
-            if (a[i] > 0) {
-                aInd[i] = i;
-            }
+            aInd[i] = a[i] > 0 ? i : 0;
         }
-        rep (i, 0, K) {
+        FK_COUNT("witness.k.rounds", depth);
+        FK_TRACE("witness.k.round", "witness", "k", k, "missing", need - cnt);
+        rep (l, 0, depth) {
             rep(i, 0, sz(aDiluted)) {
                 int bit = coin(rng) ? 1 : 0;
                 aDiluted[i] = aDiluted[i] & bit;          
             }
+            if (!useLevel[l]) continue;
             rep(i, 0, sz(aDiluted)) {
                 if (aDiluted[i] > 0) {
                     aInd[i] = i;
@@ -241,16 +348,15 @@ vector<vector<int>> randomized_k_witness(vector<int>& a, vector<int>& b, int k,
                     aInd[i] = 0;
                 }
             }
-            c = convolution(aDiluted, b);
-            cVal = convolution(aInd, b);
-            rep(i, 0, sz(c)) {
+            bConv.pair(aDiluted, aInd, c, cVal);
+            for (int i : pending) {
                 if (c[i] > 0 && witnesses[i].size() < maxWit[i]) {
                     int newWit = c[i];
                     int witVal = cVal[i];
                     for (int wit : witnesses[i]) {
-                        if (aDiluted[w[order[wit]]] == 1) {
+                        if (aDiluted[cs.weightAt(wit)] == 1) {
                             newWit -= 1;
-                            witVal -= w[order[wit]];
+                            witVal -= cs.weightAt(wit);
                         }
                     }
                     if (newWit == 1) {
@@ -262,6 +368,7 @@ vector<vector<int>> randomized_k_witness(vector<int>& a, vector<int>& b, int k,
                 }
             }
         }
+        erase_if(pending, [&](int i) { return witnesses[i].size() == maxWit[i]; });
     }
     return witnesses;
 }
\ No newline at end of file
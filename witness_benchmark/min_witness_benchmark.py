@@ -28,7 +28,13 @@ def compile_tests():
         '-I', INCLUDE,
         'optimized_min_witness_test.cpp',
         os.path.join('..', 'src', 'witness.cpp'),
+        os.path.join('..', 'src', 'coin_set.cpp'),
         os.path.join('..', 'src', 'convolution.cpp'),
+        os.path.join('..', 'src', 'arena.cpp'),
+        os.path.join('..', 'src', 'memory_budget.cpp'),
+        os.path.join('..', 'src', 'trace.cpp'),
+        os.path.join('..', 'src', 'thread_pool.cpp'),
+        '-pthread',
         '-o', OPT_EXE
     ], cwd=BASE_DIR, check=True)
 
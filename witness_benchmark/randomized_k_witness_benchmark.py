@@ -64,7 +64,13 @@ def compile_solver():
         '-I', INCLUDE,
         SRC,
         os.path.join(BASE, '..', 'src', 'convolution.cpp'),
+        os.path.join(BASE, '..', 'src', 'arena.cpp'),
+        os.path.join(BASE, '..', 'src', 'memory_budget.cpp'),
+        os.path.join(BASE, '..', 'src', 'trace.cpp'),
+        os.path.join(BASE, '..', 'src', 'thread_pool.cpp'),
         os.path.join(BASE, '..', 'src', 'witness.cpp'),
+        os.path.join(BASE, '..', 'src', 'coin_set.cpp'),
+        '-pthread',
         '-o', SOLVER
     ], check=True)
 
@@ -16,7 +16,13 @@ def compile_solver():
         '-I', INCLUDE,
         'optimized_sampling_test.cpp',
         os.path.join('..','src','convolution.cpp'),
+        os.path.join('..','src','arena.cpp'),
+        os.path.join('..','src','memory_budget.cpp'),
+        os.path.join('..','src','trace.cpp'),
+        os.path.join('..','src','thread_pool.cpp'),
         os.path.join('..','src','witness.cpp'),
+        os.path.join('..','src','coin_set.cpp'),
+        '-pthread',
         '-o', SOLVER
     ], cwd=BASE, check=True)
 